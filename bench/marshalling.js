@@ -0,0 +1,256 @@
+'use strict'
+
+// Runs the native marshalling microbenchmarks (bench/native) and reports the
+// cost of converting each request and response type, in ns/op and native
+// allocations/op.  No cluster is needed.
+//
+// The module is only built when configuring with --CDBUILD_BENCHMARKS=ON:
+//   npx cmake-js compile --CDBUILD_BENCHMARKS=ON
+//   npm run bench -- [--filter <regex>] [--iterations <n>] [--runs <n>]
+//                    [--json <file>] [--baseline <file>] [--threshold <pct>]
+//
+// Results written with --json can be passed back as --baseline in a later
+// run, which then exits with a non-zero status if any case got slower (or
+// allocates more) by more than the threshold.
+
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+const { execSync } = require('child_process')
+
+const DOC_ID = {
+  bucket: 'default',
+  scope: '_default',
+  collection: '_default',
+  key: 'user::00000000000000000042',
+}
+
+const MUTATION_TOKEN = {
+  partition_uuid: 187320915471242,
+  sequence_number: 42,
+  partition_id: 512,
+  bucket_name: 'default',
+}
+
+// Request fixtures mirror the objects the SDK passes to the binding, and
+// response fixtures describe the size of the natively built response.
+const FIXTURES = {
+  'get_request.from_js': {
+    id: DOC_ID,
+    partition: 0,
+    opaque: 0,
+    timeout: 2500,
+  },
+  'get_response.to_js': { value_size: 256 },
+  'upsert_request.from_js': {
+    id: DOC_ID,
+    value: Buffer.alloc(256, 'x'),
+    flags: 0x02000006,
+    expiry: 0,
+    preserve_expiry: false,
+    durability_level: 0,
+    timeout: 2500,
+    partition: 0,
+    opaque: 0,
+  },
+  'upsert_response.to_js': {},
+  'lookup_in_request.from_js': {
+    id: DOC_ID,
+    specs: [0, 1, 2, 3].map((i) => ({
+      opcode_: 0xc5,
+      flags_: 0,
+      path_: `field${i}`,
+      original_index_: i,
+    })),
+    timeout: 2500,
+    partition: 0,
+    opaque: 0,
+    access_deleted: false,
+  },
+  'lookup_in_response.to_js': { num_fields: 4, value_size: 32 },
+  'mutate_in_request.from_js': {
+    id: DOC_ID,
+    specs: [0, 1, 2, 3].map((i) => ({
+      opcode_: 0xc8,
+      flags_: 0,
+      path_: `field${i}`,
+      value_: Buffer.from(JSON.stringify(`value${i}`)),
+      original_index_: 0,
+    })),
+    store_semantics: 0,
+    expiry: 0,
+    preserve_expiry: false,
+    cas: '0',
+    timeout: 2500,
+    partition: 0,
+    opaque: 0,
+    access_deleted: false,
+    create_as_deleted: false,
+    durability_level: 0,
+  },
+  'mutate_in_response.to_js': { num_fields: 4 },
+  'query_request.from_js': {
+    statement: 'SELECT * FROM `default` WHERE type = $type LIMIT $limit',
+    client_context_id: '8a1f6c2e-0b3d-4e5f-a6b7-c8d9e0f1a2b3',
+    adhoc: true,
+    metrics: false,
+    readonly: false,
+    flex_index: false,
+    preserve_expiry: false,
+    mutation_state: [MUTATION_TOKEN],
+    timeout: 75000,
+    raw: {},
+    positional_parameters: [],
+    named_parameters: { type: '"user"', limit: '100' },
+    body_str: '',
+  },
+  'query_response.to_js': { num_rows: 100, row_size: 128 },
+}
+
+function parseArgs(argv) {
+  const opts = {
+    filter: undefined,
+    iterations: 100000,
+    runs: 5,
+    json: undefined,
+    baseline: undefined,
+    threshold: 10,
+  }
+  for (let i = 0; i < argv.length; ++i) {
+    let [name, value] = argv[i].split('=')
+    name = name.replace(/^--/, '')
+    if (!(name in opts)) {
+      throw new Error(`Unknown option: ${argv[i]}`)
+    }
+    if (value === undefined) {
+      value = argv[++i]
+    }
+    opts[name] = typeof opts[name] === 'number' ? parseFloat(value) : value
+  }
+  return opts
+}
+
+function loadBenchModule() {
+  const modulePath =
+    process.env.CN_BENCH_PATH ||
+    path.resolve(__dirname, '..', 'build', 'Release', 'couchbase_bench.node')
+  if (!fs.existsSync(modulePath)) {
+    throw new Error(
+      `Benchmark module not found at ${modulePath}.  Build it with ` +
+        '`npx cmake-js compile --CDBUILD_BENCHMARKS=ON` or set CN_BENCH_PATH.'
+    )
+  }
+  return require(modulePath)
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b)
+  const mid = Math.floor(sorted.length / 2)
+  return sorted.length % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2
+}
+
+function runCase(bench, name, opts) {
+  const fixture = FIXTURES[name] || {}
+  // Warm up the code paths and the V8 inline caches before measuring.
+  bench.run(name, fixture, Math.max(1, Math.floor(opts.iterations / 10)))
+
+  const nsPerOp = []
+  let allocsPerOp = 0
+  let bytesPerOp = 0
+  for (let run = 0; run < opts.runs; ++run) {
+    const res = bench.run(name, fixture, opts.iterations)
+    nsPerOp.push(res.elapsed_ns / res.iterations)
+    allocsPerOp = res.allocations / res.iterations
+    bytesPerOp = res.allocated_bytes / res.iterations
+  }
+  return {
+    name,
+    ns_per_op: median(nsPerOp),
+    min_ns_per_op: Math.min(...nsPerOp),
+    allocs_per_op: allocsPerOp,
+    bytes_per_op: bytesPerOp,
+  }
+}
+
+function gitRevision() {
+  try {
+    return execSync('git rev-parse HEAD', {
+      cwd: __dirname,
+      stdio: ['ignore', 'pipe', 'ignore'],
+    })
+      .toString()
+      .trim()
+  } catch (e) {
+    return undefined
+  }
+}
+
+function compareWithBaseline(results, baselinePath, thresholdPct) {
+  const baseline = JSON.parse(fs.readFileSync(baselinePath, 'utf8'))
+  const baselineByName = new Map(baseline.results.map((r) => [r.name, r]))
+  const regressions = []
+  for (const res of results) {
+    const base = baselineByName.get(res.name)
+    if (!base) {
+      continue
+    }
+    const nsChange = ((res.ns_per_op - base.ns_per_op) / base.ns_per_op) * 100
+    res.ns_change_pct = nsChange
+    if (nsChange > thresholdPct) {
+      regressions.push(`${res.name}: ${nsChange.toFixed(1)}% slower`)
+    }
+    if (res.allocs_per_op > base.allocs_per_op) {
+      regressions.push(
+        `${res.name}: ${base.allocs_per_op} -> ${res.allocs_per_op} allocs/op`
+      )
+    }
+  }
+  return regressions
+}
+
+function main() {
+  const opts = parseArgs(process.argv.slice(2))
+  const bench = loadBenchModule()
+  const filter = opts.filter ? new RegExp(opts.filter) : undefined
+  const names = bench.cases().filter((name) => !filter || filter.test(name))
+
+  const results = names.map((name) => runCase(bench, name, opts))
+  const regressions = opts.baseline
+    ? compareWithBaseline(results, opts.baseline, opts.threshold)
+    : []
+
+  console.table(
+    results.map((r) => ({
+      case: r.name,
+      'ns/op': r.ns_per_op.toFixed(1),
+      'min ns/op': r.min_ns_per_op.toFixed(1),
+      'allocs/op': r.allocs_per_op.toFixed(2),
+      'bytes/op': r.bytes_per_op.toFixed(0),
+      ...(r.ns_change_pct !== undefined
+        ? { 'vs baseline': `${r.ns_change_pct.toFixed(1)}%` }
+        : {}),
+    }))
+  )
+
+  if (opts.json) {
+    const report = {
+      timestamp: new Date().toISOString(),
+      revision: gitRevision(),
+      node: process.version,
+      platform: `${process.platform}-${process.arch}`,
+      cpu: os.cpus()[0]?.model,
+      iterations: opts.iterations,
+      runs: opts.runs,
+      results,
+    }
+    fs.writeFileSync(opts.json, JSON.stringify(report, null, 2) + '\n')
+  }
+
+  if (regressions.length > 0) {
+    console.error('Regressions against baseline:')
+    regressions.forEach((r) => console.error(`  ${r}`))
+    process.exitCode = 1
+  }
+}
+
+main()
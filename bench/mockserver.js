@@ -0,0 +1,970 @@
+'use strict'
+
+// A lightweight stand-in for a single node Couchbase cluster, for generating
+// repeatable load without a real cluster.  It speaks just enough of the
+// memcached binary protocol (HELLO, SCRAM authentication, bucket selection,
+// cluster maps, basic document and sub-document operations) for the SDK to
+// bootstrap and run KV workloads against an in-memory store, and answers
+// every query with a canned result set.  It makes no attempt at emulating
+// anything else.
+//
+// It can be started in-process through MockServer, or as a subprocess:
+//   node bench/mockserver.js [--bucket default] [--username Administrator]
+//                            [--password password] [--query-rows 10]
+// which prints the connection details as JSON once it is listening, and also
+// sends them to the parent process when started with child_process.fork().
+
+const child_process = require('child_process')
+const crypto = require('crypto')
+const http = require('http')
+const net = require('net')
+
+const HEADER_LEN = 24
+
+const Magic = {
+  Request: 0x80,
+  AltRequest: 0x08,
+  Response: 0x81,
+}
+
+const Opcode = {
+  Get: 0x00,
+  Set: 0x01,
+  Add: 0x02,
+  Replace: 0x03,
+  Delete: 0x04,
+  Noop: 0x0a,
+  Hello: 0x1f,
+  SaslListMechs: 0x20,
+  SaslAuth: 0x21,
+  SaslStep: 0x22,
+  SelectBucket: 0x89,
+  GetClusterConfig: 0xb5,
+  SubdocMultiLookup: 0xd0,
+  SubdocMultiMutation: 0xd1,
+  GetCollectionsManifest: 0xba,
+  GetCollectionId: 0xbb,
+  GetErrorMap: 0xfe,
+}
+
+const Status = {
+  Success: 0x00,
+  NotFound: 0x01,
+  Exists: 0x02,
+  Einval: 0x04,
+  NoBucket: 0x08,
+  AuthError: 0x20,
+  AuthContinue: 0x21,
+  UnknownCollection: 0x88,
+  UnknownCommand: 0x81,
+  SubdocPathNotFound: 0xc0,
+  SubdocPathMismatch: 0xc1,
+  SubdocDocNotJson: 0xc6,
+  SubdocPathExists: 0xc9,
+  SubdocValueCantInsert: 0xca,
+  SubdocMultiPathFailure: 0xcc,
+}
+
+const SubdocOpcode = {
+  GetDoc: 0x00,
+  SetDoc: 0x01,
+  DeleteDoc: 0x04,
+  Get: 0xc5,
+  Exists: 0xc6,
+  DictAdd: 0xc7,
+  DictUpsert: 0xc8,
+  Delete: 0xc9,
+  Replace: 0xca,
+  GetCount: 0xd2,
+}
+
+// The mutations which carry a JSON value.
+const SUBDOC_VALUE_OPCODES = new Set([
+  SubdocOpcode.SetDoc,
+  SubdocOpcode.DictAdd,
+  SubdocOpcode.DictUpsert,
+  SubdocOpcode.Replace,
+])
+
+const SUBDOC_PATH_FLAG_XATTR = 0x04
+const SUBDOC_DOC_FLAG_MKDOC = 0x01
+const SUBDOC_DOC_FLAG_ADD = 0x02
+
+const Feature = {
+  TcpNodelay: 0x03,
+  Xerror: 0x07,
+  SelectBucket: 0x08,
+  Json: 0x0b,
+  AltRequestSupport: 0x10,
+  Collections: 0x12,
+}
+const SUPPORTED_FEATURES = new Set(Object.values(Feature))
+
+const DATATYPE_JSON = 0x01
+const NUM_VBUCKETS = 1024
+const SCRAM_ITERATIONS = 4096
+const SCRAM_MECHS = {
+  'SCRAM-SHA512': 'sha512',
+  'SCRAM-SHA256': 'sha256',
+  'SCRAM-SHA1': 'sha1',
+}
+
+function readLeb128(buf) {
+  let value = 0
+  let shift = 0
+  for (let i = 0; i < buf.length; ++i) {
+    value |= (buf[i] & 0x7f) << shift
+    if ((buf[i] & 0x80) === 0) {
+      return [value >>> 0, i + 1]
+    }
+    shift += 7
+  }
+  return [0, 0]
+}
+
+function hmac(hash, key, data) {
+  return crypto.createHmac(hash, key).update(data).digest()
+}
+
+function xor(a, b) {
+  const res = Buffer.alloc(a.length)
+  for (let i = 0; i < a.length; ++i) {
+    res[i] = a[i] ^ b[i]
+  }
+  return res
+}
+
+// Parses the value of a sub-document mutation, returning undefined if it is
+// not valid JSON.
+function parseSpecValue(value) {
+  try {
+    return JSON.parse(value.toString())
+  } catch (_e) {
+    return undefined
+  }
+}
+
+// Resolves a dotted path within a document to its parent object and the key
+// within it.  Array indexes are not supported.
+function resolvePath(root, path) {
+  const parts = path.split('.')
+  let parent = root
+  for (let i = 0; i < parts.length - 1; ++i) {
+    parent = parent[parts[i]]
+    if (typeof parent !== 'object' || parent === null) {
+      return undefined
+    }
+  }
+  if (typeof parent !== 'object' || parent === null || Array.isArray(parent)) {
+    return undefined
+  }
+  return { parent: parent, key: parts[parts.length - 1] }
+}
+
+function parseScramAttrs(message) {
+  const attrs = {}
+  for (const part of message.split(',')) {
+    const idx = part.indexOf('=')
+    if (idx > 0) {
+      attrs[part.substring(0, idx)] = part.substring(idx + 1)
+    }
+  }
+  return attrs
+}
+
+class MockServer {
+  constructor(options) {
+    options = options || {}
+    this.bucket = options.bucket || 'default'
+    this.username = options.username || 'Administrator'
+    this.password = options.password || 'password'
+    this.host = options.host || '127.0.0.1'
+    this.queryRows = options.queryRows !== undefined ? options.queryRows : 10
+
+    this.ports = {}
+    this._docs = new Map()
+    this._cas = BigInt(Date.now()) << 16n
+    this._sockets = new Set()
+    this._kvServer = undefined
+    this._mgmtServer = undefined
+    this._queryServer = undefined
+  }
+
+  get connectionString() {
+    return `couchbase://${this.host}:${this.ports.kv}`
+  }
+
+  get details() {
+    return {
+      connstr: this.connectionString,
+      bucket: this.bucket,
+      username: this.username,
+      password: this.password,
+      ports: this.ports,
+    }
+  }
+
+  async start() {
+    this._kvServer = net.createServer((socket) => this._handleKv(socket))
+    this._mgmtServer = http.createServer((req, res) =>
+      this._handleMgmt(req, res)
+    )
+    this._queryServer = http.createServer((req, res) =>
+      this._handleQuery(req, res)
+    )
+    this.ports.kv = await this._listen(this._kvServer)
+    this.ports.mgmt = await this._listen(this._mgmtServer)
+    this.ports.n1ql = await this._listen(this._queryServer)
+    return this
+  }
+
+  async stop() {
+    for (const socket of this._sockets) {
+      socket.destroy()
+    }
+    this._mgmtServer.closeAllConnections?.()
+    this._queryServer.closeAllConnections?.()
+    await Promise.all(
+      [this._kvServer, this._mgmtServer, this._queryServer].map(
+        (server) => new Promise((resolve) => server.close(() => resolve()))
+      )
+    )
+  }
+
+  _listen(server) {
+    return new Promise((resolve, reject) => {
+      server.once('error', reject)
+      server.listen(0, this.host, () => resolve(server.address().port))
+    })
+  }
+
+  _nextCas() {
+    this._cas += 1n
+    return this._cas
+  }
+
+  _clusterConfig(withBucket) {
+    const config = {
+      rev: 1,
+      revEpoch: 1,
+      nodesExt: [
+        {
+          services: {
+            kv: this.ports.kv,
+            mgmt: this.ports.mgmt,
+            n1ql: this.ports.n1ql,
+          },
+          thisNode: true,
+          hostname: this.host,
+        },
+      ],
+      clusterCapabilitiesVer: [1, 0],
+      clusterCapabilities: { n1ql: ['enhancedPreparedStatements'] },
+    }
+    if (!withBucket) {
+      return config
+    }
+
+    const vBucketMap = new Array(NUM_VBUCKETS)
+    for (let i = 0; i < NUM_VBUCKETS; ++i) {
+      vBucketMap[i] = [0]
+    }
+    return {
+      ...config,
+      name: this.bucket,
+      uuid: crypto.createHash('md5').update(this.bucket).digest('hex'),
+      bucketType: 'membase',
+      nodeLocator: 'vbucket',
+      bucketCapabilitiesVer: '',
+      bucketCapabilities: [
+        'collections',
+        'cbhello',
+        'touch',
+        'cccp',
+        'nodesExt',
+        'xattr',
+      ],
+      collectionsManifestUid: '0',
+      nodes: [
+        {
+          hostname: `${this.host}:${this.ports.mgmt}`,
+          ports: { direct: this.ports.kv },
+        },
+      ],
+      vBucketServerMap: {
+        hashAlgorithm: 'CRC',
+        numReplicas: 0,
+        serverList: [`${this.host}:${this.ports.kv}`],
+        vBucketMap: vBucketMap,
+      },
+    }
+  }
+
+  _collectionsManifest() {
+    return {
+      uid: '0',
+      scopes: [
+        {
+          name: '_default',
+          uid: '0',
+          collections: [{ name: '_default', uid: '0' }],
+        },
+      ],
+    }
+  }
+
+  _handleKv(socket) {
+    socket.setNoDelay(true)
+    this._sockets.add(socket)
+    socket.on('close', () => this._sockets.delete(socket))
+    socket.on('error', () => socket.destroy())
+
+    const session = {
+      collections: false,
+      authenticated: false,
+      bucket: undefined,
+      scram: undefined,
+    }
+    let pending = Buffer.alloc(0)
+
+    socket.on('data', (data) => {
+      pending = pending.length ? Buffer.concat([pending, data]) : data
+      let offset = 0
+      const responses = []
+      while (pending.length - offset >= HEADER_LEN) {
+        const bodyLen = pending.readUInt32BE(offset + 8)
+        if (pending.length - offset < HEADER_LEN + bodyLen) {
+          break
+        }
+        const packet = pending.subarray(offset, offset + HEADER_LEN + bodyLen)
+        offset += HEADER_LEN + bodyLen
+        const res = this._handlePacket(session, this._parsePacket(packet))
+        if (res) {
+          responses.push(res)
+        }
+      }
+      pending = pending.subarray(offset)
+      if (responses.length > 0) {
+        socket.write(
+          responses.length === 1 ? responses[0] : Buffer.concat(responses)
+        )
+      }
+    })
+  }
+
+  _parsePacket(packet) {
+    const magic = packet[0]
+    let framingLen = 0
+    let keyLen
+    if (magic === Magic.AltRequest) {
+      framingLen = packet[2]
+      keyLen = packet[3]
+    } else {
+      keyLen = packet.readUInt16BE(2)
+    }
+    const extrasLen = packet[4]
+    const bodyLen = packet.readUInt32BE(8)
+
+    const extrasStart = HEADER_LEN + framingLen
+    const keyStart = extrasStart + extrasLen
+    const valueStart = keyStart + keyLen
+    return {
+      magic: magic,
+      opcode: packet[1],
+      datatype: packet[5],
+      vbucket: packet.readUInt16BE(6),
+      opaque: packet.readUInt32BE(12),
+      cas: packet.readBigUInt64BE(16),
+      extras: packet.subarray(extrasStart, keyStart),
+      key: packet.subarray(keyStart, valueStart),
+      value: packet.subarray(valueStart, HEADER_LEN + bodyLen),
+    }
+  }
+
+  _response(req, status, fields) {
+    fields = fields || {}
+    const extras = fields.extras || Buffer.alloc(0)
+    const key = fields.key || Buffer.alloc(0)
+    const value =
+      typeof fields.value === 'string'
+        ? Buffer.from(fields.value)
+        : fields.value || Buffer.alloc(0)
+
+    const header = Buffer.alloc(HEADER_LEN)
+    header[0] = Magic.Response
+    header[1] = req.opcode
+    header.writeUInt16BE(key.length, 2)
+    header[4] = extras.length
+    header[5] = fields.datatype || 0
+    header.writeUInt16BE(status, 6)
+    header.writeUInt32BE(extras.length + key.length + value.length, 8)
+    header.writeUInt32BE(req.opaque, 12)
+    header.writeBigUInt64BE(fields.cas || 0n, 16)
+    return Buffer.concat([header, extras, key, value])
+  }
+
+  _documentKey(session, key) {
+    if (!session.collections) {
+      return { collectionId: 0, key: key.toString() }
+    }
+    const [collectionId, used] = readLeb128(key)
+    return { collectionId: collectionId, key: key.subarray(used).toString() }
+  }
+
+  _handlePacket(session, req) {
+    if (req.magic !== Magic.Request && req.magic !== Magic.AltRequest) {
+      return undefined
+    }
+
+    switch (req.opcode) {
+      case Opcode.Hello:
+        return this._handleHello(session, req)
+      case Opcode.GetErrorMap:
+        return this._response(req, Status.Success, {
+          value: JSON.stringify({ version: 2, revision: 1, errors: {} }),
+          datatype: DATATYPE_JSON,
+        })
+      case Opcode.SaslListMechs:
+        return this._response(req, Status.Success, {
+          value: Object.keys(SCRAM_MECHS).join(' '),
+        })
+      case Opcode.SaslAuth:
+        return this._handleSaslAuth(session, req)
+      case Opcode.SaslStep:
+        return this._handleSaslStep(session, req)
+      case Opcode.Noop:
+        return this._response(req, Status.Success)
+    }
+
+    if (!session.authenticated) {
+      return this._response(req, Status.AuthError)
+    }
+
+    switch (req.opcode) {
+      case Opcode.SelectBucket:
+        if (req.key.toString() !== this.bucket) {
+          return this._response(req, Status.NoBucket)
+        }
+        session.bucket = this.bucket
+        return this._response(req, Status.Success)
+      case Opcode.GetClusterConfig:
+        return this._response(req, Status.Success, {
+          value: JSON.stringify(this._clusterConfig(!!session.bucket)),
+          datatype: DATATYPE_JSON,
+        })
+      case Opcode.GetCollectionsManifest:
+        return this._response(req, Status.Success, {
+          value: JSON.stringify(this._collectionsManifest()),
+          datatype: DATATYPE_JSON,
+        })
+      case Opcode.GetCollectionId:
+        return this._handleGetCollectionId(req)
+    }
+
+    if (!session.bucket) {
+      return this._response(req, Status.NoBucket)
+    }
+
+    switch (req.opcode) {
+      case Opcode.Get:
+        return this._handleGet(session, req)
+      case Opcode.Set:
+      case Opcode.Add:
+      case Opcode.Replace:
+        return this._handleStore(session, req)
+      case Opcode.Delete:
+        return this._handleDelete(session, req)
+      case Opcode.SubdocMultiLookup:
+        return this._handleSubdocLookup(session, req)
+      case Opcode.SubdocMultiMutation:
+        return this._handleSubdocMutation(session, req)
+    }
+    return this._response(req, Status.UnknownCommand)
+  }
+
+  _handleHello(session, req) {
+    const enabled = Buffer.alloc(req.value.length)
+    let enabledLen = 0
+    for (let i = 0; i + 1 < req.value.length; i += 2) {
+      const feature = req.value.readUInt16BE(i)
+      if (SUPPORTED_FEATURES.has(feature)) {
+        enabled.writeUInt16BE(feature, enabledLen)
+        enabledLen += 2
+        if (feature === Feature.Collections) {
+          session.collections = true
+        }
+      }
+    }
+    return this._response(req, Status.Success, {
+      value: enabled.subarray(0, enabledLen),
+    })
+  }
+
+  _handleSaslAuth(session, req) {
+    const hash = SCRAM_MECHS[req.key.toString()]
+    if (!hash) {
+      return this._response(req, Status.AuthError)
+    }
+
+    // client-first-message: gs2-header "n,," followed by the bare message
+    const clientFirst = req.value.toString()
+    const clientFirstBare = clientFirst.substring(clientFirst.indexOf(',,') + 2)
+    const attrs = parseScramAttrs(clientFirstBare)
+    if (attrs.n !== this.username || !attrs.r) {
+      return this._response(req, Status.AuthError)
+    }
+
+    const salt = crypto.randomBytes(16)
+    const nonce = attrs.r + crypto.randomBytes(18).toString('base64')
+    const serverFirst =
+      `r=${nonce},s=${salt.toString('base64')},` + `i=${SCRAM_ITERATIONS}`
+    session.scram = {
+      hash: hash,
+      salt: salt,
+      nonce: nonce,
+      authMessagePrefix: `${clientFirstBare},${serverFirst}`,
+    }
+    return this._response(req, Status.AuthContinue, { value: serverFirst })
+  }
+
+  _handleSaslStep(session, req) {
+    const scram = session.scram
+    session.scram = undefined
+    if (!scram) {
+      return this._response(req, Status.AuthError)
+    }
+
+    const clientFinal = req.value.toString()
+    const proofIdx = clientFinal.lastIndexOf(',p=')
+    const attrs = parseScramAttrs(clientFinal)
+    if (proofIdx < 0 || attrs.r !== scram.nonce) {
+      return this._response(req, Status.AuthError)
+    }
+
+    const keyLen = crypto.createHash(scram.hash).digest().length
+    const saltedPassword = crypto.pbkdf2Sync(
+      this.password,
+      scram.salt,
+      SCRAM_ITERATIONS,
+      keyLen,
+      scram.hash
+    )
+    const authMessage =
+      scram.authMessagePrefix + ',' + clientFinal.substring(0, proofIdx)
+    const clientKey = hmac(scram.hash, saltedPassword, 'Client Key')
+    const storedKey = crypto.createHash(scram.hash).update(clientKey).digest()
+    const clientSignature = hmac(scram.hash, storedKey, authMessage)
+    const recoveredKey = xor(Buffer.from(attrs.p, 'base64'), clientSignature)
+    if (
+      !crypto
+        .createHash(scram.hash)
+        .update(recoveredKey)
+        .digest()
+        .equals(storedKey)
+    ) {
+      return this._response(req, Status.AuthError)
+    }
+
+    const serverKey = hmac(scram.hash, saltedPassword, 'Server Key')
+    const serverSignature = hmac(scram.hash, serverKey, authMessage)
+    session.authenticated = true
+    return this._response(req, Status.Success, {
+      value: `v=${serverSignature.toString('base64')}`,
+    })
+  }
+
+  _handleGetCollectionId(req) {
+    const path = (req.key.length ? req.key : req.value).toString()
+    if (path !== '_default._default' && path !== '.') {
+      return this._response(req, Status.UnknownCollection)
+    }
+    const extras = Buffer.alloc(12)
+    extras.writeBigUInt64BE(0n, 0)
+    extras.writeUInt32BE(0, 8)
+    return this._response(req, Status.Success, { extras: extras })
+  }
+
+  _lookup(session, req) {
+    const docKey = this._documentKey(session, req.key)
+    if (docKey.collectionId !== 0) {
+      return { docKey: docKey, status: Status.UnknownCollection }
+    }
+    const doc = this._docs.get(docKey.key)
+    if (doc && doc.expiresAt && doc.expiresAt <= Date.now()) {
+      this._docs.delete(docKey.key)
+      return { docKey: docKey, doc: undefined }
+    }
+    return { docKey: docKey, doc: doc }
+  }
+
+  _handleGet(session, req) {
+    const { doc, status } = this._lookup(session, req)
+    if (status !== undefined) {
+      return this._response(req, status)
+    }
+    if (!doc) {
+      return this._response(req, Status.NotFound)
+    }
+    const extras = Buffer.alloc(4)
+    extras.writeUInt32BE(doc.flags, 0)
+    return this._response(req, Status.Success, {
+      extras: extras,
+      value: doc.value,
+      datatype: doc.datatype,
+      cas: doc.cas,
+    })
+  }
+
+  _handleStore(session, req) {
+    const { docKey, doc, status } = this._lookup(session, req)
+    if (status !== undefined) {
+      return this._response(req, status)
+    }
+    if (req.extras.length < 8) {
+      return this._response(req, Status.Einval)
+    }
+    if (req.opcode === Opcode.Add && doc) {
+      return this._response(req, Status.Exists)
+    }
+    if ((req.opcode === Opcode.Replace || req.cas !== 0n) && !doc) {
+      return this._response(req, Status.NotFound)
+    }
+    if (req.cas !== 0n && doc.cas !== req.cas) {
+      return this._response(req, Status.Exists)
+    }
+
+    const expiry = req.extras.readUInt32BE(4)
+    const cas = this._nextCas()
+    this._docs.set(docKey.key, {
+      // The packet buffer is reused by the socket, so the value is copied.
+      value: Buffer.from(req.value),
+      flags: req.extras.readUInt32BE(0),
+      datatype: req.datatype & DATATYPE_JSON,
+      cas: cas,
+      expiresAt: this._expiresAt(expiry),
+    })
+    return this._response(req, Status.Success, { cas: cas })
+  }
+
+  _handleDelete(session, req) {
+    const { docKey, doc, status } = this._lookup(session, req)
+    if (status !== undefined) {
+      return this._response(req, status)
+    }
+    if (!doc) {
+      return this._response(req, Status.NotFound)
+    }
+    if (req.cas !== 0n && doc.cas !== req.cas) {
+      return this._response(req, Status.Exists)
+    }
+    this._docs.delete(docKey.key)
+    return this._response(req, Status.Success, { cas: this._nextCas() })
+  }
+
+  _parseDocument(doc) {
+    try {
+      return JSON.parse(doc.value.toString())
+    } catch (e) {
+      return undefined
+    }
+  }
+
+  _handleSubdocLookup(session, req) {
+    const { doc, status } = this._lookup(session, req)
+    if (status !== undefined) {
+      return this._response(req, status)
+    }
+    if (!doc) {
+      return this._response(req, Status.NotFound)
+    }
+
+    const root = this._parseDocument(doc)
+    const results = []
+    let failed = false
+    for (let offset = 0; offset < req.value.length; ) {
+      const opcode = req.value[offset]
+      const flags = req.value[offset + 1]
+      const pathLen = req.value.readUInt16BE(offset + 2)
+      const path = req.value.toString('utf8', offset + 4, offset + 4 + pathLen)
+      offset += 4 + pathLen
+
+      let specStatus = Status.Success
+      let value = Buffer.alloc(0)
+      if (opcode === SubdocOpcode.GetDoc) {
+        value = doc.value
+      } else if (root === undefined) {
+        specStatus = Status.SubdocDocNotJson
+      } else {
+        const target =
+          flags & SUBDOC_PATH_FLAG_XATTR ? undefined : resolvePath(root, path)
+        if (!target || !(target.key in target.parent)) {
+          specStatus = Status.SubdocPathNotFound
+        } else if (opcode === SubdocOpcode.Get) {
+          value = Buffer.from(JSON.stringify(target.parent[target.key]))
+        } else if (opcode === SubdocOpcode.GetCount) {
+          const field = target.parent[target.key]
+          const count = Array.isArray(field)
+            ? field.length
+            : Object.keys(field || {}).length
+          value = Buffer.from(String(count))
+        } else if (opcode !== SubdocOpcode.Exists) {
+          specStatus = Status.Einval
+        }
+      }
+
+      failed = failed || specStatus !== Status.Success
+      const entry = Buffer.alloc(6)
+      entry.writeUInt16BE(specStatus, 0)
+      entry.writeUInt32BE(value.length, 2)
+      results.push(entry, value)
+    }
+
+    return this._response(
+      req,
+      failed ? Status.SubdocMultiPathFailure : Status.Success,
+      {
+        value: Buffer.concat(results),
+        cas: doc.cas,
+      }
+    )
+  }
+
+  _handleSubdocMutation(session, req) {
+    const { docKey, doc, status } = this._lookup(session, req)
+    if (status !== undefined) {
+      return this._response(req, status)
+    }
+
+    // extras: optional expiry (4 bytes) and/or document flags (1 byte)
+    const expiry = req.extras.length >= 4 ? req.extras.readUInt32BE(0) : 0
+    const docFlags = req.extras.length % 4 === 1 ? req.extras.at(-1) : 0
+    if (docFlags & SUBDOC_DOC_FLAG_ADD && doc) {
+      return this._response(req, Status.Exists)
+    }
+    if (!doc && !(docFlags & (SUBDOC_DOC_FLAG_MKDOC | SUBDOC_DOC_FLAG_ADD))) {
+      return this._response(req, Status.NotFound)
+    }
+    if (req.cas !== 0n && (!doc || doc.cas !== req.cas)) {
+      return this._response(req, doc ? Status.Exists : Status.NotFound)
+    }
+
+    let root = doc ? this._parseDocument(doc) : {}
+    let deleteDoc = false
+    const fail = (index, specStatus) => {
+      const body = Buffer.alloc(3)
+      body[0] = index
+      body.writeUInt16BE(specStatus, 1)
+      return this._response(req, Status.SubdocMultiPathFailure, {
+        value: body,
+      })
+    }
+
+    for (let offset = 0, index = 0; offset < req.value.length; ++index) {
+      const opcode = req.value[offset]
+      const flags = req.value[offset + 1]
+      const pathLen = req.value.readUInt16BE(offset + 2)
+      const valueLen = req.value.readUInt32BE(offset + 4)
+      const pathStart = offset + 8
+      const path = req.value.toString('utf8', pathStart, pathStart + pathLen)
+      const value = req.value.subarray(
+        pathStart + pathLen,
+        pathStart + pathLen + valueLen
+      )
+      offset = pathStart + pathLen + valueLen
+
+      let specValue
+      if (SUBDOC_VALUE_OPCODES.has(opcode)) {
+        specValue = parseSpecValue(value)
+        if (specValue === undefined) {
+          return fail(index, Status.SubdocValueCantInsert)
+        }
+      }
+
+      if (opcode === SubdocOpcode.SetDoc) {
+        root = specValue
+        continue
+      } else if (opcode === SubdocOpcode.DeleteDoc) {
+        deleteDoc = true
+        continue
+      }
+      if (root === undefined) {
+        return fail(index, Status.SubdocDocNotJson)
+      }
+      if (flags & SUBDOC_PATH_FLAG_XATTR) {
+        // Extended attributes are accepted, but not stored.
+        continue
+      }
+
+      const target = resolvePath(root, path)
+      if (!target) {
+        return fail(index, Status.SubdocPathMismatch)
+      }
+      const exists = target.key in target.parent
+      switch (opcode) {
+        case SubdocOpcode.DictAdd:
+          if (exists) {
+            return fail(index, Status.SubdocPathExists)
+          }
+          target.parent[target.key] = specValue
+          break
+        case SubdocOpcode.DictUpsert:
+          target.parent[target.key] = specValue
+          break
+        case SubdocOpcode.Replace:
+          if (!exists) {
+            return fail(index, Status.SubdocPathNotFound)
+          }
+          target.parent[target.key] = specValue
+          break
+        case SubdocOpcode.Delete:
+          if (!exists) {
+            return fail(index, Status.SubdocPathNotFound)
+          }
+          delete target.parent[target.key]
+          break
+        default:
+          return fail(index, Status.Einval)
+      }
+    }
+
+    const cas = this._nextCas()
+    if (deleteDoc) {
+      this._docs.delete(docKey.key)
+    } else {
+      this._docs.set(docKey.key, {
+        value: Buffer.from(JSON.stringify(root)),
+        flags: doc ? doc.flags : 0,
+        datatype: DATATYPE_JSON,
+        cas: cas,
+        expiresAt: expiry ? this._expiresAt(expiry) : doc ? doc.expiresAt : 0,
+      })
+    }
+    return this._response(req, Status.Success, { cas: cas })
+  }
+
+  _expiresAt(expiry) {
+    if (expiry === 0) {
+      return 0
+    }
+    // Expiries of up to 30 days are relative, anything larger is absolute.
+    if (expiry <= 30 * 24 * 60 * 60) {
+      return Date.now() + expiry * 1000
+    }
+    return expiry * 1000
+  }
+
+  _handleMgmt(req, res) {
+    const sendJson = (obj) => {
+      res.writeHead(200, { 'Content-Type': 'application/json' })
+      res.end(JSON.stringify(obj))
+    }
+
+    if (req.url === '/pools') {
+      sendJson({
+        isAdminCreds: true,
+        isROAdminCreds: false,
+        implementationVersion: '7.6.0-0000-enterprise',
+        componentsVersion: {},
+      })
+    } else if (req.url === '/pools/default/nodeServices') {
+      sendJson(this._clusterConfig(false))
+    } else if (
+      req.url === `/pools/default/b/${this.bucket}` ||
+      req.url === `/pools/default/buckets/${this.bucket}`
+    ) {
+      sendJson(this._clusterConfig(true))
+    } else {
+      res.writeHead(404)
+      res.end()
+    }
+  }
+
+  _handleQuery(req, res) {
+    let body = ''
+    req.on('data', (chunk) => (body += chunk))
+    req.on('end', () => {
+      if (req.method !== 'POST' || !req.url.startsWith('/query/service')) {
+        res.writeHead(404)
+        res.end()
+        return
+      }
+
+      let params = {}
+      try {
+        params = JSON.parse(body)
+      } catch (e) {
+        // fall through with no parameters
+      }
+
+      const results = []
+      for (let i = 0; i < this.queryRows; ++i) {
+        results.push({ id: i, name: `row${i}` })
+      }
+      const resBody = {
+        requestID: crypto.randomUUID(),
+        clientContextID: params.client_context_id,
+        signature: { '*': '*' },
+        results: results,
+        status: 'success',
+        metrics: {
+          elapsedTime: '1ms',
+          executionTime: '1ms',
+          resultCount: results.length,
+          resultSize: JSON.stringify(results).length,
+        },
+      }
+      res.writeHead(200, { 'Content-Type': 'application/json' })
+      res.end(JSON.stringify(resBody))
+    })
+  }
+}
+
+// Starts a MockServer either in-process or as a subprocess, returning its
+// connection details and a function to stop it.
+async function startMock(mode) {
+  if (mode === 'inprocess') {
+    const server = await new MockServer().start()
+    return { details: server.details, stop: () => server.stop() }
+  }
+
+  const child = child_process.fork(__filename, [], {
+    stdio: ['ignore', 'ignore', 'inherit', 'ipc'],
+  })
+  const details = await new Promise((resolve, reject) => {
+    child.once('message', resolve)
+    child.once('exit', (code) =>
+      reject(new Error(`mock server exited with code ${code}`))
+    )
+  })
+  return {
+    details: details,
+    stop: () =>
+      new Promise((resolve) => {
+        child.once('exit', () => resolve())
+        child.kill('SIGTERM')
+      }),
+  }
+}
+
+module.exports.MockServer = MockServer
+module.exports.startMock = startMock
+
+if (require.main === module) {
+  const options = {}
+  const args = process.argv.slice(2)
+  for (let i = 0; i < args.length; i += 2) {
+    const name = args[i].replace(/^--/, '')
+    const camelName = name.replace(/-([a-z])/g, (_, c) => c.toUpperCase())
+    options[camelName] =
+      camelName === 'queryRows' ? parseInt(args[i + 1]) : args[i + 1]
+  }
+
+  const server = new MockServer(options)
+  server.start().then(() => {
+    console.log(JSON.stringify(server.details))
+    if (process.send) {
+      process.send(server.details)
+    }
+  })
+  process.on('SIGTERM', () => server.stop().then(() => process.exit(0)))
+}
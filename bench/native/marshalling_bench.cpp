@@ -0,0 +1,376 @@
+#include "addondata.hpp"
+#include "cas.hpp"
+#include "jstocbpp.hpp"
+#include "mutationtoken.hpp"
+#include <napi.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Allocation accounting.  The replacement operators are hidden so that only
+// the allocations made from within this module (which statically links the
+// core) are counted, rather than those of Node itself.  V8 heap allocations
+// are not included, as they are not made through operator new.
+#if defined(__GNUC__)
+#define BENCH_LOCAL __attribute__((visibility("hidden")))
+#else
+#define BENCH_LOCAL
+#endif
+
+namespace
+{
+
+struct AllocationCounters {
+    bool enabled{false};
+    std::uint64_t count{0};
+    std::uint64_t bytes{0};
+};
+
+thread_local AllocationCounters allocationCounters;
+
+void *countedAlloc(std::size_t size)
+{
+    if (allocationCounters.enabled) {
+        allocationCounters.count++;
+        allocationCounters.bytes += size;
+    }
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+BENCH_LOCAL void *operator new(std::size_t size)
+{
+    return countedAlloc(size);
+}
+
+BENCH_LOCAL void *operator new[](std::size_t size)
+{
+    return countedAlloc(size);
+}
+
+BENCH_LOCAL void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+BENCH_LOCAL void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+BENCH_LOCAL void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+BENCH_LOCAL void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace couchnode
+{
+namespace bench
+{
+
+// Keeps the result of a conversion from being optimized away.
+template <typename T>
+static inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+static std::vector<std::byte> makeBytes(std::size_t size, char fill)
+{
+    return std::vector<std::byte>(size, static_cast<std::byte>(fill));
+}
+
+static std::string makeJsonDoc(std::size_t size)
+{
+    std::string doc = "{\"value\":\"";
+    doc.append(size > doc.size() + 2 ? size - doc.size() - 2 : 0, 'x');
+    doc += "\"}";
+    return doc;
+}
+
+static couchbase::mutation_token makeMutationToken()
+{
+    return couchbase::mutation_token{0x2f1a5c3b7d9e4f01, 42, 512, "default"};
+}
+
+// A single marshalling benchmark.  The fixture is set up from the JS value
+// once, so that each iteration measures only the conversion itself.
+class MarshallingCase
+{
+public:
+    virtual ~MarshallingCase() = default;
+    virtual void prepare(Napi::Value fixture) = 0;
+    virtual void runOnce(Napi::Env env) = 0;
+};
+
+// Converts a request object, as built by the SDK, to its C++ type.
+template <typename Request>
+class RequestFromJs : public MarshallingCase
+{
+public:
+    void prepare(Napi::Value fixture) override
+    {
+        _fixture = Napi::Persistent(fixture.As<Napi::Object>());
+    }
+
+    void runOnce(Napi::Env) override
+    {
+        auto req = jsToCbpp<Request>(_fixture.Value(), nullptr);
+        doNotOptimize(req);
+    }
+
+private:
+    Napi::ObjectReference _fixture;
+};
+
+// Converts a response, built natively from the sizes given in the fixture,
+// to the JS object handed to the SDK callbacks.
+template <typename Response>
+class ResponseToJs : public MarshallingCase
+{
+public:
+    using Builder = std::function<Response(Napi::Object)>;
+
+    explicit ResponseToJs(Builder builder)
+        : _builder(std::move(builder))
+    {
+    }
+
+    void prepare(Napi::Value fixture) override
+    {
+        _resp = _builder(fixture.As<Napi::Object>());
+    }
+
+    void runOnce(Napi::Env env) override
+    {
+        auto jsRes = cbpp_to_js(env, _resp, nullptr);
+        doNotOptimize(jsRes);
+    }
+
+private:
+    Builder _builder;
+    Response _resp;
+};
+
+static std::size_t fixtureSize(Napi::Object fixture, const char *key,
+                               std::size_t defaultValue)
+{
+    auto value = fixture.Get(key);
+    if (!value.IsNumber()) {
+        return defaultValue;
+    }
+    return value.As<Napi::Number>().Uint32Value();
+}
+
+static couchbase::core::operations::get_response
+buildGetResponse(Napi::Object fixture)
+{
+    couchbase::core::operations::get_response resp;
+    resp.value = makeBytes(fixtureSize(fixture, "value_size", 256), 'x');
+    resp.cas = couchbase::cas{0x17c2a4d7b3e80000};
+    resp.flags = 0x02000006;
+    return resp;
+}
+
+static couchbase::core::operations::upsert_response
+buildUpsertResponse(Napi::Object)
+{
+    couchbase::core::operations::upsert_response resp;
+    resp.cas = couchbase::cas{0x17c2a4d7b3e80000};
+    resp.token = makeMutationToken();
+    return resp;
+}
+
+static couchbase::core::operations::lookup_in_response
+buildLookupInResponse(Napi::Object fixture)
+{
+    couchbase::core::operations::lookup_in_response resp;
+    resp.cas = couchbase::cas{0x17c2a4d7b3e80000};
+    auto numFields = fixtureSize(fixture, "num_fields", 4);
+    auto valueSize = fixtureSize(fixture, "value_size", 32);
+    for (std::size_t i = 0; i < numFields; ++i) {
+        couchbase::core::operations::lookup_in_response::entry entry;
+        entry.path = "field" + std::to_string(i);
+        entry.value = makeBytes(valueSize, 'x');
+        entry.original_index = i;
+        entry.exists = true;
+        entry.opcode = couchbase::core::protocol::subdoc_opcode::get;
+        entry.status = couchbase::core::key_value_status_code::success;
+        resp.fields.push_back(std::move(entry));
+    }
+    return resp;
+}
+
+static couchbase::core::operations::mutate_in_response
+buildMutateInResponse(Napi::Object fixture)
+{
+    couchbase::core::operations::mutate_in_response resp;
+    resp.cas = couchbase::cas{0x17c2a4d7b3e80000};
+    resp.token = makeMutationToken();
+    auto numFields = fixtureSize(fixture, "num_fields", 4);
+    for (std::size_t i = 0; i < numFields; ++i) {
+        couchbase::core::operations::mutate_in_response::entry entry;
+        entry.path = "field" + std::to_string(i);
+        entry.original_index = i;
+        entry.opcode = couchbase::core::protocol::subdoc_opcode::dict_upsert;
+        entry.status = couchbase::core::key_value_status_code::success;
+        resp.fields.push_back(std::move(entry));
+    }
+    return resp;
+}
+
+static couchbase::core::operations::query_response
+buildQueryResponse(Napi::Object fixture)
+{
+    couchbase::core::operations::query_response resp;
+    resp.meta.request_id = "2b8e7f0c-53d1-4c3a-9f0e-6d7c1b2a3e4f";
+    resp.meta.client_context_id = "8a1f6c2e-0b3d-4e5f-a6b7-c8d9e0f1a2b3";
+    resp.meta.status = "success";
+    resp.served_by_node = "10.0.0.1:8093";
+    auto numRows = fixtureSize(fixture, "num_rows", 100);
+    auto rowSize = fixtureSize(fixture, "row_size", 128);
+    resp.rows.assign(numRows, makeJsonDoc(rowSize));
+    return resp;
+}
+
+static std::map<std::string, std::function<std::unique_ptr<MarshallingCase>()>>
+makeCases()
+{
+    using namespace couchbase::core::operations;
+    return {
+        {"get_request.from_js",
+         [] { return std::make_unique<RequestFromJs<get_request>>(); }},
+        {"get_response.to_js",
+         [] {
+             return std::make_unique<ResponseToJs<get_response>>(
+                 buildGetResponse);
+         }},
+        {"upsert_request.from_js",
+         [] { return std::make_unique<RequestFromJs<upsert_request>>(); }},
+        {"upsert_response.to_js",
+         [] {
+             return std::make_unique<ResponseToJs<upsert_response>>(
+                 buildUpsertResponse);
+         }},
+        {"lookup_in_request.from_js",
+         [] { return std::make_unique<RequestFromJs<lookup_in_request>>(); }},
+        {"lookup_in_response.to_js",
+         [] {
+             return std::make_unique<ResponseToJs<lookup_in_response>>(
+                 buildLookupInResponse);
+         }},
+        {"mutate_in_request.from_js",
+         [] { return std::make_unique<RequestFromJs<mutate_in_request>>(); }},
+        {"mutate_in_response.to_js",
+         [] {
+             return std::make_unique<ResponseToJs<mutate_in_response>>(
+                 buildMutateInResponse);
+         }},
+        {"query_request.from_js",
+         [] { return std::make_unique<RequestFromJs<query_request>>(); }},
+        {"query_response.to_js",
+         [] {
+             return std::make_unique<ResponseToJs<query_response>>(
+                 buildQueryResponse);
+         }},
+    };
+}
+
+static const auto &cases()
+{
+    static const auto registered = makeCases();
+    return registered;
+}
+
+Napi::Value jsCases(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto resArr = Napi::Array::New(env, cases().size());
+    std::uint32_t i = 0;
+    for (const auto &[name, factory] : cases()) {
+        resArr.Set(i++, Napi::String::New(env, name));
+    }
+    return resArr;
+}
+
+// run(name, fixture, iterations) -> {iterations, elapsed_ns, allocations,
+// allocated_bytes}
+Napi::Value jsRun(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto name = info[0].ToString().Utf8Value();
+    auto fixture = info[1];
+    auto iterations = info[2].ToNumber().Uint32Value();
+
+    auto it = cases().find(name);
+    if (it == cases().end()) {
+        throw Napi::Error::New(env, "unknown benchmark case: " + name);
+    }
+
+    auto benchCase = it->second();
+    benchCase->prepare(fixture);
+
+    allocationCounters = AllocationCounters{true, 0, 0};
+    auto startedAt = std::chrono::steady_clock::now();
+    for (std::uint32_t i = 0; i < iterations; ++i) {
+        Napi::HandleScope scope(env);
+        benchCase->runOnce(env);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - startedAt;
+    auto counters = allocationCounters;
+    allocationCounters = AllocationCounters{};
+
+    auto resObj = Napi::Object::New(env);
+    resObj.Set("iterations", Napi::Number::New(env, iterations));
+    resObj.Set(
+        "elapsed_ns",
+        Napi::Number::New(env, static_cast<double>(
+                                   std::chrono::duration_cast<
+                                       std::chrono::nanoseconds>(elapsed)
+                                       .count())));
+    resObj.Set("allocations",
+               Napi::Number::New(env, static_cast<double>(counters.count)));
+    resObj.Set("allocated_bytes",
+               Napi::Number::New(env, static_cast<double>(counters.bytes)));
+    return resObj;
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports)
+{
+    AddonData::Init(env, exports);
+    Cas::Init(env, exports);
+    MutationToken::Init(env, exports);
+
+    exports.Set("cases", Napi::Function::New<jsCases>(env));
+    exports.Set("run", Napi::Function::New<jsRun>(env));
+    return exports;
+}
+
+} // namespace bench
+} // namespace couchnode
+
+Napi::Object Init(Napi::Env env, Napi::Object exports)
+{
+    return couchnode::bench::Init(env, exports);
+}
+NODE_API_MODULE(couchbase_bench, Init)
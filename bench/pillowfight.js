@@ -0,0 +1,226 @@
+'use strict'
+
+// A pillowfight-style KV load generator.  Keeps a fixed number of get/upsert
+// operations in flight against a Collection for a set duration, then reports
+// the throughput and latency percentiles of each kind of operation.
+//
+// Without --connstr, a MockServer (bench/mockserver.js) is started as a
+// subprocess and used as the target, so no cluster is needed.  Run it
+// in-process with --mock inprocess, at the cost of sharing the event loop
+// with the SDK.  Requires a build of the SDK (npm run build).
+//
+//   npm run pillowfight -- [--connstr <connstr>] [--username <user>]
+//       [--password <pass>] [--bucket <name>] [--mock subprocess|inprocess]
+//       [--num-items 1000] [--value-size 256] [--set-pct 33]
+//       [--concurrency 64] [--duration 10] [--warmup 2] [--json <file>]
+
+const fs = require('fs')
+
+const couchbase = require('..')
+const binding = require('../dist/binding').default
+const { startMock } = require('./mockserver')
+
+const REPORTED_PERCENTILES = ['50', '90', '99', '99.9', '100']
+
+function parseArgs(argv) {
+  const opts = {
+    connstr: undefined,
+    username: 'Administrator',
+    password: 'password',
+    bucket: 'default',
+    mock: 'subprocess',
+    numItems: 1000,
+    valueSize: 256,
+    setPct: 33,
+    concurrency: 64,
+    duration: 10,
+    warmup: 2,
+    json: undefined,
+  }
+  for (let i = 0; i < argv.length; ++i) {
+    let [name, value] = argv[i].split('=')
+    name = name
+      .replace(/^--/, '')
+      .replace(/-([a-z])/g, (_, c) => c.toUpperCase())
+    if (!(name in opts)) {
+      throw new Error(`Unknown option: ${argv[i]}`)
+    }
+    if (value === undefined) {
+      value = argv[++i]
+    }
+    opts[name] = typeof opts[name] === 'number' ? parseFloat(value) : value
+  }
+  return opts
+}
+
+function makeDocument(size) {
+  const doc = { type: 'pillowfight', value: '' }
+  doc.value = 'x'.repeat(Math.max(0, size - JSON.stringify(doc).length))
+  return doc
+}
+
+function keyFor(i) {
+  return `pillowfight::${String(i).padStart(10, '0')}`
+}
+
+class Stats {
+  constructor() {
+    this._meter = new binding.OperationMeter()
+    this._recorders = {
+      get: this._meter.recorder('kv', 'get'),
+      upsert: this._meter.recorder('kv', 'upsert'),
+    }
+    this.reset()
+  }
+
+  reset() {
+    this._meter.snapshot()
+    this.errors = { get: 0, upsert: 0 }
+    this.startedAt = process.hrtime.bigint()
+  }
+
+  record(op, startedAt, failed) {
+    const elapsedUs = Number(process.hrtime.bigint() - startedAt) / 1000
+    this._meter.record(this._recorders[op], elapsedUs)
+    if (failed) {
+      this.errors[op]++
+    }
+  }
+
+  report() {
+    const elapsedSecs =
+      Number(process.hrtime.bigint() - this.startedAt) / 1000000000
+    const snapshot = this._meter.snapshot().kv || {}
+    const ops = {}
+    let totalCount = 0
+    for (const op of Object.keys(this._recorders)) {
+      const latency = snapshot[op] || { total_count: 0, percentiles_us: {} }
+      totalCount += latency.total_count
+      ops[op] = {
+        count: latency.total_count,
+        errors: this.errors[op],
+        ops_per_sec: latency.total_count / elapsedSecs,
+        latency_us: latency.percentiles_us,
+      }
+    }
+    return {
+      elapsed_s: elapsedSecs,
+      total_ops: totalCount,
+      ops_per_sec: totalCount / elapsedSecs,
+      ops: ops,
+    }
+  }
+}
+
+async function populate(collection, opts, doc) {
+  let next = 0
+  const worker = async () => {
+    while (next < opts.numItems) {
+      await collection.upsert(keyFor(next++), doc)
+    }
+  }
+  await Promise.all(
+    Array.from({ length: Math.min(opts.concurrency, opts.numItems) }, worker)
+  )
+}
+
+async function runWorkload(collection, opts, doc, stats, deadline) {
+  const worker = async () => {
+    while (Date.now() < deadline.at) {
+      const key = keyFor(Math.floor(Math.random() * opts.numItems))
+      const op = Math.random() * 100 < opts.setPct ? 'upsert' : 'get'
+      const startedAt = process.hrtime.bigint()
+      let failed = false
+      try {
+        if (op === 'upsert') {
+          await collection.upsert(key, doc)
+        } else {
+          await collection.get(key)
+        }
+      } catch (e) {
+        failed = true
+      }
+      stats.record(op, startedAt, failed)
+    }
+  }
+  await Promise.all(Array.from({ length: opts.concurrency }, worker))
+}
+
+function printReport(report) {
+  console.log(
+    `${report.total_ops} ops in ${report.elapsed_s.toFixed(1)}s, ` +
+      `${report.ops_per_sec.toFixed(0)} ops/sec`
+  )
+  console.table(
+    Object.fromEntries(
+      Object.entries(report.ops).map(([op, res]) => [
+        op,
+        {
+          count: res.count,
+          errors: res.errors,
+          'ops/sec': res.ops_per_sec.toFixed(0),
+          ...Object.fromEntries(
+            REPORTED_PERCENTILES.map((p) => [
+              p === '100' ? 'max us' : `p${p} us`,
+              res.latency_us[p],
+            ])
+          ),
+        },
+      ])
+    )
+  )
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2))
+
+  let mock
+  if (!opts.connstr) {
+    mock = await startMock(opts.mock)
+    opts.connstr = mock.details.connstr
+    opts.username = mock.details.username
+    opts.password = mock.details.password
+    opts.bucket = mock.details.bucket
+  }
+
+  const cluster = await couchbase.connect(opts.connstr, {
+    username: opts.username,
+    password: opts.password,
+  })
+  try {
+    const collection = cluster.bucket(opts.bucket).defaultCollection()
+    const doc = makeDocument(opts.valueSize)
+    await populate(collection, opts, doc)
+
+    const stats = new Stats()
+    const deadline = { at: Date.now() + (opts.warmup + opts.duration) * 1000 }
+    const workload = runWorkload(collection, opts, doc, stats, deadline)
+
+    await new Promise((resolve) => setTimeout(resolve, opts.warmup * 1000))
+    stats.reset()
+    await workload
+
+    const report = stats.report()
+    printReport(report)
+    if (opts.json) {
+      const result = {
+        timestamp: new Date().toISOString(),
+        node: process.version,
+        target: mock ? `mock (${opts.mock})` : opts.connstr,
+        options: { ...opts, password: undefined },
+        ...report,
+      }
+      fs.writeFileSync(opts.json, JSON.stringify(result, null, 2) + '\n')
+    }
+  } finally {
+    await cluster.close()
+    if (mock) {
+      await mock.stop()
+    }
+  }
+}
+
+main().catch((err) => {
+  console.error(err)
+  process.exitCode = 1
+})
@@ -0,0 +1,203 @@
+'use strict'
+
+// Compares the cost of encoding and decoding documents with the JSON
+// (DefaultTranscoder, with and without nativeJson), MessagePack and CBOR
+// transcoders, in ns/op, along with the size of the encoded documents.  No
+// cluster is needed.
+//
+//   npm run build
+//   npm run bench-transcoders -- [--filter <regex>] [--iterations <n>]
+//                                [--runs <n>] [--payload <file>]
+//                                [--json <file>]
+//
+// --payload adds the documents of a JSON file (an object mapping names to
+// documents) to the built-in payload shapes.
+
+const fs = require('fs')
+const { CborTranscoder, DefaultTranscoder, MsgpackTranscoder } = require('..')
+
+const TRANSCODERS = {
+  json: new DefaultTranscoder(),
+  'json-native': new DefaultTranscoder({ nativeJson: true }),
+  msgpack: new MsgpackTranscoder(),
+  cbor: new CborTranscoder(),
+}
+
+function userProfile(i) {
+  return {
+    id: `user::${String(i).padStart(20, '0')}`,
+    type: 'user',
+    name: { first: 'Ada', last: 'Lovelace' },
+    email: 'ada@example.com',
+    age: 36,
+    verified: true,
+    score: 1234.5,
+    roles: ['admin', 'editor', 'viewer'],
+    address: {
+      street: '12 St James Square',
+      city: 'London',
+      postcode: 'SW1Y 4JH',
+      geo: { lat: 51.5074, lon: -0.1337 },
+    },
+    preferences: { theme: 'dark', language: 'en-GB', notifications: false },
+    created: 1700000000000 + i,
+    lastLogin: null,
+  }
+}
+
+const PAYLOADS = {
+  small: { id: 42, type: 'counter', value: 7, active: true },
+  profile: userProfile(42),
+  'event-batch': {
+    events: Array.from({ length: 100 }, (_, i) => ({
+      seq: i,
+      kind: i % 3 ? 'click' : 'view',
+      ts: 1700000000000 + i * 17,
+      durationMs: (i * 7) % 250,
+    })),
+  },
+  numeric: {
+    ints: Array.from({ length: 500 }, (_, i) => i * 1009),
+    floats: Array.from({ length: 500 }, (_, i) => i / 7),
+  },
+  text: {
+    title: 'x'.repeat(64),
+    body: 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. '.repeat(
+      80
+    ),
+    tags: Array.from({ length: 20 }, (_, i) => `tag-${i}`),
+  },
+  'profile-list': Array.from({ length: 50 }, (_, i) => userProfile(i)),
+}
+
+function parseArgs(argv) {
+  const opts = {
+    filter: undefined,
+    iterations: 20000,
+    runs: 5,
+    payload: undefined,
+    json: undefined,
+  }
+  for (let i = 0; i < argv.length; ++i) {
+    let [name, value] = argv[i].split('=')
+    name = name.replace(/^--/, '')
+    if (!(name in opts)) {
+      throw new Error(`Unknown option: ${argv[i]}`)
+    }
+    if (value === undefined) {
+      value = argv[++i]
+    }
+    opts[name] = typeof opts[name] === 'number' ? parseFloat(value) : value
+  }
+  return opts
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b)
+  const mid = Math.floor(sorted.length / 2)
+  return sorted.length % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2
+}
+
+// Larger documents get proportionally fewer iterations, so that every case
+// takes a similar amount of time.
+function iterationsFor(size, opts) {
+  return Math.max(
+    100,
+    Math.floor((opts.iterations * 256) / Math.max(size, 256))
+  )
+}
+
+function measure(fn, iterations, runs) {
+  for (let i = 0; i < Math.max(1, Math.floor(iterations / 10)); ++i) {
+    fn()
+  }
+
+  const nsPerOp = []
+  for (let run = 0; run < runs; ++run) {
+    const start = process.hrtime.bigint()
+    for (let i = 0; i < iterations; ++i) {
+      fn()
+    }
+    nsPerOp.push(Number(process.hrtime.bigint() - start) / iterations)
+  }
+  return median(nsPerOp)
+}
+
+function runCase(payloadName, payload, transcoderName, opts) {
+  const transcoder = TRANSCODERS[transcoderName]
+  const [bytes, flags] = transcoder.encode(payload)
+  const iterations = iterationsFor(bytes.length, opts)
+
+  return {
+    payload: payloadName,
+    transcoder: transcoderName,
+    bytes: bytes.length,
+    encode_ns_per_op: measure(
+      () => transcoder.encode(payload),
+      iterations,
+      opts.runs
+    ),
+    decode_ns_per_op: measure(
+      () => transcoder.decode(bytes, flags),
+      iterations,
+      opts.runs
+    ),
+  }
+}
+
+function main() {
+  const opts = parseArgs(process.argv.slice(2))
+  const payloads = { ...PAYLOADS }
+  if (opts.payload) {
+    Object.assign(payloads, JSON.parse(fs.readFileSync(opts.payload, 'utf8')))
+  }
+  const filter = opts.filter ? new RegExp(opts.filter) : undefined
+
+  const results = []
+  for (const [payloadName, payload] of Object.entries(payloads)) {
+    for (const transcoderName of Object.keys(TRANSCODERS)) {
+      if (filter && !filter.test(`${payloadName}/${transcoderName}`)) {
+        continue
+      }
+      results.push(runCase(payloadName, payload, transcoderName, opts))
+    }
+  }
+
+  const baselines = new Map(
+    results
+      .filter((r) => r.transcoder === 'json')
+      .map((r) => [r.payload, r])
+  )
+  const relative = (value, base) =>
+    base ? `${((value / base) * 100).toFixed(0)}%` : ''
+
+  console.table(
+    results.map((r) => {
+      const base = baselines.get(r.payload)
+      return {
+        payload: r.payload,
+        transcoder: r.transcoder,
+        bytes: r.bytes,
+        'size vs json': relative(r.bytes, base?.bytes),
+        'encode ns/op': r.encode_ns_per_op.toFixed(0),
+        'decode ns/op': r.decode_ns_per_op.toFixed(0),
+        'encode vs json': relative(r.encode_ns_per_op, base?.encode_ns_per_op),
+        'decode vs json': relative(r.decode_ns_per_op, base?.decode_ns_per_op),
+      }
+    })
+  )
+
+  if (opts.json) {
+    const report = {
+      timestamp: new Date().toISOString(),
+      node: process.version,
+      platform: `${process.platform}-${process.arch}`,
+      iterations: opts.iterations,
+      runs: opts.runs,
+      results,
+    }
+    fs.writeFileSync(opts.json, JSON.stringify(report, null, 2) + '\n')
+  }
+}
+
+main()
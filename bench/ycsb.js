@@ -0,0 +1,700 @@
+'use strict'
+
+// A YCSB-style workload driver.  Implements the core workloads A-F on top of
+// Collection, lookupIn/mutateIn (with --subdoc) and scan(), and reports the
+// throughput and latency percentiles of each kind of operation.
+//
+//   A: 50% read, 50% update                        (zipfian)
+//   B: 95% read, 5% update                         (zipfian)
+//   C: 100% read                                   (zipfian)
+//   D: 95% read, 5% insert, reading recent inserts (latest)
+//   E: 95% short range scans, 5% insert            (zipfian)
+//   F: 50% read, 50% read-modify-write with CAS    (zipfian)
+//
+// Without --connstr, a MockServer (bench/mockserver.js) is used as the
+// target.  The mock does not implement range scans, so workload E needs a
+// cluster.  With --threads, the workload is split across that many
+// worker_threads, each with its own connection, to measure multi-core
+// scaling.  Requires a build of the SDK (npm run build).
+//
+//   npm run ycsb -- --workload a [--connstr <connstr>] [--username <user>]
+//       [--password <pass>] [--bucket <name>] [--mock subprocess|inprocess]
+//       [--record-count 10000] [--field-count 10] [--field-length 100]
+//       [--max-scan-length 100] [--distribution <name|module.js>]
+//       [--subdoc] [--threads 1] [--concurrency 32] [--duration 10]
+//       [--warmup 2] [--no-load] [--json <file>]
+//
+// --distribution overrides the key distribution of the workload with one of
+// uniform, zipfian, latest or hotspot, or with a module exporting a factory
+// function of the same shape as those in DISTRIBUTIONS.
+
+const fs = require('fs')
+const path = require('path')
+const {
+  Worker,
+  isMainThread,
+  parentPort,
+  workerData,
+} = require('worker_threads')
+
+const WORKLOADS = {
+  a: { read: 0.5, update: 0.5, distribution: 'zipfian' },
+  b: { read: 0.95, update: 0.05, distribution: 'zipfian' },
+  c: { read: 1, distribution: 'zipfian' },
+  d: { read: 0.95, insert: 0.05, distribution: 'latest' },
+  e: { scan: 0.95, insert: 0.05, distribution: 'zipfian' },
+  f: { read: 0.5, readModifyWrite: 0.5, distribution: 'zipfian' },
+}
+
+const OPERATIONS = ['read', 'update', 'insert', 'scan', 'readModifyWrite']
+const REPORTED_PERCENTILES = [50, 90, 95, 99, 99.9]
+
+// Generates zipfian distributed integers in [0, items), following Gray et
+// al., "Quickly Generating Billion-Record Synthetic Databases", as YCSB does.
+// The item count may grow, in which case zeta is extended incrementally.
+class ZipfianGenerator {
+  constructor(items, theta, zetan) {
+    this.theta = theta || 0.99
+    this.alpha = 1 / (1 - this.theta)
+    this.zeta2 = this._zeta(0, 2, 0)
+    this.items = 0
+    this.zetan = 0
+    if (zetan !== undefined) {
+      this.items = items
+      this.zetan = zetan
+    } else {
+      this._grow(items)
+    }
+    this._updateEta()
+  }
+
+  _zeta(from, to, initial) {
+    let sum = initial
+    for (let i = from; i < to; ++i) {
+      sum += 1 / Math.pow(i + 1, this.theta)
+    }
+    return sum
+  }
+
+  _grow(items) {
+    this.zetan = this._zeta(this.items, items, this.zetan)
+    this.items = items
+    this._updateEta()
+  }
+
+  _updateEta() {
+    this.eta =
+      (1 - Math.pow(2 / this.items, 1 - this.theta)) /
+      (1 - this.zeta2 / this.zetan)
+  }
+
+  next(items) {
+    if (items !== undefined && items > this.items) {
+      this._grow(items)
+    }
+    const u = Math.random()
+    const uz = u * this.zetan
+    if (uz < 1) {
+      return 0
+    }
+    if (uz < 1 + Math.pow(0.5, this.theta)) {
+      return 1
+    }
+    return Math.floor(
+      this.items * Math.pow(this.eta * u - this.eta + 1, this.alpha)
+    )
+  }
+}
+
+// FNV-1a over the 32 bits of the value, used to scatter the popular items of
+// the zipfian distribution across the keyspace.
+function fnvHash32(value) {
+  let hash = 0x811c9dc5
+  for (let i = 0; i < 4; ++i) {
+    hash ^= (value >>> (i * 8)) & 0xff
+    hash = Math.imul(hash, 0x01000193) >>> 0
+  }
+  return hash
+}
+
+// Key distributions.  Each factory is given a function returning the number
+// of records currently in the keyspace, and returns a generator whose next()
+// picks the index of a record.
+const DISTRIBUTIONS = {
+  uniform: (recordCount) => ({
+    next: () => Math.floor(Math.random() * recordCount()),
+  }),
+
+  // Scrambled zipfian over a fixed, large item space (with its zeta
+  // precomputed, as in YCSB), so that the keyspace can grow without the
+  // popular records changing.
+  zipfian: (recordCount) => {
+    const zipfian = new ZipfianGenerator(1e10, 0.99, 26.46902820178302)
+    return {
+      next: () => fnvHash32(zipfian.next()) % recordCount(),
+    }
+  },
+
+  // Skewed towards the most recently inserted records.
+  latest: (recordCount) => {
+    const zipfian = new ZipfianGenerator(recordCount())
+    return {
+      next: () => {
+        const count = recordCount()
+        return Math.max(0, count - 1 - zipfian.next(count))
+      },
+    }
+  },
+
+  // 80% of operations go to 20% of the records.
+  hotspot: (recordCount) => ({
+    next: () => {
+      const count = recordCount()
+      const hotCount = Math.max(1, Math.floor(count * 0.2))
+      // with a single record there is nothing outside of the hot set
+      if (hotCount >= count || Math.random() < 0.8) {
+        return Math.floor(Math.random() * hotCount)
+      }
+      return hotCount + Math.floor(Math.random() * (count - hotCount))
+    },
+  }),
+}
+
+// A mergeable latency histogram, in microseconds.  Values below 1024us are
+// kept exactly, larger values in buckets which are within 1% of each other.
+class Histogram {
+  constructor() {
+    this.counts = new Map()
+    this.total = 0
+    this.max = 0
+  }
+
+  static _bucketOf(value) {
+    if (value < 1024) {
+      return value
+    }
+    const exp = Math.floor(Math.log2(value))
+    return 1024 + (exp - 10) * 128 + (Math.floor(value / 2 ** (exp - 7)) - 128)
+  }
+
+  static _valueOf(bucket) {
+    if (bucket < 1024) {
+      return bucket
+    }
+    const exp = Math.floor((bucket - 1024) / 128) + 10
+    return (((bucket - 1024) % 128) + 128) * 2 ** (exp - 7)
+  }
+
+  record(valueUs) {
+    const value = Math.max(0, Math.round(valueUs))
+    const bucket = Histogram._bucketOf(value)
+    this.counts.set(bucket, (this.counts.get(bucket) || 0) + 1)
+    this.total++
+    this.max = Math.max(this.max, value)
+  }
+
+  merge(other) {
+    for (const [bucket, count] of other.counts) {
+      this.counts.set(bucket, (this.counts.get(bucket) || 0) + count)
+    }
+    this.total += other.total
+    this.max = Math.max(this.max, other.max)
+  }
+
+  percentile(p) {
+    const target = Math.ceil((p / 100) * this.total)
+    let seen = 0
+    for (const bucket of [...this.counts.keys()].sort((a, b) => a - b)) {
+      seen += this.counts.get(bucket)
+      if (seen >= target) {
+        return Histogram._valueOf(bucket)
+      }
+    }
+    return this.max
+  }
+
+  serialize() {
+    return { counts: [...this.counts], total: this.total, max: this.max }
+  }
+
+  static deserialize(data) {
+    const histogram = new Histogram()
+    histogram.counts = new Map(data.counts)
+    histogram.total = data.total
+    histogram.max = data.max
+    return histogram
+  }
+}
+
+function parseArgs(argv) {
+  const opts = {
+    workload: 'a',
+    connstr: undefined,
+    username: 'Administrator',
+    password: 'password',
+    bucket: 'default',
+    mock: 'subprocess',
+    recordCount: 10000,
+    fieldCount: 10,
+    fieldLength: 100,
+    maxScanLength: 100,
+    distribution: undefined,
+    subdoc: false,
+    threads: 1,
+    concurrency: 32,
+    duration: 10,
+    warmup: 2,
+    load: true,
+    json: undefined,
+  }
+  for (let i = 0; i < argv.length; ++i) {
+    let [name, value] = argv[i].split('=')
+    name = name
+      .replace(/^--/, '')
+      .replace(/-([a-z])/g, (_, c) => c.toUpperCase())
+    if (name === 'noLoad') {
+      opts.load = false
+      continue
+    }
+    if (!(name in opts)) {
+      throw new Error(`Unknown option: ${argv[i]}`)
+    }
+    if (typeof opts[name] === 'boolean') {
+      opts[name] = value === undefined ? true : value !== 'false'
+      continue
+    }
+    if (value === undefined) {
+      value = argv[++i]
+    }
+    opts[name] = typeof opts[name] === 'number' ? parseFloat(value) : value
+  }
+
+  opts.workload = opts.workload.toLowerCase()
+  if (!WORKLOADS[opts.workload]) {
+    throw new Error(`Unknown workload: ${opts.workload}`)
+  }
+  return opts
+}
+
+function loadDistribution(name) {
+  if (DISTRIBUTIONS[name]) {
+    return DISTRIBUTIONS[name]
+  }
+  if (name.endsWith('.js')) {
+    return require(path.resolve(name))
+  }
+  throw new Error(`Unknown distribution: ${name}`)
+}
+
+//#region Worker
+
+function keyFor(i) {
+  return `user${String(i).padStart(12, '0')}`
+}
+
+class RecordFactory {
+  constructor(fieldCount, fieldLength) {
+    this.fieldCount = fieldCount
+    // Field values are drawn from a pool, to keep generating them out of
+    // the measurements.
+    this._values = Array.from({ length: 1024 }, () => {
+      let value = ''
+      while (value.length < fieldLength) {
+        value += Math.random().toString(36).slice(2)
+      }
+      return value.slice(0, fieldLength)
+    })
+  }
+
+  fieldName() {
+    return `field${Math.floor(Math.random() * this.fieldCount)}`
+  }
+
+  fieldValue() {
+    return this._values[Math.floor(Math.random() * this._values.length)]
+  }
+
+  record() {
+    const record = {}
+    for (let i = 0; i < this.fieldCount; ++i) {
+      record[`field${i}`] = this.fieldValue()
+    }
+    return record
+  }
+}
+
+class WorkloadRunner {
+  constructor(couchbase, collection, opts, counters) {
+    this.couchbase = couchbase
+    this.collection = collection
+    this.opts = opts
+    this.workload = WORKLOADS[opts.workload]
+    this.records = new RecordFactory(opts.fieldCount, opts.fieldLength)
+
+    // Shared across all of the workers: [next insert index, inserts done]
+    this.counters = counters
+    const recordCount = () =>
+      opts.recordCount + Atomics.load(this.counters, 1)
+    const distribution = opts.distribution || this.workload.distribution
+    this.keys = loadDistribution(distribution)(recordCount)
+
+    this._thresholds = []
+    let cumulative = 0
+    for (const op of OPERATIONS) {
+      if (this.workload[op]) {
+        cumulative += this.workload[op]
+        this._thresholds.push([cumulative, op])
+      }
+    }
+    this.reset()
+  }
+
+  reset() {
+    this.histograms = {}
+    this.errors = {}
+    for (const [, op] of this._thresholds) {
+      this.histograms[op] = new Histogram()
+      this.errors[op] = 0
+    }
+    this.startedAt = process.hrtime.bigint()
+  }
+
+  _chooseOperation() {
+    const r = Math.random()
+    for (const [threshold, op] of this._thresholds) {
+      if (r < threshold) {
+        return op
+      }
+    }
+    return this._thresholds[this._thresholds.length - 1][1]
+  }
+
+  async read(key) {
+    if (this.opts.subdoc) {
+      const { LookupInSpec } = this.couchbase
+      await this.collection.lookupIn(key, [
+        LookupInSpec.get(this.records.fieldName()),
+      ])
+    } else {
+      await this.collection.get(key)
+    }
+  }
+
+  async update(key) {
+    if (this.opts.subdoc) {
+      const { MutateInSpec } = this.couchbase
+      const field = this.records.fieldName()
+      await this.collection.mutateIn(key, [
+        MutateInSpec.upsert(field, this.records.fieldValue()),
+      ])
+    } else {
+      await this.collection.upsert(key, this.records.record())
+    }
+  }
+
+  async insert() {
+    const index = this.opts.recordCount + Atomics.add(this.counters, 0, 1)
+    await this.collection.insert(keyFor(index), this.records.record())
+    Atomics.add(this.counters, 1, 1)
+  }
+
+  async scan(index) {
+    const { RangeScan, ScanTerm } = this.couchbase
+    const length = 1 + Math.floor(Math.random() * this.opts.maxScanLength)
+    await this.collection.scan(
+      new RangeScan(
+        new ScanTerm(keyFor(index)),
+        new ScanTerm(keyFor(index + length), true)
+      )
+    )
+  }
+
+  async readModifyWrite(key) {
+    const field = this.records.fieldName()
+    if (this.opts.subdoc) {
+      const { LookupInSpec, MutateInSpec } = this.couchbase
+      const res = await this.collection.lookupIn(key, [LookupInSpec.get(field)])
+      await this.collection.mutateIn(
+        key,
+        [MutateInSpec.replace(field, this.records.fieldValue())],
+        { cas: res.cas }
+      )
+    } else {
+      const res = await this.collection.get(key)
+      const record = res.content
+      record[field] = this.records.fieldValue()
+      await this.collection.replace(key, record, { cas: res.cas })
+    }
+  }
+
+  async load(workerIdx, numWorkers) {
+    let next = workerIdx
+    const loader = async () => {
+      while (next < this.opts.recordCount) {
+        const index = next
+        next += numWorkers
+        await this.collection.upsert(keyFor(index), this.records.record())
+      }
+    }
+    await Promise.all(Array.from({ length: this.opts.concurrency }, loader))
+  }
+
+  async run(deadline) {
+    const loop = async () => {
+      while (Date.now() < deadline) {
+        const op = this._chooseOperation()
+        const index = this.keys.next()
+        const startedAt = process.hrtime.bigint()
+        try {
+          await this[op](op === 'scan' ? index : keyFor(index))
+        } catch (e) {
+          this.errors[op]++
+        }
+        this.histograms[op].record(
+          Number(process.hrtime.bigint() - startedAt) / 1000
+        )
+      }
+    }
+    await Promise.all(Array.from({ length: this.opts.concurrency }, loop))
+  }
+
+  result() {
+    const histograms = {}
+    for (const [op, histogram] of Object.entries(this.histograms)) {
+      histograms[op] = histogram.serialize()
+    }
+    return {
+      elapsed_ns: Number(process.hrtime.bigint() - this.startedAt),
+      histograms: histograms,
+      errors: this.errors,
+    }
+  }
+}
+
+async function runWorker() {
+  const { opts, connstr, workerIdx, numWorkers, counters } = workerData
+  const couchbase = require('..')
+  const cluster = await couchbase.connect(connstr, {
+    username: opts.username,
+    password: opts.password,
+  })
+
+  try {
+    const collection = cluster.bucket(opts.bucket).defaultCollection()
+    const runner = new WorkloadRunner(
+      couchbase,
+      collection,
+      opts,
+      new Int32Array(counters)
+    )
+
+    const nextMessage = () =>
+      new Promise((resolve) => parentPort.once('message', resolve))
+
+    if (opts.load) {
+      await runner.load(workerIdx, numWorkers)
+    }
+    parentPort.postMessage({ type: 'loaded' })
+
+    const { warmupUntil, deadline } = await nextMessage()
+    const running = runner.run(deadline)
+    await new Promise((resolve) =>
+      setTimeout(resolve, Math.max(0, warmupUntil - Date.now()))
+    )
+    runner.reset()
+    await running
+
+    parentPort.postMessage({ type: 'result', result: runner.result() })
+  } finally {
+    await cluster.close()
+  }
+}
+
+//#endregion Worker
+
+//#region Main
+
+function summarize(results, opts) {
+  const elapsedSecs =
+    Math.max(...results.map((r) => r.elapsed_ns)) / 1000000000
+  const ops = {}
+  let totalOps = 0
+  for (const result of results) {
+    for (const [op, data] of Object.entries(result.histograms)) {
+      if (!ops[op]) {
+        ops[op] = { histogram: new Histogram(), errors: 0 }
+      }
+      ops[op].histogram.merge(Histogram.deserialize(data))
+      ops[op].errors += result.errors[op]
+    }
+  }
+
+  const summary = {}
+  for (const [op, { histogram, errors }] of Object.entries(ops)) {
+    totalOps += histogram.total
+    const latency = {}
+    for (const p of REPORTED_PERCENTILES) {
+      latency[`p${p}`] = histogram.percentile(p)
+    }
+    latency.max = histogram.max
+    summary[op] = {
+      count: histogram.total,
+      errors: errors,
+      ops_per_sec: histogram.total / elapsedSecs,
+      latency_us: latency,
+    }
+  }
+
+  return {
+    workload: opts.workload.toUpperCase(),
+    threads: opts.threads,
+    elapsed_s: elapsedSecs,
+    total_ops: totalOps,
+    ops_per_sec: totalOps / elapsedSecs,
+    ops: summary,
+  }
+}
+
+function printReport(report) {
+  console.log(
+    `workload ${report.workload}, ${report.threads} thread(s): ` +
+      `${report.total_ops} ops in ${report.elapsed_s.toFixed(1)}s, ` +
+      `${report.ops_per_sec.toFixed(0)} ops/sec`
+  )
+  console.table(
+    Object.fromEntries(
+      Object.entries(report.ops).map(([op, res]) => [
+        op,
+        {
+          count: res.count,
+          errors: res.errors,
+          'ops/sec': res.ops_per_sec.toFixed(0),
+          ...Object.fromEntries(
+            Object.entries(res.latency_us).map(([p, v]) => [`${p} us`, v])
+          ),
+        },
+      ])
+    )
+  )
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2))
+  if (opts.distribution) {
+    // Fail early on an unknown distribution, rather than in the workers.
+    loadDistribution(opts.distribution)
+  }
+
+  let mock
+  let connstr = opts.connstr
+  if (!connstr) {
+    if (WORKLOADS[opts.workload].scan) {
+      throw new Error(
+        'Workload E uses range scans, which the mock server does not ' +
+          'implement.  Pass --connstr to run it against a cluster.'
+      )
+    }
+    const { startMock } = require('./mockserver')
+    mock = await startMock(opts.mock)
+    connstr = mock.details.connstr
+    opts.username = mock.details.username
+    opts.password = mock.details.password
+    opts.bucket = mock.details.bucket
+  }
+
+  const counters = new SharedArrayBuffer(2 * Int32Array.BYTES_PER_ELEMENT)
+  const workers = []
+  try {
+    for (let i = 0; i < opts.threads; ++i) {
+      workers.push(
+        new Worker(__filename, {
+          workerData: {
+            opts: opts,
+            connstr: connstr,
+            workerIdx: i,
+            numWorkers: opts.threads,
+            counters: counters,
+          },
+        })
+      )
+    }
+
+    const messages = workers.map((worker) => {
+      const queue = []
+      const waiting = []
+      let failure = null
+      const fail = (err) => {
+        if (!failure) {
+          failure = err
+          waiting.splice(0).forEach((w) => w.reject(err))
+        }
+      }
+      worker.on('message', (msg) =>
+        waiting.length ? waiting.shift().resolve(msg) : queue.push(msg)
+      )
+      worker.on('error', fail)
+      // a worker which dies without an 'error' event (e.g. process.exit or
+      // an out of memory abort) would otherwise leave main() waiting forever
+      worker.on('exit', (code) =>
+        fail(
+          new Error(
+            code === 0
+              ? 'worker exited before reporting its results'
+              : `worker exited with code ${code}`
+          )
+        )
+      )
+      return () => {
+        if (queue.length) {
+          return Promise.resolve(queue.shift())
+        }
+        if (failure) {
+          return Promise.reject(failure)
+        }
+        return new Promise((resolve, reject) => waiting.push({ resolve, reject }))
+      }
+    })
+
+    await Promise.all(messages.map((next) => next()))
+    const warmupUntil = Date.now() + opts.warmup * 1000
+    const deadline = warmupUntil + opts.duration * 1000
+    workers.forEach((worker) => worker.postMessage({ warmupUntil, deadline }))
+    const results = (await Promise.all(messages.map((next) => next()))).map(
+      (msg) => msg.result
+    )
+
+    const report = summarize(results, opts)
+    printReport(report)
+    if (opts.json) {
+      const output = {
+        timestamp: new Date().toISOString(),
+        node: process.version,
+        target: mock ? `mock (${opts.mock})` : connstr,
+        options: { ...opts, password: undefined },
+        ...report,
+      }
+      fs.writeFileSync(opts.json, JSON.stringify(output, null, 2) + '\n')
+    }
+  } finally {
+    await Promise.all(workers.map((worker) => worker.terminate()))
+    if (mock) {
+      await mock.stop()
+    }
+  }
+}
+
+//#endregion Main
+
+module.exports = { WORKLOADS, DISTRIBUTIONS, ZipfianGenerator, Histogram }
+
+if (!isMainThread) {
+  runWorker().catch((err) => {
+    console.error(err)
+    process.exit(1)
+  })
+} else if (require.main === module) {
+  main().catch((err) => {
+    console.error(err)
+    process.exitCode = 1
+  })
+}
@@ -77,7 +77,27 @@ export interface CppScanIterator {
       result: CppRangeScanItem | undefined
     ) => void
   ): void
+  nextKeys(
+    limit: number,
+    callback: (
+      err: CppError | null,
+      result: CppScanKeyBatch | undefined
+    ) => void
+  ): void
   cancel(): boolean
+  checkpoint(consumed?: number): Buffer | undefined
+}
+
+export interface CppScanIteratorOptions {
+  track_progress?: boolean
+  resume_from?: Buffer
+  buffer_byte_limit?: number
+  decompress_values?: boolean
+}
+
+export interface CppScanKeyBatch {
+  keys: Buffer
+  lengths: Uint32Array
 }
 
 export interface CppEncodedValue {
@@ -103,6 +123,9 @@ export interface CppWrapperSdkChildSpan {
 
 export interface CppObservableRequest {
   wrapper_span_name?: string
+  native_threshold_log?: boolean
+  meter_recorder_id?: number
+  decompress_values?: boolean
 }
 
 export interface CppObservableResponse {
@@ -114,6 +137,18 @@ export type ObservableBindingFunc<
   TResp extends CppObservableResponse,
 > = (req: TReq, cb: (err: CppError | null, res: TResp) => void) => void
 
+export type ObservableStreamingBindingFunc<
+  TReq extends CppObservableRequests,
+  TEntry,
+> = (
+  req: TReq,
+  cb: (
+    err: CppError | null,
+    res: TEntry | CppObservableResponse | null,
+    done: boolean
+  ) => void
+) => void
+
 export interface CppClusterLabelsResponse {
   clusterName?: string
   clusterUUID?: string
@@ -3880,6 +3915,25 @@ export type CppError =
   | CppTxnOpException
   | CppTxnError
 
+export interface CppConnectionStats {
+  in_flight: number
+  pending_completions: number
+  max_pending_completions: number
+  completion_delay_us: CppLatencySnapshot
+}
+
+export interface CppNodeServiceStats {
+  total_count: number
+  error_count: number
+  throughput_per_s: number
+  latency_us: CppLatencySnapshot
+}
+
+export interface CppNodeStats {
+  interval_s: number
+  nodes: { [node: string]: { [service: string]: CppNodeServiceStats } }
+}
+
 export interface CppConnection extends CppConnectionAutogen {
   connect(
     connStr: string,
@@ -3893,6 +3947,13 @@ export interface CppConnection extends CppConnectionAutogen {
 
   updateCredentials(credentials: CppClusterCredentials): CppError | null
 
+  setThresholdLogger(logger: CppThresholdLogger | null): void
+  setOperationMeter(meter: CppOperationMeter | null): void
+
+  stats(): CppConnectionStats
+
+  nodeStats(): CppNodeStats
+
   shutdown(callback: (err: CppError | null) => void): void
 
   openBucket(bucketName: string, callback: (err: CppError | null) => void): void
@@ -3958,10 +4019,33 @@ export interface CppConnection extends CppConnectionAutogen {
     collection_name: string,
     scan_type_name: string,
     scan_type_value: CppRangeScan | CppSamplingScan | CppPrefixScan,
-    options: CppRangeScanOrchestratorOptions
-  ): { cppErr: CppError | null; result: CppScanIterator }
+    options: CppRangeScanOrchestratorOptions,
+    iteratorOptions: CppScanIteratorOptions,
+    callback: (err: CppError | null, result: CppScanIterator | null) => void
+  ): void
 
   getClusterLabels(): CppClusterLabelsResponse
+
+  getAllReplicasStream(
+    options: CppGetAllReplicasRequest,
+    callback: (
+      err: CppError | null,
+      result: CppGetAllReplicasResponseEntry | CppObservableResponse | null,
+      done: boolean
+    ) => void
+  ): void
+
+  lookupInAllReplicasStream(
+    options: CppLookupInAllReplicasRequest,
+    callback: (
+      err: CppError | null,
+      result:
+        | CppLookupInAllReplicasResponseEntry
+        | CppObservableResponse
+        | null,
+      done: boolean
+    ) => void
+  ): void
 }
 
 export interface CppTransactionKeyspace {
@@ -4001,7 +4085,7 @@ export interface CppTransactionLinks {
   exptime_pre_txn: number
   crc32_of_staging: string
   op: string
-  forward_compat: string
+  forward_compat?: any
   is_deleted: boolean
 }
 
@@ -4039,9 +4123,17 @@ export interface CppTransactions {
   close(callback: (err: CppError | null) => void): void
 }
 
+export interface CppTransactionTimings {
+  stages: { [stage: string]: { count: number; total_us: number } }
+  callback_count: number
+  callback_delay_us: number
+}
+
 export interface CppTransaction {
   newAttempt(callback: (err: CppError | null) => void): void
 
+  takeTimings(): CppTransactionTimings
+
   get(
     options: {
       id: CppDocumentId
@@ -4113,6 +4205,35 @@ export interface CppTransaction {
     callback: (err: CppError | null) => void
   ): void
 
+  insertMulti(
+    options: {
+      ids: CppDocumentId[]
+      contents: CppEncodedValue[]
+    },
+    callback: (
+      err: CppError | null,
+      result: (CppTransactionGetResult | undefined)[] | null
+    ) => void
+  ): void
+
+  replaceMulti(
+    options: {
+      docs: CppTransactionGetResult[]
+      contents: CppEncodedValue[]
+    },
+    callback: (
+      err: CppError | null,
+      result: (CppTransactionGetResult | undefined)[] | null
+    ) => void
+  ): void
+
+  removeMulti(
+    options: {
+      docs: CppTransactionGetResult[]
+    },
+    callback: (err: CppError | null) => void
+  ): void
+
   query(
     statement: string,
     options: {
@@ -4141,24 +4262,67 @@ export interface CppTransaction {
   rollback(callback: (err: CppError | null) => void): void
 }
 
+export interface CppLatencySnapshot {
+  total_count: number
+  percentiles_us: Record<string, number>
+}
+
+export interface CppOperationMeter {
+  recorder(service: string, op: string): number
+  record(recorderId: number, valueMicros: number): void
+  snapshot(): Record<string, Record<string, CppLatencySnapshot>>
+}
+
+export interface CppThresholdLoggerConfig {
+  thresholds_us: Record<string, number>
+  sample_size: number
+}
+
+export interface CppThresholdLogger {
+  addRecord(service: string, record: Record<string, string | number>): void
+  report(): Record<
+    string,
+    { total_count: number; top_requests: Record<string, string | number>[] }
+  >
+}
+
 export interface CppBinding extends CppBindingAutogen {
   cbppVersion: string
   cbppMetadata: string
   enableProtocolLogger: (filename: string) => void
   shutdownLogger: () => void
+  jsonEncode: (value: any) => Buffer | undefined
+  jsonDecode: (bytes: Buffer) => any
+  msgpackEncode: (value: any) => Buffer
+  msgpackDecode: (bytes: Buffer) => any
+  cborEncode: (value: any) => Buffer
+  cborDecode: (bytes: Buffer) => any
+  valueCompressionAlgorithms: string[]
 
   Connection: {
     new (): CppConnection
   }
 
   Transactions: {
-    new (conn: CppConnection, config: CppTransactionsConfig): CppTransactions
+    create(
+      conn: CppConnection,
+      config: CppTransactionsConfig,
+      callback: (err: CppError | null, result: CppTransactions | null) => void
+    ): void
   }
 
   Transaction: {
     new (txns: CppTransactions, options: CppTransactionOptions): CppTransaction
   }
 
+  OperationMeter: {
+    new (): CppOperationMeter
+  }
+
+  ThresholdLogger: {
+    new (config: CppThresholdLoggerConfig): CppThresholdLogger
+  }
+
   protocol_lookup_in_request_body_doc_flag: {
     access_deleted: number
   }
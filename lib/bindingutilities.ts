@@ -76,6 +76,7 @@ import {
   TransactionGetMultiReplicasFromPreferredServerGroupMode,
   TransactionKeyspace,
 } from './transactions'
+import { CompressingTranscoder, Transcoder } from './transcoders'
 import { nsServerStrToDuraLevel } from './utilities'
 import { VectorQueryCombination } from './vectorsearch'
 import {
@@ -1933,3 +1934,13 @@ export function transactionGetMultiReplicasFromPreferredServerGroupModeToCpp(
     )
   )
 }
+
+/**
+ * Values are only decompressed natively for the transcoders which compress
+ * them, so that reads with any other transcoder are left untouched.
+ *
+ * @internal
+ */
+export function decompressValuesToCpp(transcoder: Transcoder): boolean {
+  return transcoder instanceof CompressingTranscoder
+}
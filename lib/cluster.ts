@@ -19,8 +19,10 @@ import { knownProfiles } from './configProfile'
 import { ConnSpec } from './connspec'
 import { DiagnoticsExecutor, PingExecutor } from './diagnosticsexecutor'
 import {
+  ConnectionStats,
   DiagnosticsOptions,
   DiagnosticsResult,
+  NodeStats,
   PingOptions,
   PingResult,
   WaitUntilReadyOptions,
@@ -988,6 +990,32 @@ export class Cluster {
     return PromiseHelper.wrapAsync(() => exec.ping(options_), callback)
   }
 
+  /**
+   * Returns the number of operations currently executing on this cluster's
+   * connection, and how long completed operations have waited for the event
+   * loop since the stats were last retrieved.  A growing completion delay
+   * indicates that the event loop, rather than the cluster, is the
+   * bottleneck.
+   *
+   * Retrieving the stats starts a new interval for the completion delay and
+   * the maximum number of pending completions.
+   */
+  connectionStats(): ConnectionStats {
+    return ConnectionStats._fromCppData(this._conn.stats())
+  }
+
+  /**
+   * Returns the throughput, error count and latency of the operations
+   * completed since the stats were last retrieved, broken down by the node
+   * they were last dispatched to.  This allows a single degraded node to be
+   * spotted before its operations start timing out.
+   *
+   * Retrieving the stats starts a new interval.
+   */
+  nodeStats(): NodeStats {
+    return NodeStats._fromCppData(this._conn.nodeStats())
+  }
+
   /**
    * Waits until the cluster reaches the desired state or the timeout elapses.
    * The default desired state is ClusterState.Online.
@@ -1123,6 +1151,11 @@ export class Cluster {
     if (!this._tracer) {
       this._tracer = new NoOpTracer()
     }
+    // threshold logging of operations dispatched by the connection happens
+    // natively, so it does not need any spans to be created in JS
+    if (this._tracer instanceof ThresholdLoggingTracer) {
+      this._tracer.attachConnection(this._conn)
+    }
 
     const metricsExplicitlyDisabled =
       (this._metricsConfig ?? false) && !this._metricsConfig?.enableMetrics
@@ -1141,6 +1174,11 @@ export class Cluster {
     if (!this._meter) {
       this._meter = new NoOpMeter()
     }
+    // likewise, the durations of operations dispatched by the connection are
+    // recorded natively, without a call into the meter for each of them
+    if (this._meter instanceof LoggingMeter) {
+      this._meter.attachConnection(this._conn)
+    }
 
     this._observabilityInstruments = new ObservabilityInstruments(
       this._tracer,
@@ -11,9 +11,11 @@ import binding, {
   zeroCas,
   CppImplSubdocCommand,
   CppScanIterator,
+  CppScanIteratorOptions,
   CppRangeScanOrchestratorOptions,
 } from './binding'
 import {
+  decompressValuesToCpp,
   durabilityToCpp,
   errorFromCpp,
   mutationStateToCpp,
@@ -35,6 +37,7 @@ import {
   MutateInResult,
   MutateInResultEntry,
   MutationResult,
+  ScanIdBatch,
   ScanResult,
 } from './crudoptypes'
 import {
@@ -46,11 +49,14 @@ import {
 import { InvalidArgumentError } from './errors'
 import { DurabilityLevel, ReadPreference, StoreSemantics } from './generaltypes'
 import { MutationState } from './mutationstate'
-import { wrapObservableBindingCall } from './observability'
+import {
+  wrapObservableBindingCall,
+  wrapObservableStreamingBindingCall,
+} from './observability'
 import { isNoopObservabilityInstruments, ObservableRequestHandler } from './observabilityhandler'
 import { KeyValueOp, ObservabilityInstruments } from './observabilitytypes'
 import { CollectionQueryIndexManager } from './queryindexmanager'
-import { RangeScan, SamplingScan, PrefixScan } from './rangeScan'
+import { RangeScan, SamplingScan, PrefixScan, ScanTerm } from './rangeScan'
 import { Scope } from './scope'
 import { LookupInMacro, LookupInSpec, MutateInSpec } from './sdspecs'
 import { SdUtils } from './sdutils'
@@ -59,7 +65,7 @@ import {
   StreamableScanPromise,
 } from './streamablepromises'
 import { RequestSpan } from './tracing'
-import { Transcoder } from './transcoders'
+import { DefaultTranscoder, Transcoder } from './transcoders'
 import { parseExpiry, NodeCallback, PromiseHelper, CasInput } from './utilities'
 
 /**
@@ -84,6 +90,16 @@ export interface GetOptions {
    */
   transcoder?: Transcoder
 
+  /**
+   * Defers decoding the document until {@link GetResult.content} is first
+   * accessed, and makes the stored bytes and flags available as
+   * {@link GetResult.rawContent} and {@link GetResult.flags}.  Callers which
+   * only need the CAS, or which pass the document on as it is, then never
+   * pay for decoding it.  Has no effect when used with project or
+   * withExpiry.
+   */
+  lazyDecode?: boolean
+
   /**
    * The timeout for this operation, represented in milliseconds.
    */
@@ -614,6 +630,191 @@ export interface ScanOptions {
    * Specifies the number of vBuckets which the client should scan in parallel.
    */
   concurrency?: number
+
+  /**
+   * The maximum number of bytes of scanned data which may be buffered by the
+   * SDK before it has been delivered.  The number of vBuckets scanned in
+   * parallel and the size of each partition batch are reduced so that data
+   * prefetched from the server stays within this budget.
+   *
+   * @see {@link StreamableScanPromise.pauseStreaming}
+   */
+  bufferByteLimit?: number
+
+  /**
+   * Specifies that the scan should keep track of the last document id it
+   * delivered from each vBucket.
+   *
+   * @see {@link StreamableScanPromise.checkpoint}
+   */
+  trackProgress?: boolean
+
+  /**
+   * A checkpoint previously returned by {@link StreamableScanPromise.checkpoint}.
+   * Documents which were already delivered before the checkpoint was taken are
+   * skipped, and progress continues to be tracked.  Only supported for range
+   * and prefix scans.
+   *
+   * Skipping happens in the client.  Unless every vbucket had delivered a
+   * document before the checkpoint was taken, the server scans the range
+   * again from its start, so resuming costs as much server work and network
+   * traffic as a full rescan.
+   */
+  resumeFrom?: Buffer
+}
+
+/**
+ * The most ids a single {@link ScanIdBatch} may hold.
+ *
+ * @internal
+ */
+const MAX_SCAN_ID_BATCH_SIZE = 65536
+
+/**
+ * How many times more ids than it samples {@link Collection.scanShards} may
+ * scan within a range before it stops and chooses the shard boundaries.
+ *
+ * @internal
+ */
+const SHARD_SAMPLE_SCAN_FACTOR = 16
+
+/**
+ * Returns the exclusive upper bound of the ids which start with prefix, or
+ * undefined when the prefix is empty.  This selects exactly the same ids as
+ * the bound of a core PrefixScan, which is the prefix followed by a 0xff byte,
+ * but unlike that bound it can be held in a string: ids are valid UTF-8,
+ * which sorts as code points do, so incrementing the last code point of the
+ * prefix gives the smallest string which sorts after every id it prefixes.
+ *
+ * @internal
+ */
+function prefixUpperBound(prefix: string): ScanTerm | undefined {
+  const codePoints = Array.from(prefix)
+  while (codePoints.length > 0) {
+    const last = (codePoints.pop() as string).codePointAt(0) as number
+    if (last < 0x10ffff) {
+      // Surrogates cannot appear in UTF-8, so skip over their range.
+      const next = last + 1 === 0xd800 ? 0xe000 : last + 1
+      return new ScanTerm(codePoints.join('') + String.fromCodePoint(next), true)
+    }
+  }
+  return undefined
+}
+
+/**
+ * Returns a uniform random number generator in [0, 1), which is repeatable
+ * when a seed is given.
+ *
+ * @internal
+ */
+function seededRandom(seed?: number): () => number {
+  if (seed === undefined) {
+    return Math.random
+  }
+
+  // mulberry32
+  let state = seed >>> 0
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0
+    let t = state
+    t = Math.imul(t ^ (t >>> 15), t | 1)
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61)
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296
+  }
+}
+
+/**
+ * @category Key-Value
+ */
+export interface ScanIdsOptions {
+  /**
+   * The timeout for this operation, represented in milliseconds.
+   */
+  timeout?: number
+
+  /**
+   * The limit applied to the number of bytes returned from the server
+   * for each partition batch.
+   */
+  batchByteLimit?: number
+
+  /**
+   * The limit applied to the number of items returned from the server
+   * for each partition batch.
+   */
+  batchItemLimit?: number
+
+  /**
+   * Specifies a MutationState which the scan should be consistent with.
+   *
+   * @see {@link MutationState}
+   */
+  consistentWith?: MutationState
+
+  /**
+   * Specifies the number of vBuckets which the client should scan in parallel.
+   */
+  concurrency?: number
+
+  /**
+   * The maximum number of ids to deliver in each {@link ScanIdBatch}, at most
+   * 65536.
+   */
+  idBatchSize?: number
+
+  /**
+   * The maximum number of bytes of scanned data which may be buffered by the
+   * SDK before it has been delivered.  The number of vBuckets scanned in
+   * parallel and the size of each partition batch are reduced so that data
+   * prefetched from the server stays within this budget.
+   *
+   * @see {@link StreamableScanPromise.pauseStreaming}
+   */
+  bufferByteLimit?: number
+
+  /**
+   * Specifies that the scan should keep track of the last document id it
+   * delivered from each vBucket.
+   *
+   * @see {@link StreamableScanPromise.checkpoint}
+   */
+  trackProgress?: boolean
+
+  /**
+   * A checkpoint previously returned by {@link StreamableScanPromise.checkpoint}.
+   * Documents which were already delivered before the checkpoint was taken are
+   * skipped, and progress continues to be tracked.  Only supported for range
+   * and prefix scans.
+   *
+   * Skipping happens in the client.  Unless every vbucket had delivered a
+   * document before the checkpoint was taken, the server scans the range
+   * again from its start, so resuming costs as much server work and network
+   * traffic as a full rescan.
+   */
+  resumeFrom?: Buffer
+}
+
+/**
+ * @category Key-Value
+ */
+export interface ScanShardsOptions {
+  /**
+   * The number of document ids to sample for each requested shard when
+   * choosing the shard boundaries.  Defaults to 64.
+   */
+  samplesPerShard?: number
+
+  /**
+   * The seed used to sample the ids which shard boundaries are chosen from,
+   * which makes the boundaries repeatable for the same data.
+   */
+  seed?: number
+
+  /**
+   * The timeout for the scan of the ids used to choose the shard
+   * boundaries, represented in milliseconds.
+   */
+  timeout?: number
 }
 
 /**
@@ -636,6 +837,7 @@ export class Collection {
   private _kvScanTimeout: number
   private _scanBatchItemLimit: number
   private _scanBatchByteLimit: number
+  private _scanIdBatchSize: number
 
   /**
   @internal
@@ -647,6 +849,7 @@ export class Collection {
     this._kvScanTimeout = 75000
     this._scanBatchByteLimit = 15000
     this._scanBatchItemLimit = 50
+    this._scanIdBatchSize = 1000
   }
 
   /**
@@ -754,6 +957,15 @@ export class Collection {
    * @internal
    */
   _subdocDecode(bytes: Buffer): any {
+    // Sub-document values are decoded natively when the collection's
+    // transcoder does the same for whole documents.
+    const transcoder = this.transcoder
+    if (transcoder instanceof DefaultTranscoder && transcoder.nativeJson) {
+      const decoded = binding.jsonDecode(bytes)
+      if (decoded !== undefined) {
+        return decoded
+      }
+    }
     try {
       return JSON.parse(bytes.toString('utf8'))
     } catch (_e) {
@@ -807,6 +1019,7 @@ export class Collection {
       }
 
       const transcoder = options.transcoder || this.transcoder
+      const lazyDecode = options.lazyDecode
       const timeout = options.timeout || this.cluster.kvTimeout
 
       return PromiseHelper.wrapAsync(async () => {
@@ -817,6 +1030,7 @@ export class Collection {
             timeout,
             partition: 0,
             opaque: 0,
+            decompress_values: decompressValuesToCpp(transcoder),
           },
           obsReqHandler
         )
@@ -826,6 +1040,16 @@ export class Collection {
           throw err
         }
 
+        if (lazyDecode) {
+          obsReqHandler?.end()
+          return new GetResult({
+            cas: resp.cas,
+            rawContent: resp.value,
+            flags: resp.flags,
+            transcoder: transcoder,
+          })
+        }
+
         const content = transcoder.decode(resp.value, resp.flags)
         obsReqHandler?.end()
         return new GetResult({
@@ -1026,16 +1250,44 @@ export class Collection {
 
     if (opType == KeyValueOp.GetAllReplicas) {
       PromiseHelper.wrapAsync(async () => {
-        const [err, resp] = await wrapObservableBindingCall(
-          this._conn.getAllReplicas.bind(this._conn),
+        // Each replica is emitted as soon as its node responds, rather than
+        // once all of them have.
+        let failed = false
+        const err = await wrapObservableStreamingBindingCall(
+          this._conn.getAllReplicasStream.bind(this._conn),
           {
             id: cppDocId,
             timeout: timeout,
             read_preference: readPreferenceToCpp(options.readPreference),
+            decompress_values: decompressValuesToCpp(transcoder),
           },
-          obsReqHandler
+          obsReqHandler,
+          (replica) => {
+            if (failed) {
+              return
+            }
+            try {
+              const content = transcoder.decode(replica.value, replica.flags)
+              emitter.emit(
+                'replica',
+                new GetReplicaResult({
+                  content: content,
+                  cas: replica.cas,
+                  isReplica: replica.replica,
+                })
+              )
+            } catch (err) {
+              failed = true
+              obsReqHandler?.endWithError(err)
+              emitter.emit('error', err)
+              emitter.emit('end')
+            }
+          }
         )
 
+        if (failed) {
+          return
+        }
         if (err) {
           obsReqHandler?.endWithError(err)
           emitter.emit('error', err)
@@ -1043,24 +1295,6 @@ export class Collection {
           return
         }
 
-        resp.entries.forEach((replica) => {
-          try {
-            const content = transcoder.decode(replica.value, replica.flags)
-            emitter.emit(
-              'replica',
-              new GetReplicaResult({
-                content: content,
-                cas: replica.cas,
-                isReplica: replica.replica,
-              })
-            )
-          } catch (err) {
-            obsReqHandler?.endWithError(err)
-            emitter.emit('error', err)
-            emitter.emit('end')
-            return
-          }
-        })
         obsReqHandler?.end()
         emitter.emit('end')
       })
@@ -1072,6 +1306,7 @@ export class Collection {
             id: cppDocId,
             timeout: timeout,
             read_preference: readPreferenceToCpp(options.readPreference),
+            decompress_values: decompressValuesToCpp(transcoder),
           },
           obsReqHandler
         )
@@ -1145,6 +1380,8 @@ export class Collection {
   /**
    * Retrieves the value of the document from all available replicas.  Note that
    * as replication is asynchronous, each node may return a different value.
+   * When listening for `replica` events, each one is emitted as soon as its node
+   * responds.
    *
    * @param key The document key to retrieve.
    * @param options Optional parameters for this operation.
@@ -1605,6 +1842,7 @@ export class Collection {
             timeout,
             partition: 0,
             opaque: 0,
+            decompress_values: decompressValuesToCpp(transcoder),
           },
           obsReqHandler
         )
@@ -1742,6 +1980,7 @@ export class Collection {
             timeout,
             partition: 0,
             opaque: 0,
+            decompress_values: decompressValuesToCpp(transcoder),
           },
           obsReqHandler
         )
@@ -1884,7 +2123,9 @@ export class Collection {
         iterator.cancel()
       }
 
-      this._continueScan(iterator, transcoder, emitter)
+      emitter._whenFlowing(() =>
+        this._continueScan(iterator, transcoder, emitter)
+      )
       return
     })
   }
@@ -1892,40 +2133,172 @@ export class Collection {
   /**
    * @internal
    */
-  _doScan(
+  _continueScanIds<TRes>(
+    iterator: CppScanIterator,
+    batchSize: number,
+    emitter: StreamableScanPromise<TRes[], TRes>,
+    emitBatch: (batch: ScanIdBatch, done: () => void) => void
+  ): void {
+    iterator.nextKeys(batchSize, (cppErr, resp) => {
+      const err = errorFromCpp(cppErr)
+      if (err) {
+        emitter.emit('error', err)
+        emitter.emit('end')
+        return
+      }
+
+      if (typeof resp === 'undefined') {
+        emitter.emit('end')
+        return
+      }
+
+      emitBatch(
+        new ScanIdBatch({
+          buffer: resp.keys,
+          lengths: resp.lengths,
+        }),
+        () => {
+          if (emitter.cancelRequested && !iterator.cancelled) {
+            iterator.cancel()
+          }
+
+          emitter._whenFlowing(() =>
+            this._continueScanIds(iterator, batchSize, emitter, emitBatch)
+          )
+        }
+      )
+    })
+  }
+
+  /**
+   * @internal
+   */
+  _doScan<TRes>(
     scanType: RangeScan | SamplingScan | PrefixScan,
     options: CppRangeScanOrchestratorOptions,
-    transcoder: Transcoder,
-    callback?: NodeCallback<ScanResult[]>
-  ): StreamableScanPromise<ScanResult[], ScanResult> {
+    iteratorOptions: CppScanIteratorOptions,
+    continueFn: (
+      iterator: CppScanIterator,
+      emitter: StreamableScanPromise<TRes[], TRes>
+    ) => void,
+    callback?: NodeCallback<TRes[]>
+  ): StreamableScanPromise<TRes[], TRes> {
     const bucketName = this._scope.bucket.name
     const scopeName = this._scope.name
     const collectionName = this._name
 
     return PromiseHelper.wrapAsync(() => {
-      const { cppErr, result } = this._conn.scan(
+      const emitter = new StreamableScanPromise<TRes[], TRes>(
+        (results: TRes[]) => results
+      )
+
+      this._conn.scan(
         bucketName,
         scopeName,
         collectionName,
         scanType.getScanType(),
         scanTypeToCpp(scanType),
-        options
+        options,
+        iteratorOptions,
+        (cppErr, iterator) => {
+          const err = errorFromCpp(cppErr)
+          if (err) {
+            emitter.emit('error', err)
+            emitter.emit('end')
+            return
+          }
+
+          const scanIterator = iterator as CppScanIterator
+          emitter._setCheckpointFn(() => scanIterator.checkpoint())
+          emitter._whenFlowing(() => continueFn(scanIterator, emitter))
+        }
       )
 
-      const err = errorFromCpp(cppErr)
-      if (err) {
-        throw err
+      return emitter
+    }, callback)
+  }
+
+  /**
+   * @internal
+   */
+  _scanOrchestratorOptions(
+    scanType: RangeScan | SamplingScan | PrefixScan,
+    options: ScanOptions,
+    idsOnly: boolean
+  ): CppRangeScanOrchestratorOptions {
+    const timeout = options.timeout || this._kvScanTimeout
+    let batchByteLimit =
+      typeof options.batchByteLimit !== 'undefined'
+        ? options.batchByteLimit
+        : this._scanBatchByteLimit
+    const batchItemLimit =
+      typeof options.batchItemLimit !== 'undefined'
+        ? options.batchItemLimit
+        : this._scanBatchItemLimit
+
+    if (typeof options.concurrency !== 'undefined' && options.concurrency < 1) {
+      throw new InvalidArgumentError(
+        new Error('Concurrency option must be positive')
+      )
+    }
+    let concurrency = options.concurrency || 1
+
+    // Each vBucket stream holds up to one partition batch which has not yet
+    // been consumed, so the buffer budget is enforced by bounding the product
+    // of the two.
+    const bufferByteLimit = options.bufferByteLimit
+    if (typeof bufferByteLimit !== 'undefined') {
+      if (bufferByteLimit < 1) {
+        throw new InvalidArgumentError(
+          new Error('Buffer byte limit must be positive')
+        )
       }
+      if (batchByteLimit === 0 || batchByteLimit > bufferByteLimit) {
+        batchByteLimit = bufferByteLimit
+      }
+      concurrency = Math.max(
+        1,
+        Math.min(concurrency, Math.floor(bufferByteLimit / batchByteLimit))
+      )
+    }
 
-      const emitter = new StreamableScanPromise<ScanResult[], ScanResult>(
-        (results: ScanResult[]) => results
+    if (scanType instanceof SamplingScan && scanType.limit < 1) {
+      throw new InvalidArgumentError(
+        new Error('Sampling scan limit must be positive')
       )
+    }
 
-      this._continueScan(result, transcoder, emitter)
+    if (scanType instanceof SamplingScan && options.resumeFrom) {
+      throw new InvalidArgumentError(
+        new Error('Sampling scans cannot be resumed from a checkpoint')
+      )
+    }
 
-      return emitter
-    }, callback)
+    return {
+      ids_only: idsOnly,
+      consistent_with: mutationStateToCpp(options.consistentWith),
+      batch_item_limit: batchItemLimit,
+      batch_byte_limit: batchByteLimit,
+      concurrency: concurrency,
+      timeout: timeout,
+    }
   }
+
+  /**
+   * @internal
+   */
+  _scanIteratorOptions(
+    options: ScanOptions,
+    transcoder?: Transcoder
+  ): CppScanIteratorOptions {
+    return {
+      track_progress: options.trackProgress || false,
+      resume_from: options.resumeFrom,
+      buffer_byte_limit: options.bufferByteLimit,
+      decompress_values: transcoder ? decompressValuesToCpp(transcoder) : false,
+    }
+  }
+
   /**
    * Performs a key-value scan operation.
    *
@@ -1941,7 +2314,7 @@ export class Collection {
     scanType: RangeScan | SamplingScan | PrefixScan,
     options?: ScanOptions,
     callback?: NodeCallback<ScanResult[]>
-  ): Promise<ScanResult[]> {
+  ): StreamableScanPromise<ScanResult[], ScanResult> {
     if (options instanceof Function) {
       callback = arguments[2]
       options = undefined
@@ -1951,40 +2324,246 @@ export class Collection {
     }
 
     const transcoder = options.transcoder || this.transcoder
-    const timeout = options.timeout || this._kvScanTimeout
     const idsOnly = options.idsOnly || false
-    const batchByteLimit =
-      typeof options.batchByteLimit !== 'undefined'
-        ? options.batchByteLimit
-        : this._scanBatchByteLimit
-    const batchItemLimit =
-      typeof options.batchItemLimit !== 'undefined'
-        ? options.batchItemLimit
-        : this._scanBatchItemLimit
+    const orchestratorOptions = this._scanOrchestratorOptions(
+      scanType,
+      options,
+      idsOnly
+    )
+    const iteratorOptions = this._scanIteratorOptions(options, transcoder)
+
+    if (idsOnly) {
+      // Ids are pulled from the native layer in packed batches to avoid
+      // crossing into JS once per document.
+      return this._doScan<ScanResult>(
+        scanType,
+        orchestratorOptions,
+        iteratorOptions,
+        (iterator, emitter) => {
+          // Only the ids of a batch which were actually emitted count towards
+          // a checkpoint, as emission can stop part way through the batch.
+          let emitted = 0
+          emitter._setCheckpointFn(() => iterator.checkpoint(emitted))
+          this._continueScanIds(
+            iterator,
+            this._scanIdBatchSize,
+            emitter,
+            (batch, done) => {
+              // Pausing and cancelling take effect between ids, not only
+              // between batches.
+              const ids = batch.ids()
+              emitted = 0
+              const emitFrom = (index: number) => {
+                for (let i = index; i < ids.length; ++i) {
+                  if (emitter.cancelRequested) {
+                    break
+                  }
+                  if (emitter.paused) {
+                    emitter._whenFlowing(() => emitFrom(i))
+                    return
+                  }
+                  emitted = i + 1
+                  emitter.emit('result', new ScanResult({ id: ids[i] }))
+                }
+                done()
+              }
+              emitFrom(0)
+            }
+          )
+        },
+        callback
+      )
+    }
 
-    if (typeof options.concurrency !== 'undefined' && options.concurrency < 1) {
+    return this._doScan<ScanResult>(
+      scanType,
+      orchestratorOptions,
+      iteratorOptions,
+      (iterator, emitter) => this._continueScan(iterator, transcoder, emitter),
+      callback
+    )
+  }
+
+  /**
+   * Performs a key-value scan operation which only returns document ids.
+   *
+   * Rather than producing a result object per document, ids are delivered in
+   * {@link ScanIdBatch} objects which hold the ids of the batch in a single
+   * packed buffer.  This substantially reduces memory and GC pressure when
+   * enumerating very large numbers of documents.
+   *
+   * @param scanType The type of scan to execute.
+   * @param options Optional parameters for the scan operation.
+   * @param callback A node-style callback to be invoked after execution.
+   */
+  scanIds(
+    scanType: RangeScan | SamplingScan | PrefixScan,
+    options?: ScanIdsOptions,
+    callback?: NodeCallback<ScanIdBatch[]>
+  ): StreamableScanPromise<ScanIdBatch[], ScanIdBatch> {
+    if (options instanceof Function) {
+      callback = arguments[2]
+      options = undefined
+    }
+    if (!options) {
+      options = {}
+    }
+
+    const idBatchSize =
+      typeof options.idBatchSize !== 'undefined'
+        ? options.idBatchSize
+        : this._scanIdBatchSize
+    if (idBatchSize < 1 || idBatchSize > MAX_SCAN_ID_BATCH_SIZE) {
       throw new InvalidArgumentError(
-        new Error('Concurrency option must be positive')
+        new Error(
+          `Id batch size option must be between 1 and ${MAX_SCAN_ID_BATCH_SIZE}`
+        )
       )
     }
-    const concurrency = options.concurrency || 1
+    const orchestratorOptions = this._scanOrchestratorOptions(
+      scanType,
+      options,
+      true
+    )
+
+    return this._doScan<ScanIdBatch>(
+      scanType,
+      orchestratorOptions,
+      this._scanIteratorOptions(options),
+      (iterator, emitter) =>
+        this._continueScanIds(iterator, idBatchSize, emitter, (batch, done) => {
+          emitter.emit('result', batch)
+          done()
+        }),
+      callback
+    )
+  }
 
-    if (scanType instanceof SamplingScan && scanType.limit < 1) {
+  /**
+   * Splits a range or prefix scan into a number of disjoint range scans which
+   * together cover exactly the same documents as the original scan.  Each shard
+   * can be executed independently, for instance by a separate worker thread
+   * with its own cluster connection, so that decoding and processing of a
+   * large scan can be spread across multiple cores.
+   *
+   * Shard boundaries are chosen from a random sample of the document ids
+   * within the range, so that each shard holds roughly the same number of
+   * documents.  The sample is bounded: for a scan of the whole collection the
+   * ids are sampled by the server, and otherwise at most a fixed multiple of
+   * `shardCount * samplesPerShard` ids (but not bodies) of the range are
+   * scanned.  Fewer shards than requested may be returned
+   * when the range does not contain enough distinct ids.  Shards can be sent to a
+   * worker thread as plain data and recreated with {@link RangeScan.fromJSON}.
+   *
+   * @param scanType The scan to split.
+   * @param shardCount The number of shards to split the scan into.
+   * @param options Optional parameters for the operation.
+   * @param callback A node-style callback to be invoked after execution.
+   */
+  scanShards(
+    scanType: RangeScan | PrefixScan,
+    shardCount: number,
+    options?: ScanShardsOptions,
+    callback?: NodeCallback<RangeScan[]>
+  ): Promise<RangeScan[]> {
+    if (options instanceof Function) {
+      callback = arguments[2]
+      options = undefined
+    }
+    if (!options) {
+      options = {}
+    }
+
+    if (!Number.isInteger(shardCount) || shardCount < 1) {
       throw new InvalidArgumentError(
-        new Error('Sampling scan limit must be positive')
+        new Error('The shard count must be a positive integer.')
       )
     }
 
-    const orchestratorOptions = {
-      ids_only: idsOnly,
-      consistent_with: mutationStateToCpp(options.consistentWith),
-      batch_item_limit: batchItemLimit,
-      batch_byte_limit: batchByteLimit,
-      concurrency: concurrency,
-      timeout: timeout,
+    let lower: ScanTerm | undefined
+    let upper: ScanTerm | undefined
+    if (scanType instanceof RangeScan) {
+      lower = scanType.start
+      upper = scanType.end
+    } else {
+      lower = new ScanTerm(scanType.prefix)
+      upper = prefixUpperBound(scanType.prefix)
     }
 
-    return this._doScan(scanType, orchestratorOptions, transcoder, callback)
+    const samplesPerShard = options.samplesPerShard || 64
+    const seed = options.seed
+    const timeout = options.timeout
+
+    return PromiseHelper.wrapAsync(async () => {
+      if (shardCount === 1) {
+        return [new RangeScan(lower, upper)]
+      }
+
+      // The ids of the requested range are reservoir sampled, so that the
+      // boundaries follow the distribution of ids within the range rather
+      // than within the whole collection.  Only ids are scanned.  Ids are
+      // compared as UTF-8 bytes, which is the order the server uses for
+      // range scans, rather than as JS strings.
+      //
+      // When the whole collection is being split, the server samples the ids
+      // itself.  Otherwise the range is scanned one vbucket at a time, and
+      // as each vbucket holds a hash-partitioned subset of the range, the
+      // scan can stop early once enough ids have been seen.
+      const lowerBytes = lower ? Buffer.from(lower.term) : undefined
+      const numSamples = shardCount * samplesPerShard
+      const maxSeen = numSamples * SHARD_SAMPLE_SCAN_FACTOR
+      const source =
+        !lower && !upper
+          ? new SamplingScan(numSamples, seed)
+          : new RangeScan(lower, upper)
+      const random = seededRandom(seed)
+      const samples: Buffer[] = []
+      let numSeen = 0
+      await new Promise<void>((resolve, reject) => {
+        const scan = this.scanIds(source, { timeout, concurrency: 1 })
+        scan
+          .on('result', (batch: ScanIdBatch) => {
+            for (const id of batch) {
+              if (numSeen >= maxSeen) {
+                scan.cancelStreaming()
+                break
+              }
+              ++numSeen
+              if (samples.length < numSamples) {
+                samples.push(Buffer.from(id))
+              } else {
+                const slot = Math.floor(random() * numSeen)
+                if (slot < numSamples) {
+                  samples[slot] = Buffer.from(id)
+                }
+              }
+            }
+          })
+          .on('end', () => resolve())
+          .on('error', reject)
+      })
+      samples.sort(Buffer.compare)
+
+      const boundaries: Buffer[] = []
+      for (let i = 1; i < shardCount && samples.length > 0; ++i) {
+        const boundary = samples[Math.floor((i * samples.length) / shardCount)]
+        const prev =
+          boundaries.length > 0 ? boundaries[boundaries.length - 1] : lowerBytes
+        if (!prev || Buffer.compare(boundary, prev) > 0) {
+          boundaries.push(boundary)
+        }
+      }
+
+      const shards: RangeScan[] = []
+      let start = lower
+      for (const boundary of boundaries) {
+        const term = boundary.toString('utf8')
+        shards.push(new RangeScan(start, new ScanTerm(term, true)))
+        start = new ScanTerm(term)
+      }
+      shards.push(new RangeScan(start, upper))
+      return shards
+    }, callback)
   }
 
   /**
@@ -2133,8 +2712,11 @@ export class Collection {
 
     if (opType == KeyValueOp.LookupInAllReplicas) {
       PromiseHelper.wrapAsync(async () => {
-        const [err, resp] = await wrapObservableBindingCall(
-          this._conn.lookupInAllReplicas.bind(this._conn),
+        // Each replica is emitted as soon as its node responds, rather than
+        // once all of them have.
+        let failed = false
+        const err = await wrapObservableStreamingBindingCall(
+          this._conn.lookupInAllReplicasStream.bind(this._conn),
           {
             id: cppDocId,
             specs: cppSpecs,
@@ -2142,9 +2724,55 @@ export class Collection {
             read_preference: readPreferenceToCpp(options.readPreference),
             access_deleted: false, // only used in core transactions; false otherwise
           },
-          obsReqHandler
+          obsReqHandler,
+          (replica) => {
+            if (failed) {
+              return
+            }
+            try {
+              const content: LookupInResultEntry[] = []
+
+              for (let i = 0; i < replica.fields.length; ++i) {
+                const itemRes = replica.fields[i]
+
+                const error = errorFromCpp(itemRes.ec)
+
+                let value: any = undefined
+                if (itemRes.value && itemRes.value.length > 0) {
+                  value = this._subdocDecode(itemRes.value)
+                }
+
+                if (itemRes.opcode === binding.protocol_subdoc_opcode.exists) {
+                  value = itemRes.exists
+                }
+
+                content.push(
+                  new LookupInResultEntry({
+                    error,
+                    value,
+                  })
+                )
+              }
+              emitter.emit(
+                'replica',
+                new LookupInReplicaResult({
+                  content: content,
+                  cas: replica.cas,
+                  isReplica: replica.is_replica,
+                })
+              )
+            } catch (err) {
+              failed = true
+              obsReqHandler?.endWithError(err)
+              emitter.emit('error', err)
+              emitter.emit('end')
+            }
+          }
         )
 
+        if (failed) {
+          return
+        }
         if (err) {
           obsReqHandler?.endWithError(err)
           emitter.emit('error', err)
@@ -2152,39 +2780,6 @@ export class Collection {
           return
         }
 
-        resp.entries.forEach((replica) => {
-          const content: LookupInResultEntry[] = []
-
-          for (let i = 0; i < replica.fields.length; ++i) {
-            const itemRes = replica.fields[i]
-
-            const error = errorFromCpp(itemRes.ec)
-
-            let value: any = undefined
-            if (itemRes.value && itemRes.value.length > 0) {
-              value = this._subdocDecode(itemRes.value)
-            }
-
-            if (itemRes.opcode === binding.protocol_subdoc_opcode.exists) {
-              value = itemRes.exists
-            }
-
-            content.push(
-              new LookupInResultEntry({
-                error,
-                value,
-              })
-            )
-          }
-          emitter.emit(
-            'replica',
-            new LookupInReplicaResult({
-              content: content,
-              cas: replica.cas,
-              isReplica: replica.is_replica,
-            })
-          )
-        })
         obsReqHandler?.end()
         emitter.emit('end')
       })
@@ -2298,6 +2893,8 @@ export class Collection {
    * Performs a lookup-in operation against a document, fetching individual fields or
    * information about specific fields inside the document value from all available replicas.
    * Note that as replication is asynchronous, each node may return a different value.
+   * When listening for `replica` events, each one is emitted as soon as its node
+   * responds.
    *
    * @param key The document key to look in.
    * @param specs A list of specs describing the data to fetch from the document.
@@ -1,4 +1,5 @@
 import { MutationToken } from './mutationstate'
+import { Transcoder } from './transcoders'
 import { Cas } from './utilities'
 
 /**
@@ -9,6 +10,10 @@ import { Cas } from './utilities'
 export class GetResult {
   /**
    * The content of the document.
+   *
+   * For results fetched with {@link GetOptions.lazyDecode}, the document is
+   * only decoded when this is first accessed, in which case any error from
+   * the transcoder is thrown from here.
    */
   content: any
 
@@ -24,13 +29,64 @@ export class GetResult {
    */
   expiryTime?: number
 
+  /**
+   * The bytes of the document, as they are stored, without decoding.  Only
+   * available for results fetched with {@link GetOptions.lazyDecode}.
+   */
+  rawContent?: Buffer
+
+  /**
+   * The flags stored with the document, which describe the format of
+   * {@link GetResult.rawContent}.  Only available for results fetched with
+   * {@link GetOptions.lazyDecode}.
+   */
+  flags?: number
+
   /**
    * @internal
    */
-  constructor(data: { content: any; cas: Cas; expiryTime?: number }) {
-    this.content = data.content
+  constructor(data: {
+    content?: any
+    cas: Cas
+    expiryTime?: number
+    rawContent?: Buffer
+    flags?: number
+    transcoder?: Transcoder
+  }) {
     this.cas = data.cas
     this.expiryTime = data.expiryTime
+
+    const transcoder = data.transcoder
+    if (!transcoder) {
+      this.content = data.content
+      return
+    }
+
+    this.rawContent = data.rawContent
+    this.flags = data.flags
+
+    // The content is decoded on first access, and then replaces the accessor
+    // with a plain property holding the decoded value.
+    const define = (value: any) =>
+      Object.defineProperty(this, 'content', {
+        value,
+        writable: true,
+        enumerable: true,
+        configurable: true,
+      })
+    Object.defineProperty(this, 'content', {
+      get: () => {
+        const content = transcoder.decode(
+          this.rawContent as Buffer,
+          this.flags as number
+        )
+        define(content)
+        return content
+      },
+      set: define,
+      enumerable: true,
+      configurable: true,
+    })
   }
 
   /**
@@ -99,6 +155,59 @@ export class ScanResult {
   }
 }
 
+/**
+ * Contains a batch of document ids returned from an id-only scan.  The ids
+ * are held as a single packed UTF-8 buffer and are only decoded into strings
+ * when they are accessed.
+ *
+ * @category Key-Value
+ */
+export class ScanIdBatch {
+  /**
+   * The UTF-8 bytes of every id in the batch, stored back-to-back.
+   */
+  buffer: Buffer
+
+  /**
+   * The byte length of each id within {@link ScanIdBatch.buffer}.
+   */
+  lengths: Uint32Array
+
+  /**
+   * @internal
+   */
+  constructor(data: { buffer: Buffer; lengths: Uint32Array }) {
+    this.buffer = data.buffer
+    this.lengths = data.lengths
+  }
+
+  /**
+   * The number of ids contained in this batch.
+   */
+  get length(): number {
+    return this.lengths.length
+  }
+
+  /**
+   * Decodes every id in this batch into a string.
+   */
+  ids(): string[] {
+    return Array.from(this)
+  }
+
+  /**
+   * Iterates the ids in this batch, decoding each one as it is visited.
+   */
+  *[Symbol.iterator](): IterableIterator<string> {
+    let offset = 0
+    for (let i = 0; i < this.lengths.length; ++i) {
+      const end = offset + this.lengths[i]
+      yield this.buffer.toString('utf8', offset, end)
+      offset = end
+    }
+  }
+}
+
 /**
  * Contains the results of an exists operation.
  *
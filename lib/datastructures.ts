@@ -1,5 +1,12 @@
 import { Collection } from './collection'
-import { CouchbaseError, PathExistsError, PathInvalidError } from './errors'
+import {
+  CasMismatchError,
+  CouchbaseError,
+  PathExistsError,
+  PathInvalidError,
+  PathMismatchError,
+  PathNotFoundError,
+} from './errors'
 import { StoreSemantics } from './generaltypes'
 import { ObservableRequestHandler, WrappedSpan } from './observabilityhandler'
 import { DatastructureOp } from './observabilitytypes'
@@ -7,6 +14,244 @@ import { LookupInSpec, MutateInSpec } from './sdspecs'
 import { RequestSpan } from './tracing'
 import { NodeCallback, PromiseHelper } from './utilities'
 
+/**
+ * The most specs a single lookup-in or mutate-in operation may contain.
+ */
+const MAX_SUBDOC_SPECS = 16
+
+/**
+ * The number of items fetched by each lookup when paging through a list or
+ * set.
+ */
+const ARRAY_PAGE_SIZE = MAX_SUBDOC_SPECS
+
+/**
+ * The most pages of a list or set which are requested ahead of the one being
+ * consumed.  Paging starts with a single request, so that short lists cost a
+ * single lookup, and doubles the number in flight with each full page.
+ */
+const ARRAY_PAGES_IN_FLIGHT = 8
+
+/**
+ * The number of times a search of a list or set is restarted when the
+ * document is modified while it is being searched, before searching the
+ * whole document instead.
+ */
+const ARRAY_SEARCH_RETRIES = 4
+
+/**
+ * Splits items into chunks which each fit into a single subdocument
+ * operation.
+ *
+ * @internal
+ */
+function subdocChunks<T>(items: T[]): T[][] {
+  const chunks: T[][] = []
+  for (let i = 0; i < items.length; i += MAX_SUBDOC_SPECS) {
+    chunks.push(items.slice(i, i + MAX_SUBDOC_SPECS))
+  }
+  return chunks
+}
+
+/**
+ * Fetches an entire array document.
+ *
+ * @internal
+ */
+async function getArray(
+  collection: Collection,
+  key: string,
+  parentSpan?: WrappedSpan
+): Promise<any[]> {
+  const doc = await collection.get(key, { parentSpan: parentSpan })
+  if (!(doc.content instanceof Array)) {
+    throw new CouchbaseError('expected document of array type')
+  }
+
+  return doc.content
+}
+
+/**
+ * @internal
+ */
+interface ArrayPage {
+  items: any[]
+  cas: string
+}
+
+/**
+ * Pages through the items of an array document with lookup-in operations of
+ * up to ARRAY_PAGE_SIZE items, so that iterating or searching a large list
+ * only holds a few pages of it at a time.  Several of the following pages are
+ * requested while the current one is being consumed.
+ *
+ * Pages must all come from the same revision of the document.  If it is
+ * modified while it is being paged through, the remaining items are taken
+ * from a fetch of the whole document instead, unless the pager was asked to
+ * throw a CasMismatchError so that its caller can start again.  That fetch
+ * is sliced at the number of items already returned, which only lines up
+ * with the earlier pages when the change was at or after that point.
+ *
+ * @internal
+ */
+class ArrayPager {
+  private _coll: Collection
+  private _key: string
+  private _parentSpan?: WrappedSpan
+  private _throwOnChange: boolean
+  private _offset: number
+  private _nextOffset: number
+  private _maxInFlight: number
+  private _cas: string | undefined
+  private _pending: Promise<ArrayPage>[]
+  private _done: boolean
+
+  constructor(
+    collection: Collection,
+    key: string,
+    parentSpan?: WrappedSpan,
+    throwOnChange?: boolean
+  ) {
+    this._coll = collection
+    this._key = key
+    this._parentSpan = parentSpan
+    this._throwOnChange = throwOnChange || false
+    this._offset = 0
+    this._nextOffset = 0
+    this._maxInFlight = 1
+    this._cas = undefined
+    this._pending = []
+    this._done = false
+  }
+
+  private async _fetch(offset: number): Promise<ArrayPage> {
+    const specs: LookupInSpec[] = []
+    for (let i = 0; i < ARRAY_PAGE_SIZE; ++i) {
+      specs.push(LookupInSpec.get('[' + (offset + i) + ']'))
+    }
+
+    const res = await this._coll.lookupIn(this._key, specs, {
+      parentSpan: this._parentSpan,
+    })
+
+    const items: any[] = []
+    for (let i = 0; i < res.content.length; ++i) {
+      const error = res.content[i].error
+      if (error instanceof PathNotFoundError) {
+        // Past the end of the list.
+        break
+      } else if (error instanceof PathMismatchError) {
+        throw new CouchbaseError('expected document of array type')
+      } else if (error) {
+        throw error
+      }
+      items.push(res.content[i].value)
+    }
+
+    return { items, cas: res.cas.toString() }
+  }
+
+  private _fill(): void {
+    while (this._pending.length < this._maxInFlight) {
+      const page = this._fetch(this._nextOffset)
+      // Failures are reported by the call which consumes the page, if any.
+      page.catch(() => undefined)
+      this._pending.push(page)
+      this._nextOffset += ARRAY_PAGE_SIZE
+    }
+  }
+
+  private async _fetchRemaining(): Promise<any[]> {
+    const items = await getArray(this._coll, this._key, this._parentSpan)
+    return items.slice(this._offset)
+  }
+
+  /**
+   * Returns the next page of items, or an empty page at the end of the list.
+   */
+  async next(): Promise<any[]> {
+    if (this._done) {
+      return []
+    }
+
+    try {
+      this._fill()
+      const page = await (this._pending.shift() as Promise<ArrayPage>)
+
+      if (this._cas === undefined) {
+        this._cas = page.cas
+      } else if (this._cas !== page.cas) {
+        this._done = true
+        this._pending = []
+        if (this._throwOnChange) {
+          throw new CasMismatchError()
+        }
+        return await this._fetchRemaining()
+      }
+
+      this._offset += page.items.length
+      if (page.items.length < ARRAY_PAGE_SIZE) {
+        this._done = true
+        this._pending = []
+      } else {
+        this._maxInFlight = Math.min(
+          this._maxInFlight * 2,
+          ARRAY_PAGES_IN_FLIGHT
+        )
+        this._fill()
+      }
+
+      return page.items
+    } catch (e) {
+      this._done = true
+      this._pending = []
+      throw e
+    }
+  }
+}
+
+/**
+ * Returns the index of the first item of an array document which is strictly
+ * equal to value, or -1, paging through the document and stopping at the
+ * first match.  The search starts again if the document is modified part way
+ * through, and searches a fetch of the whole document if that keeps
+ * happening.
+ *
+ * @internal
+ */
+async function arrayIndexOf(
+  collection: Collection,
+  key: string,
+  value: any,
+  parentSpan?: WrappedSpan
+): Promise<number> {
+  for (let attempt = 0; attempt < ARRAY_SEARCH_RETRIES; ++attempt) {
+    try {
+      const pager = new ArrayPager(collection, key, parentSpan, true)
+      let offset = 0
+      for (;;) {
+        const items = await pager.next()
+        if (items.length === 0) {
+          return -1
+        }
+
+        const index = items.indexOf(value)
+        if (index !== -1) {
+          return offset + index
+        }
+        offset += items.length
+      }
+    } catch (e) {
+      if (!(e instanceof CasMismatchError)) {
+        throw e
+      }
+    }
+  }
+
+  const items = await getArray(collection, key, parentSpan)
+  return items.indexOf(value)
+}
+
 /**
  * CouchbaseList provides a simplified interface for storing lists
  * within a Couchbase document.
@@ -27,12 +272,7 @@ export class CouchbaseList {
   }
 
   private async _get(parentSpan?: WrappedSpan): Promise<any[]> {
-    const doc = await this._coll.get(this._key, { parentSpan: parentSpan })
-    if (!(doc.content instanceof Array)) {
-      throw new CouchbaseError('expected document of array type')
-    }
-
-    return doc.content
+    return getArray(this._coll, this._key, parentSpan)
   }
 
   /**
@@ -62,6 +302,12 @@ export class CouchbaseList {
   /**
    * Iterates each item in the list.
    *
+   * Items are fetched a page at a time.  If the list is modified while it is
+   * being iterated, the remaining items are taken from its latest revision,
+   * starting at the index iteration had reached.  Items inserted or removed
+   * before that index, such as by an unshift or a remove, therefore cause
+   * later items to be visited twice or not at all.
+   *
    * @param rowCallback A callback invoked for each item in the list.
    * @param callback A node-style callback to be invoked after execution.
    */
@@ -70,30 +316,43 @@ export class CouchbaseList {
     callback?: NodeCallback<void>
   ): Promise<void> {
     return PromiseHelper.wrapAsync(async () => {
-      const values = await this._get()
-      for (let i = 0; i < values.length; ++i) {
-        rowCallback(values[i], i, this)
+      const pager = new ArrayPager(this._coll, this._key)
+      let index = 0
+      for (;;) {
+        const values = await pager.next()
+        if (values.length === 0) {
+          break
+        }
+
+        for (let i = 0; i < values.length; ++i) {
+          rowCallback(values[i], index++, this)
+        }
       }
     }, callback)
   }
 
   /**
    * Provides the ability to async-for loop this object.
+   *
+   * Items are fetched a page at a time.  If the list is modified while it is
+   * being iterated, the remaining items are taken from its latest revision,
+   * starting at the index iteration had reached.  Items inserted or removed
+   * before that index, such as by an unshift or a remove, therefore cause
+   * later items to be visited twice or not at all.
    */
   [Symbol.asyncIterator](): AsyncIterator<any> {
-    const getNext = async () => this._get()
+    const pager = new ArrayPager(this._coll, this._key)
     return {
-      data: null as null | any[],
-      index: -1,
+      data: [] as any[],
+      index: 0,
       async next() {
-        if (this.index < 0) {
-          this.data = await getNext()
+        if (this.index >= this.data.length) {
+          this.data = await pager.next()
           this.index = 0
         }
 
-        const data = this.data as any[]
-        if (this.index < data.length) {
-          return { done: false, value: data[this.index++] }
+        if (this.index < this.data.length) {
+          return { done: false, value: this.data[this.index++] }
         }
 
         return { done: true }
@@ -179,17 +438,14 @@ export class CouchbaseList {
 
     return PromiseHelper.wrapAsync(async () => {
       try {
-        const items = await this._get(obsReqHandler.wrappedSpan)
-
-        for (let i = 0; i < items.length; ++i) {
-          if (items[i] === value) {
-            obsReqHandler.end()
-            return i
-          }
-        }
-
+        const index = await arrayIndexOf(
+          this._coll,
+          this._key,
+          value,
+          obsReqHandler.wrappedSpan
+        )
         obsReqHandler.end()
-        return -1
+        return index
       } catch (e) {
         obsReqHandler.endWithError(e)
         throw e
@@ -256,6 +512,40 @@ export class CouchbaseList {
     }, callback)
   }
 
+  /**
+   * Adds several new items to the end of the list, in order, with a single
+   * operation.
+   *
+   * @param values The values to add.
+   * @param callback A node-style callback to be invoked after execution.
+   */
+  async pushMany(values: any[], callback?: NodeCallback<void>): Promise<void> {
+    const obsReqHandler = new ObservableRequestHandler(
+      DatastructureOp.ListPushMany,
+      this._coll.observabilityInstruments
+    )
+    obsReqHandler.setRequestKeyValueAttributes(this._coll._cppDocId(this._key))
+
+    return PromiseHelper.wrapAsync(async () => {
+      try {
+        if (values.length > 0) {
+          await this._coll.mutateIn(
+            this._key,
+            [MutateInSpec.arrayAppend('', values, { multi: true })],
+            {
+              storeSemantics: StoreSemantics.Upsert,
+              parentSpan: obsReqHandler.wrappedSpan,
+            }
+          )
+        }
+        obsReqHandler.end()
+      } catch (e) {
+        obsReqHandler.endWithError(e)
+        throw e
+      }
+    }, callback)
+  }
+
   /**
    * Adds a new item to the beginning of the list.
    *
@@ -426,6 +716,47 @@ export class CouchbaseMap {
     }, callback)
   }
 
+  /**
+   * Sets several keys in the map.  The keys are written in groups of up to
+   * 16 per operation, with all of the groups being sent at once.  Each group
+   * is applied atomically, but the groups are not applied atomically with
+   * respect to each other.
+   *
+   * @param items An object mapping the keys to set to their new values.
+   * @param callback A node-style callback to be invoked after execution.
+   */
+  async setMany(
+    items: { [key: string]: any },
+    callback?: NodeCallback<void>
+  ): Promise<void> {
+    const obsReqHandler = new ObservableRequestHandler(
+      DatastructureOp.MapSetMany,
+      this._coll.observabilityInstruments
+    )
+    obsReqHandler.setRequestKeyValueAttributes(this._coll._cppDocId(this._key))
+
+    return PromiseHelper.wrapAsync(async () => {
+      try {
+        await Promise.all(
+          subdocChunks(Object.keys(items)).map((keys) =>
+            this._coll.mutateIn(
+              this._key,
+              keys.map((key) => MutateInSpec.upsert(key, items[key])),
+              {
+                storeSemantics: StoreSemantics.Upsert,
+                parentSpan: obsReqHandler.wrappedSpan,
+              }
+            )
+          )
+        )
+        obsReqHandler.end()
+      } catch (e) {
+        obsReqHandler.endWithError(e)
+        throw e
+      }
+    }, callback)
+  }
+
   /**
    * Fetches a specific key from the map.
    *
@@ -803,6 +1134,73 @@ export class CouchbaseSet {
     }, callback)
   }
 
+  /**
+   * Adds several new items to the set, returning how many of them were not
+   * already in the set.  The items are added in groups of up to 16 per
+   * operation, with all of the groups being sent at once.  A group which
+   * contains an item that is already in the set is retried an item at a time.
+   *
+   * @param items The items to add.
+   * @param callback A node-style callback to be invoked after execution.
+   */
+  async addMany(
+    items: any[],
+    callback?: NodeCallback<number>
+  ): Promise<number> {
+    const obsReqHandler = new ObservableRequestHandler(
+      DatastructureOp.SetAddMany,
+      this._coll.observabilityInstruments
+    )
+    obsReqHandler.setRequestKeyValueAttributes(this._coll._cppDocId(this._key))
+
+    const addUnique = async (chunk: any[]): Promise<boolean> => {
+      try {
+        await this._coll.mutateIn(
+          this._key,
+          chunk.map((item) => MutateInSpec.arrayAddUnique('', item)),
+          {
+            storeSemantics: StoreSemantics.Upsert,
+            parentSpan: obsReqHandler.wrappedSpan,
+          }
+        )
+        return true
+      } catch (e) {
+        if (e instanceof PathExistsError) {
+          return false
+        }
+        throw e
+      }
+    }
+
+    return PromiseHelper.wrapAsync(async () => {
+      try {
+        // A group fails as a whole if any of its items already exists, so
+        // duplicates are removed up front.
+        const uniqueItems = Array.from(new Set(items))
+        const counts = await Promise.all(
+          subdocChunks(uniqueItems).map(async (chunk) => {
+            if (await addUnique(chunk)) {
+              return chunk.length
+            }
+            if (chunk.length === 1) {
+              return 0
+            }
+
+            const added = await Promise.all(
+              chunk.map((item) => addUnique([item]))
+            )
+            return added.filter((wasAdded) => wasAdded).length
+          })
+        )
+        obsReqHandler.end()
+        return counts.reduce((total, count) => total + count, 0)
+      } catch (e) {
+        obsReqHandler.endWithError(e)
+        throw e
+      }
+    }, callback)
+  }
+
   /**
    * Returns whether a specific value already exists in the set.
    *
@@ -821,15 +1219,14 @@ export class CouchbaseSet {
 
     return PromiseHelper.wrapAsync(async () => {
       try {
-        const values = await this._get(obsReqHandler.wrappedSpan)
-        for (let i = 0; i < values.length; ++i) {
-          if (values[i] === item) {
-            obsReqHandler.end()
-            return true
-          }
-        }
+        const index = await arrayIndexOf(
+          this._coll,
+          this._key,
+          item,
+          obsReqHandler.wrappedSpan
+        )
         obsReqHandler.end()
-        return false
+        return index !== -1
       } catch (e) {
         obsReqHandler.endWithError(e)
         throw e
@@ -1,3 +1,9 @@
+import {
+  CppConnectionStats,
+  CppLatencySnapshot,
+  CppNodeServiceStats,
+  CppNodeStats,
+} from './binding'
 import { ServiceType } from './generaltypes'
 
 /**
@@ -395,6 +401,196 @@ export interface DiagnosticsOptions {
   reportId?: string
 }
 
+/**
+ * The distribution of a set of latencies, in microseconds.
+ *
+ * @category Diagnostics
+ */
+export class LatencyStats {
+  /**
+   * @internal
+   */
+  constructor(data: LatencyStats) {
+    this.totalCount = data.totalCount
+    this.percentiles = data.percentiles
+  }
+
+  /**
+   * The number of latencies recorded.
+   */
+  totalCount: number
+
+  /**
+   * The latency at each reported percentile, keyed by percentile (e.g. "50"
+   * and "99.9").
+   */
+  percentiles: { [percentile: string]: number }
+
+  /**
+   * @internal
+   */
+  static _fromCppData(data: CppLatencySnapshot): LatencyStats {
+    return new LatencyStats({
+      totalCount: data.total_count,
+      percentiles: data.percentiles_us,
+    })
+  }
+}
+
+/**
+ * Describes the operations of a cluster's connection which are currently
+ * executing, and how long completed operations waited for the event loop
+ * before their callbacks could run.
+ *
+ * @category Diagnostics
+ */
+export class ConnectionStats {
+  /**
+   * @internal
+   */
+  constructor(data: ConnectionStats) {
+    this.inFlight = data.inFlight
+    this.pendingCompletions = data.pendingCompletions
+    this.maxPendingCompletions = data.maxPendingCompletions
+    this.completionDelay = data.completionDelay
+  }
+
+  /**
+   * The number of operations which have been sent and are awaiting a
+   * response.
+   */
+  inFlight: number
+
+  /**
+   * The number of operations which have completed, but whose callbacks are
+   * still waiting for the event loop.
+   */
+  pendingCompletions: number
+
+  /**
+   * The highest number of pending completions seen since the stats were last
+   * retrieved.
+   */
+  maxPendingCompletions: number
+
+  /**
+   * The time completed operations spent waiting for the event loop since the
+   * stats were last retrieved.
+   */
+  completionDelay: LatencyStats
+
+  /**
+   * @internal
+   */
+  static _fromCppData(data: CppConnectionStats): ConnectionStats {
+    return new ConnectionStats({
+      inFlight: data.in_flight,
+      pendingCompletions: data.pending_completions,
+      maxPendingCompletions: data.max_pending_completions,
+      completionDelay: LatencyStats._fromCppData(data.completion_delay_us),
+    })
+  }
+}
+
+/**
+ * Describes the operations of a single service which were dispatched to a
+ * node.
+ *
+ * @category Diagnostics
+ */
+export class NodeServiceStats {
+  /**
+   * @internal
+   */
+  constructor(data: NodeServiceStats) {
+    this.totalCount = data.totalCount
+    this.errorCount = data.errorCount
+    this.throughputPerSecond = data.throughputPerSecond
+    this.latency = data.latency
+  }
+
+  /**
+   * The number of operations which completed.
+   */
+  totalCount: number
+
+  /**
+   * The number of operations which completed with an error.
+   */
+  errorCount: number
+
+  /**
+   * The number of operations completed per second over the interval.
+   */
+  throughputPerSecond: number
+
+  /**
+   * The latencies of the operations.
+   */
+  latency: LatencyStats
+
+  /**
+   * @internal
+   */
+  static _fromCppData(data: CppNodeServiceStats): NodeServiceStats {
+    return new NodeServiceStats({
+      totalCount: data.total_count,
+      errorCount: data.error_count,
+      throughputPerSecond: data.throughput_per_s,
+      latency: LatencyStats._fromCppData(data.latency_us),
+    })
+  }
+}
+
+/**
+ * Describes the operations completed by a cluster's connection since the
+ * stats were last retrieved, broken down by the node they were last
+ * dispatched to and by service.
+ *
+ * @category Diagnostics
+ */
+export class NodeStats {
+  /**
+   * @internal
+   */
+  constructor(data: NodeStats) {
+    this.intervalSeconds = data.intervalSeconds
+    this.nodes = data.nodes
+  }
+
+  /**
+   * The length of the interval the stats cover, in seconds.
+   */
+  intervalSeconds: number
+
+  /**
+   * The stats of each node, keyed by node address and then by service.
+   * Operations which were never dispatched are reported under an empty node
+   * address.
+   */
+  nodes: { [node: string]: { [service: string]: NodeServiceStats } }
+
+  /**
+   * @internal
+   */
+  static _fromCppData(data: CppNodeStats): NodeStats {
+    return new NodeStats({
+      intervalSeconds: data.interval_s,
+      nodes: Object.fromEntries(
+        Object.entries(data.nodes).map(([node, services]) => [
+          node,
+          Object.fromEntries(
+            Object.entries(services).map(([service, stats]) => [
+              service,
+              NodeServiceStats._fromCppData(stats),
+            ])
+          ),
+        ])
+      ),
+    })
+  }
+}
+
 /**
  * Represents the desired state of a cluster.
  *
@@ -8,6 +8,7 @@ import {
   AnalyticsErrorContext,
   HttpErrorContext,
 } from './errorcontexts'
+import type { TransactionAttemptTimings } from './transactions'
 
 /**
  * A generic base error that all errors inherit.  Exposes the cause and
@@ -999,8 +1000,15 @@ export class TransactionOperationFailedError extends CouchbaseError {
  * @category Error Handling
  */
 export class TransactionFailedError extends CouchbaseError {
+  /**
+   * Timing information for each attempt made before the transaction ended,
+   * in the order they were made.
+   */
+  attempts: TransactionAttemptTimings[]
+
   constructor(cause?: Error, context?: ErrorContext) {
     super('transaction failed', cause, context)
+    this.attempts = []
   }
 }
 
@@ -1010,8 +1018,15 @@ export class TransactionFailedError extends CouchbaseError {
  * @category Error Handling
  */
 export class TransactionExpiredError extends CouchbaseError {
+  /**
+   * Timing information for each attempt made before the transaction ended,
+   * in the order they were made.
+   */
+  attempts: TransactionAttemptTimings[]
+
   constructor(cause?: Error) {
     super('transaction expired', cause)
+    this.attempts = []
   }
 }
 
@@ -1022,8 +1037,15 @@ export class TransactionExpiredError extends CouchbaseError {
  * @category Error Handling
  */
 export class TransactionCommitAmbiguousError extends CouchbaseError {
+  /**
+   * Timing information for each attempt made before the transaction ended,
+   * in the order they were made.
+   */
+  attempts: TransactionAttemptTimings[]
+
   constructor(cause?: Error) {
     super('transaction commit ambiguous', cause)
+    this.attempts = []
   }
 }
 
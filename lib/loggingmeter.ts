@@ -2,7 +2,7 @@
  * @internal
  */
 
-import * as hdr from 'hdr-histogram-js'
+import binding, { CppConnection, CppOperationMeter } from './binding'
 import { MeterError } from './errors'
 import { CouchbaseLogger } from './logger'
 import { Meter, ValueRecorder } from './metrics'
@@ -46,50 +46,34 @@ interface LoggingMeterReport {
 }
 
 /**
- * Internal class for recording metric values using HDR histograms.
+ * Internal class for recording metric values into one of the histograms of
+ * the native OperationMeter.
  *
  * @internal
  */
 class LoggingValueRecorder implements ValueRecorder {
-  private readonly _histogram: hdr.Histogram
-  private readonly _percentiles = [50.0, 90.0, 99.0, 99.9, 100.0]
+  private readonly _meter: CppOperationMeter
+  private readonly _recorderId: number
 
-  constructor() {
-    this._histogram = hdr.build({
-      lowestDiscernibleValue: 1, // 1 microsecond
-      highestTrackableValue: 30_000_000, // 30 seconds
-      numberOfSignificantValueDigits: 3,
-    })
+  constructor(meter: CppOperationMeter, recorderId: number) {
+    this._meter = meter
+    this._recorderId = recorderId
   }
 
   /**
-   * Records a metric value.
-   *
-   * @param value - The value to record (typically latency in microseconds).
+   * The id of the native histogram values are recorded into.
    */
-  recordValue(value: number): void {
-    this._histogram.recordValue(value)
+  get recorderId(): number {
+    return this._recorderId
   }
 
   /**
-   * Gets the current percentile values and resets the histogram.
+   * Records a metric value.
    *
-   * @returns The percentile report containing total count and percentile values.
+   * @param value - The value to record (typically latency in microseconds).
    */
-  getPercentilesAndReset(): PercentileReport {
-    const mappedPercentiles: Record<string, number> = {}
-
-    for (const p of this._percentiles) {
-      mappedPercentiles[p.toString()] = this._histogram.getValueAtPercentile(p)
-    }
-
-    const result: PercentileReport = {
-      total_count: this._histogram.totalCount,
-      percentiles_us: mappedPercentiles,
-    }
-
-    this._histogram.reset()
-    return result
+  recordValue(value: number): void {
+    this._meter.record(this._recorderId, value)
   }
 }
 
@@ -163,12 +147,14 @@ class LoggingMeterReporter {
  * @internal
  */
 export class LoggingMeter implements Meter {
+  private readonly _impl: CppOperationMeter = new binding.OperationMeter()
   private readonly _recorders: Map<
     ServiceName,
     Map<string, LoggingValueRecorder>
   > = new Map()
   private readonly _reporter: LoggingMeterReporter
   private readonly _emitInterval: number
+  private _nativeDispatch: boolean = false
 
   /**
    * Creates a new LoggingMeter with the specified flush interval.
@@ -197,6 +183,37 @@ export class LoggingMeter implements Meter {
     return this._reporter
   }
 
+  /**
+   * Whether the durations of operations dispatched through a connection are
+   * recorded natively rather than through a value recorder.
+   *
+   * @internal
+   */
+  get nativeDispatch(): boolean {
+    return this._nativeDispatch
+  }
+
+  /**
+   * Has the connection record the durations of the operations it dispatches
+   * into this meter's histograms on the io thread.
+   *
+   * @internal
+   */
+  attachConnection(conn: CppConnection): void {
+    conn.setOperationMeter(this._impl)
+    this._nativeDispatch = true
+  }
+
+  /**
+   * Returns the id of the native histogram for the specified operation, for
+   * the connection to record its duration into.
+   *
+   * @internal
+   */
+  recorderId(service: ServiceName, opName: string): number {
+    return this._recorder(service, opName).recorderId
+  }
+
   /**
    * Gets or creates a value recorder for the specified metric name and tags.
    *
@@ -211,13 +228,23 @@ export class LoggingMeter implements Meter {
     if (!Object.values(ServiceName).includes(serviceTag as ServiceName)) {
       throw new MeterError(new Error(`Invalid service type: ${serviceTag}`))
     }
-    const service = serviceTag as ServiceName
-    const opMap = this._recorders.get(service)!
+    return this._recorder(
+      serviceTag as ServiceName,
+      tags[OpAttributeName.OperationName]
+    )
+  }
 
-    const opName = tags[OpAttributeName.OperationName]
+  private _recorder(
+    service: ServiceName,
+    opName: string
+  ): LoggingValueRecorder {
+    const opMap = this._recorders.get(service)!
     let recorder = opMap.get(opName)
     if (!recorder) {
-      recorder = new LoggingValueRecorder()
+      recorder = new LoggingValueRecorder(
+        this._impl,
+        this._impl.recorder(service, opName)
+      )
       opMap.set(opName, recorder)
     }
     return recorder
@@ -226,34 +253,25 @@ export class LoggingMeter implements Meter {
   /**
    * Creates a report of all recorded metrics and resets the histograms.
    *
+   * The histograms live in native memory and the percentiles are computed
+   * there too, so this is the only point at which recorded values cross
+   * back into JS.
+   *
    * @returns The logging meter report with percentile statistics.
    */
   createReport(): LoggingMeterReport | null {
-    const report: LoggingMeterReport = {
-      meta: {
-        emit_interval_s: this._emitInterval / 1_000,
-      },
-      operations: {},
-    }
+    const operations = this._impl.snapshot()
 
-    for (const [serviceType, opMap] of this._recorders.entries()) {
-      const svcReport: Record<string, PercentileReport> = {}
-      for (const [opName, recorder] of opMap.entries()) {
-        const percentileReport = recorder.getPercentilesAndReset()
-        if (percentileReport.total_count > 0) {
-          svcReport[opName] = percentileReport
-        }
-      }
-      if (Object.keys(svcReport).length > 0) {
-        report.operations[serviceType] = svcReport
-      }
-    }
-
-    if (Object.keys(report.operations).length === 0) {
+    if (Object.keys(operations).length === 0) {
       return null
     }
 
-    return report
+    return {
+      meta: {
+        emit_interval_s: this._emitInterval / 1_000,
+      },
+      operations,
+    }
   }
 
   /**
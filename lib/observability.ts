@@ -3,6 +3,7 @@ import {
   CppObservableRequests,
   CppObservableResponse,
   ObservableBindingFunc,
+  ObservableStreamingBindingFunc,
 } from './binding'
 import { errorFromCpp } from './bindingutilities'
 import { ValueRecorder, Meter } from './metrics'
@@ -75,6 +76,8 @@ export async function wrapObservableBindingCall<
     (resolve: (res: [Error | null, res: TResp]) => void) => {
       if (obsReqHandler) {
         req.wrapper_span_name = obsReqHandler.wrapperSpanName
+        req.native_threshold_log = obsReqHandler.nativeThresholdLog
+        req.meter_recorder_id = obsReqHandler.meterRecorderId
       }
       fn(req, (cppErr: CppError | null, res: TResp) => {
         let err = null
@@ -90,6 +93,48 @@ export async function wrapObservableBindingCall<
   )
 }
 
+/**
+ * Like wrapObservableBindingCall, for binding calls which deliver their
+ * results in several parts.  Each partial result is passed to onEntry as it
+ * arrives, and the returned promise resolves once the call has completed.
+ *
+ * @internal
+ */
+export async function wrapObservableStreamingBindingCall<
+  TReq extends CppObservableRequests,
+  TEntry,
+>(
+  fn: ObservableStreamingBindingFunc<TReq, TEntry>,
+  req: TReq,
+  obsReqHandler: ObservableRequestHandler | null,
+  onEntry: (entry: TEntry) => void
+): Promise<Error | null> {
+  return await new Promise((resolve: (err: Error | null) => void) => {
+    if (obsReqHandler) {
+      req.wrapper_span_name = obsReqHandler.wrapperSpanName
+      req.native_threshold_log = obsReqHandler.nativeThresholdLog
+      req.meter_recorder_id = obsReqHandler.meterRecorderId
+    }
+    fn(req, (cppErr, res, done) => {
+      if (!done) {
+        onEntry(res as TEntry)
+        return
+      }
+
+      let err = null
+      if (cppErr) {
+        err = errorFromCpp(cppErr)
+        obsReqHandler?.processCoreSpan(cppErr.cpp_core_span)
+      } else {
+        obsReqHandler?.processCoreSpan(
+          (res as CppObservableResponse).cpp_core_span
+        )
+      }
+      resolve(err)
+    })
+  })
+}
+
 /**
  * @internal
  */
@@ -32,6 +32,8 @@ import {
   timeInputToHiResTime,
 } from './observabilityutilities'
 import { hiResTimeToMicros, getHiResTimeDelta } from './observabilityutilities'
+import { LoggingMeter } from './loggingmeter'
+import { ThresholdLoggingTracer } from './thresholdlogging'
 import { RequestSpan, RequestTracer } from './tracing'
 import { getErrorMessage } from './utilities'
 
@@ -327,6 +329,143 @@ class ObservableRequestHandlerNoOpTracerImpl {
   ): void {}
 }
 
+/**
+ * Used in place of the tracer impl when the tracer is the default
+ * ThresholdLoggingTracer.  No spans are created in JS: operations dispatched
+ * through the connection are checked against their threshold on the io
+ * thread, and only the remaining operations are timed here.
+ *
+ * @internal
+ */
+class ObservableRequestHandlerThresholdLoggingImpl {
+  private readonly _tracer: ThresholdLoggingTracer
+  private _opType: OpType
+  private _startTime: HiResTime
+  private _dispatched: boolean
+  private _ended: boolean
+
+  constructor(
+    opType: OpType,
+    tracer: ThresholdLoggingTracer,
+    startTime?: HiResTime
+  ) {
+    this._tracer = tracer
+    this._opType = opType
+    this._startTime = startTime ?? timeInputToHiResTime()
+    this._dispatched = false
+    this._ended = false
+  }
+
+  /**
+   * @internal
+   */
+  get clusterName(): string | undefined {
+    return undefined
+  }
+
+  /**
+   * @internal
+   */
+  get clusterUUID(): string | undefined {
+    return undefined
+  }
+
+  /**
+   * The wrapper span name is requested right before the operation is handed
+   * to the connection, which then takes care of the threshold check.
+   *
+   * @internal
+   */
+  get wrapperSpanName(): string {
+    this._dispatched = true
+    return this._opType
+  }
+
+  /**
+   * @internal
+   */
+  get wrappedSpan(): WrappedSpan | undefined {
+    return undefined
+  }
+
+  /**
+   * @internal
+   */
+  end(): void {
+    if (this._ended) {
+      return
+    }
+    this._ended = true
+    if (this._dispatched) {
+      return
+    }
+    const duration = hiResTimeToMicros(
+      getHiResTimeDelta(this._startTime, timeInputToHiResTime())
+    )
+    this._tracer.checkOperationThreshold(
+      serviceNameFromOpType(this._opType),
+      this._opType,
+      duration
+    )
+  }
+
+  /**
+   * @internal
+   */
+  endWithError(_error?: any): void {
+    this.end()
+  }
+
+  /**
+   * @internal
+   */
+  maybeAddEncodingSpan(encodeFn: () => [Buffer, number]): [Buffer, number] {
+    return encodeFn()
+  }
+
+  /**
+   * @internal
+   */
+  maybeCreateEncodingSpan(encodeFn: () => [Buffer, number]): [Buffer, number] {
+    return encodeFn()
+  }
+
+  /**
+   * @internal
+   */
+  processCoreSpan(_coreSpan?: CppWrapperSdkSpan): void {}
+
+  /**
+   * @internal
+   */
+  reset(
+    opType: OpType,
+    _parentSpan?: RequestSpan,
+    withError: boolean = false
+  ): void {
+    if (withError) {
+      this.endWithError()
+    }
+    this._opType = opType
+    this._startTime = timeInputToHiResTime()
+    this._dispatched = false
+    this._ended = false
+  }
+
+  /**
+   * @internal
+   */
+  setRequestHttpAttributes(_options?: HttpOpAttributesOptions): void {}
+
+  /**
+   * @internal
+   */
+  setRequestKeyValueAttributes(
+    _cppDocId: CppDocumentId,
+    _durability?: CppDurabilityLevel
+  ): void {}
+}
+
 /**
  * @internal
  */
@@ -339,6 +478,13 @@ class ObservableRequestHandlerNoOpMeterImpl {
     this._opType = opType
   }
 
+  /**
+   * @internal
+   */
+  get meterRecorderId(): number | undefined {
+    return undefined
+  }
+
   /**
    * @internal
    */
@@ -383,7 +529,9 @@ class ObservableRequestHandlerMeterImpl {
     | (() => Record<string, string | undefined>)
     | undefined
   private readonly _ignoreTopLevelOp: boolean
+  private readonly _nativeMeter: LoggingMeter | undefined
   private _startTime: HiResTime
+  private _dispatched: boolean = false
   private _attrs: Record<string, AttributeValue> = {}
 
   constructor(
@@ -397,6 +545,24 @@ class ObservableRequestHandlerMeterImpl {
     this._getClusterLabelsFn = observabilityInstruments.clusterLabelsFn
     this._startTime = startTime ?? timeInputToHiResTime()
     this._ignoreTopLevelOp = _DATASTRUCTURE_OPS.has(opType as string)
+    if (this._meter instanceof LoggingMeter && this._meter.nativeDispatch) {
+      this._nativeMeter = this._meter
+    }
+  }
+
+  /**
+   * The id of the native histogram the connection is to record the duration
+   * of the operation into.  It is requested right before the operation is
+   * handed to the connection, which then takes care of recording it.
+   *
+   * @internal
+   */
+  get meterRecorderId(): number | undefined {
+    if (!this._nativeMeter || this._ignoreTopLevelOp) {
+      return undefined
+    }
+    this._dispatched = true
+    return this._nativeMeter.recorderId(this._serviceName, this._getOpName())
   }
 
   /**
@@ -427,7 +593,7 @@ class ObservableRequestHandlerMeterImpl {
     const duration = hiResTimeToMicros(
       getHiResTimeDelta(this._startTime, endTime)
     )
-    if (this._ignoreTopLevelOp) {
+    if (this._ignoreTopLevelOp || this._dispatched) {
       return
     }
 
@@ -487,6 +653,7 @@ class ObservableRequestHandlerMeterImpl {
     this._opType = opType
     this._serviceName = serviceNameFromOpType(opType)
     this._startTime = timeInputToHiResTime()
+    this._dispatched = false
     this._attrs = {}
   }
 
@@ -515,6 +682,7 @@ class ObservableRequestHandlerMeterImpl {
  */
 type TracerImpl =
   | ObservableRequestHandlerTracerImpl
+  | ObservableRequestHandlerThresholdLoggingImpl
   | ObservableRequestHandlerNoOpTracerImpl
 
 /**
@@ -568,6 +736,16 @@ export class ObservableRequestHandler {
       observabilityInstruments.tracer instanceof NoOpTracer
     ) {
       this._tracerImpl = _NOOP_TRACER_IMPL
+    } else if (
+      observabilityInstruments.tracer instanceof ThresholdLoggingTracer &&
+      observabilityInstruments.tracer.nativeDispatch &&
+      !parentSpan
+    ) {
+      this._tracerImpl = new ObservableRequestHandlerThresholdLoggingImpl(
+        opType,
+        observabilityInstruments.tracer,
+        startTime
+      )
     } else {
       this._tracerImpl = new ObservableRequestHandlerTracerImpl(
         opType,
@@ -608,6 +786,25 @@ export class ObservableRequestHandler {
     return this._tracerImpl.wrapperSpanName
   }
 
+  /**
+   * @internal
+   */
+  get meterRecorderId(): number | undefined {
+    return this._meterImpl.meterRecorderId
+  }
+
+  /**
+   * Whether the connection is to check the operation against its threshold.
+   * Operations traced with JS spans are checked when their span ends.
+   *
+   * @internal
+   */
+  get nativeThresholdLog(): boolean {
+    return (
+      this._tracerImpl instanceof ObservableRequestHandlerThresholdLoggingImpl
+    )
+  }
+
   /**
    * @internal
    */
@@ -94,6 +94,7 @@ export enum DatastructureOp {
   ListGetAt = 'list_get_at',
   ListIndexOf = 'list_index_of',
   ListPush = 'list_push',
+  ListPushMany = 'list_push_many',
   ListRemoveAt = 'list_remove_at',
   ListSize = 'list_size',
   ListUnshift = 'list_unshift',
@@ -103,12 +104,14 @@ export enum DatastructureOp {
   MapKeys = 'map_keys',
   MapRemove = 'map_remove',
   MapSet = 'map_set',
+  MapSetMany = 'map_set_many',
   MapSize = 'map_size',
   MapValues = 'map_values',
   QueuePop = 'queue_pop',
   QueuePush = 'queue_push',
   QueueSize = 'queue_size',
   SetAdd = 'set_add',
+  SetAddMany = 'set_add_many',
   SetContains = 'set_contains',
   SetRemove = 'set_remove',
   SetSize = 'set_size',
@@ -68,6 +68,25 @@ export class RangeScan implements ScanType {
   getScanType(): string {
     return 'range_scan'
   }
+
+  /**
+   * Recreates a RangeScan from its plain data form, such as one which has been
+   * passed to a worker thread using `postMessage`.
+   *
+   * @param data The plain object describing the range.
+   */
+  static fromJSON(data: {
+    start?: { term: string; exclusive?: boolean }
+    end?: { term: string; exclusive?: boolean }
+  }): RangeScan {
+    const start = data.start
+      ? new ScanTerm(data.start.term, data.start.exclusive)
+      : undefined
+    const end = data.end
+      ? new ScanTerm(data.end.term, data.end.exclusive)
+      : undefined
+    return new RangeScan(start, end)
+  }
 }
 
 /**
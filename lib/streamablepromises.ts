@@ -165,6 +165,9 @@ export class StreamableReplicasPromise<T, TRep> extends StreamablePromise<T> {
  */
 export class StreamableScanPromise<T, TRes> extends StreamablePromise<T> {
   private _cancelRequested: boolean
+  private _paused: boolean
+  private _pausedFn?: () => void
+  private _checkpointFn?: () => Buffer | undefined
 
   constructor(fn: (results: TRes[]) => T) {
     super((emitter, resolve, reject) => {
@@ -182,6 +185,7 @@ export class StreamableScanPromise<T, TRes> extends StreamablePromise<T> {
       })
     })
     this._cancelRequested = false
+    this._paused = false
   }
 
   get cancelRequested(): boolean {
@@ -190,5 +194,70 @@ export class StreamableScanPromise<T, TRes> extends StreamablePromise<T> {
 
   cancelStreaming(): void {
     this._cancelRequested = true
+
+    // A paused scan is parked until it is resumed, so wake it up to let it
+    // observe the cancellation and end.
+    this._paused = false
+    const fn = this._pausedFn
+    this._pausedFn = undefined
+    if (fn) {
+      fn()
+    }
+  }
+
+  get paused(): boolean {
+    return this._paused
+  }
+
+  /**
+   * Stops requesting further results until {@link resumeStreaming} is called,
+   * allowing a slow consumer to apply backpressure to the scan.  While paused
+   * the SDK stops draining the scan, so once its buffers are full no further
+   * batches are requested from the server.
+   */
+  pauseStreaming(): void {
+    this._paused = true
+  }
+
+  /**
+   * Resumes a scan which was paused with {@link pauseStreaming}.
+   */
+  resumeStreaming(): void {
+    this._paused = false
+    const fn = this._pausedFn
+    this._pausedFn = undefined
+    if (fn) {
+      fn()
+    }
+  }
+
+  /**
+   * @internal
+   */
+  _whenFlowing(fn: () => void): void {
+    if (this._paused) {
+      this._pausedFn = fn
+      return
+    }
+    fn()
+  }
+
+  /**
+   * Returns a compact blob describing the per-vbucket progress of the scan
+   * so far, which can be passed as the `resumeFrom` option of a later scan to
+   * continue where this one left off.  Only available when the scan was
+   * started with `trackProgress` or `resumeFrom`.  The checkpoint records
+   * the last key of each vbucket only, not which vbuckets have finished, see
+   * `resumeFrom` for what resuming from it costs.
+   */
+  checkpoint(): Buffer | undefined {
+    return this._checkpointFn ? this._checkpointFn() : undefined
+  }
+
+  /**
+   * @internal
+   */
+  _setCheckpointFn(fn: () => Buffer | undefined): void {
+    this._checkpointFn = fn
   }
 }
@@ -1,4 +1,8 @@
-import { HiResTime } from './binding'
+import binding, {
+  CppConnection,
+  CppThresholdLogger,
+  HiResTime,
+} from './binding'
 import { TracingConfig } from './cluster'
 import { ServiceType } from './generaltypes'
 import { CouchbaseLogger } from './logger'
@@ -45,6 +49,7 @@ enum IgnoredParentSpan {
   ListGetAt = 'list_get_at',
   ListIndexOf = 'list_index_of',
   ListPush = 'list_push',
+  ListPushMany = 'list_push_many',
   ListRemoveAt = 'list_remove_at',
   ListSize = 'list_size',
   ListUnshift = 'list_unshift',
@@ -54,12 +59,14 @@ enum IgnoredParentSpan {
   MapKeys = 'map_keys',
   MapRemove = 'map_remove',
   MapSet = 'map_set',
+  MapSetMany = 'map_set_many',
   MapSize = 'map_size',
   MapValues = 'map_values',
   QueuePop = 'queue_pop',
   QueuePush = 'queue_push',
   QueueSize = 'queue_size',
   SetAdd = 'set_add',
+  SetAddMany = 'set_add_many',
   SetContains = 'set_contains',
   SetRemove = 'set_remove',
   SetSize = 'set_size',
@@ -100,139 +107,33 @@ class ThresholdLoggingSpanSnapshot {
   }
 }
 
-/**
- * @internal
- */
-class PriorityQueue<T> {
-  private readonly _capacity: number
-  private readonly _queue: Array<{ item: T; priority: number }>
-  private _size: number
-  private _droppedCount: number
-
-  constructor(capacity?: number) {
-    this._capacity = capacity ?? 10
-    this._queue = new Array(this._capacity)
-    this._size = 0
-    this._droppedCount = 0
-  }
-
-  get droppedCount(): number {
-    return this._droppedCount
-  }
-
-  _getInsertIndex(priority: number): number {
-    let left = 0
-    let right = this._size
-    while (left < right) {
-      const mid = (left + right) >>> 1 // Math.floor((left + right) / 2) but slightly better
-      if (this._queue[mid].priority < priority) {
-        left = mid + 1
-      } else {
-        right = mid
-      }
-    }
-    return left
-  }
-
-  enqueue(item: T, priority: number): boolean {
-    if (this._size >= this._capacity) {
-      const lowestPriority = this._queue[0].priority
-      if (lowestPriority >= priority) {
-        this._droppedCount++
-        return false
-      }
-      // shift the queue left
-      for (let i = 0; i < this._size - 1; i++) {
-        this._queue[i] = this._queue[i + 1]
-      }
-      this._size--
-      this._droppedCount++
-    }
-    const insertIdx = this._getInsertIndex(priority)
-    // shift items > insertIdx right
-    for (let i = this._size; i > insertIdx; i--) {
-      this._queue[i] = this._queue[i - 1]
-    }
-    this._queue[insertIdx] = { item: item, priority: priority }
-    this._size++
-    return true
-  }
-
-  peek(): T | undefined {
-    return this._size > 0 ? this._queue[0].item : undefined
-  }
-
-  drain(): [T[], number] {
-    const items: T[] = []
-    for (let i = 0; i < this._size; i++) {
-      items.push(this._queue[i].item)
-    }
-    const droppedCount = this._droppedCount
-    this._size = 0
-    this._droppedCount = 0
-    // Return items in descending priority order (highest duration first)
-    items.reverse()
-    return [items, droppedCount]
-  }
-}
-
 /**
  * @internal
  */
 class ThresholdLoggingReporter {
   private readonly _interval: number
-  private readonly _thresholdQueues: Map<
-    ServiceType,
-    PriorityQueue<ThresholdLogRecord>
-  >
+  private readonly _impl: CppThresholdLogger
   private readonly _logger: CouchbaseLogger
   private _timerId: NodeJS.Timeout | undefined
   private _stopped: boolean
 
-  constructor(logger: CouchbaseLogger, interval: number, capacity?: number) {
+  constructor(
+    logger: CouchbaseLogger,
+    interval: number,
+    impl: CppThresholdLogger
+  ) {
     this._logger = logger
     this._interval = interval
-    this._thresholdQueues = new Map<
-      ServiceType,
-      PriorityQueue<ThresholdLogRecord>
-    >()
-    this._thresholdQueues.set(
-      ServiceType.KeyValue,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Query,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Search,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Analytics,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Views,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Management,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
-    this._thresholdQueues.set(
-      ServiceType.Eventing,
-      new PriorityQueue<ThresholdLogRecord>(capacity)
-    )
+    this._impl = impl
     this._stopped = false
   }
 
-  addLogRecord(
-    serviceType: ServiceType,
-    item: ThresholdLogRecord,
-    totalDuration: number
-  ) {
-    this._thresholdQueues.get(serviceType)?.enqueue(item, totalDuration)
+  get impl(): CppThresholdLogger {
+    return this._impl
+  }
+
+  addLogRecord(serviceType: ServiceType, item: ThresholdLogRecord) {
+    this._impl.addRecord(serviceType, Object.fromEntries(item))
   }
 
   start() {
@@ -251,16 +152,7 @@ class ThresholdLoggingReporter {
   }
 
   report(returnReport?: boolean): Record<string, any> | undefined {
-    const report: Record<string, any> = {}
-    for (const [serviceType, queue] of this._thresholdQueues) {
-      const [items, droppedCount] = queue.drain()
-      if (items.length > 0) {
-        report[serviceType as string] = {
-          total_count: items.length + droppedCount,
-          top_requests: items.map((item) => Object.fromEntries(item)),
-        }
-      }
-    }
+    const report = this._impl.report()
     if (returnReport) {
       return report
     } else {
@@ -653,6 +545,7 @@ export class ThresholdLoggingTracer implements RequestTracer {
   readonly _sampleSize: number
   readonly _serviceThresholds: Map<ServiceType, number>
   readonly _reporter: ThresholdLoggingReporter
+  private _nativeDispatch: boolean
   /**
    * Creates a new threshold logging tracer.
    *
@@ -692,12 +585,42 @@ export class ThresholdLoggingTracer implements RequestTracer {
       ServiceType.Eventing,
       config?.eventingThreshold ?? 1000
     )
+    const thresholdsMicros: Record<string, number> = {}
+    for (const serviceType of this._serviceThresholds.keys()) {
+      thresholdsMicros[serviceType] =
+        this._getServiceTypeThreshold(serviceType)
+    }
     this._reporter = new ThresholdLoggingReporter(
       logger,
       this._emitInterval,
-      this._sampleSize
+      new binding.ThresholdLogger({
+        thresholds_us: thresholdsMicros,
+        sample_size: this._sampleSize,
+      })
     )
     this._reporter.start()
+    this._nativeDispatch = false
+  }
+
+  /**
+   * Whether operations dispatched through a connection are checked against
+   * their thresholds natively rather than through JS spans.
+   *
+   * @internal
+   */
+  get nativeDispatch(): boolean {
+    return this._nativeDispatch
+  }
+
+  /**
+   * Has the connection check the operations it dispatches against this
+   * tracer's thresholds on the io thread.
+   *
+   * @internal
+   */
+  attachConnection(conn: CppConnection): void {
+    conn.setThresholdLogger(this._reporter.impl)
+    this._nativeDispatch = true
   }
 
   /**
@@ -773,11 +696,47 @@ export class ThresholdLoggingTracer implements RequestTracer {
       spanSnapshot,
       spanTotalDuration
     )
-    this._reporter.addLogRecord(
-      spanSnapshot.serviceType,
-      thresholdLogRecord,
-      spanTotalDuration
+    this._reporter.addLogRecord(spanSnapshot.serviceType, thresholdLogRecord)
+  }
+
+  /**
+   * Checks an operation which was timed without creating any spans against
+   * its threshold.  Operations dispatched through the connection are checked
+   * on the io thread instead, this covers the ones which are not (e.g. range
+   * scans and transactions).
+   *
+   * @param serviceName - The service the operation belongs to.
+   * @param name - The name of the operation.
+   * @param totalDuration - The duration of the operation, in microseconds.
+   *
+   * @internal
+   */
+  checkOperationThreshold(
+    serviceName: string,
+    name: string,
+    totalDuration: number
+  ): void {
+    // Datastructure operations are reported through their sub-operations.
+    if (IGNORED_PARENT_SPAN_VALUES.has(name)) {
+      return
+    }
+    let serviceType: ServiceType
+    try {
+      serviceType = serviceTypeFromString(serviceName)
+    } catch (_e) {
+      return
+    }
+    const serviceThreshold = this._getServiceTypeThreshold(serviceType)
+    if (!serviceThreshold || totalDuration <= serviceThreshold) {
+      return
+    }
+    const thresholdLogRecord: ThresholdLogRecord = new Map()
+    thresholdLogRecord.set(ThresholdLoggingAttributeName.OperationName, name)
+    thresholdLogRecord.set(
+      ThresholdLoggingAttributeName.TotalDuration,
+      totalDuration
     )
+    this._reporter.addLogRecord(serviceType, thresholdLogRecord)
   }
 
   /**
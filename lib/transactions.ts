@@ -1,5 +1,6 @@
 import {
   CppDocumentId,
+  CppEncodedValue,
   CppGenericError,
   CppTransactions,
   CppTransaction,
@@ -24,6 +25,7 @@ import { Cluster } from './cluster'
 import { Collection } from './collection'
 import {
   DocumentNotFoundError,
+  FeatureNotAvailableError,
   TransactionCommitAmbiguousError,
   TransactionExpiredError,
   TransactionFailedError,
@@ -37,8 +39,18 @@ import {
   QueryResult,
   QueryScanConsistency,
 } from './querytypes'
+import {
+  getHiResTimeDelta,
+  hiResTimeToMicros,
+  timeInputToHiResTime,
+} from './observabilityutilities'
+import { OpAttributeName, ServiceName } from './observabilitytypes'
 import { Scope } from './scope'
-import { DefaultTranscoder, Transcoder } from './transcoders'
+import {
+  CompressingTranscoder,
+  DefaultTranscoder,
+  Transcoder,
+} from './transcoders'
 import { Cas, PromiseHelper } from './utilities'
 
 /**
@@ -307,6 +319,135 @@ export class TransactionGetMultiReplicasFromPreferredServerGroupSpec {
   }
 }
 
+/**
+ * Represents a document to insert as part of an insertMulti operation.
+ *
+ * @category Transactions
+ */
+export class TransactionInsertMultiSpec {
+  constructor(
+    collection: Collection,
+    id: string,
+    content: any,
+    transcoder?: Transcoder
+  ) {
+    this.collection = collection
+    this.id = id
+    this.content = content
+    this.transcoder = transcoder
+  }
+
+  /**
+   * The Collection where the document belongs.
+   */
+  collection: Collection
+
+  /**
+   * The id (or key) of the document.
+   */
+  id: string
+
+  /**
+   * The content of the document to insert.
+   */
+  content: any
+
+  /**
+   * The Transcoder to encode/decode the document.
+   */
+  transcoder?: Transcoder
+}
+
+/**
+ * Represents a document to replace as part of a replaceMulti operation.
+ *
+ * @category Transactions
+ */
+export class TransactionReplaceMultiSpec {
+  constructor(
+    doc: TransactionGetResult,
+    content: any,
+    transcoder?: Transcoder
+  ) {
+    this.doc = doc
+    this.content = content
+    this.transcoder = transcoder
+  }
+
+  /**
+   * The document to replace.
+   */
+  doc: TransactionGetResult
+
+  /**
+   * The new content of the document.
+   */
+  content: any
+
+  /**
+   * The Transcoder to encode/decode the document.
+   */
+  transcoder?: Transcoder
+}
+
+/**
+ * Contains the time spent performing one kind of operation during a
+ * transaction attempt.
+ *
+ * @category Transactions
+ */
+export interface TransactionStageTiming {
+  /**
+   * The number of operations of this kind which were performed.
+   */
+  count: number
+
+  /**
+   * The total time the operations took to complete, in microseconds.
+   */
+  totalMicros: number
+}
+
+/**
+ * Contains timing information about a single attempt of a transaction.
+ *
+ * @category Transactions
+ */
+export class TransactionAttemptTimings {
+  /**
+   * @internal
+   */
+  constructor(data: TransactionAttemptTimings) {
+    this.durationMicros = data.durationMicros
+    this.stages = data.stages
+    this.callbackDelayMicros = data.callbackDelayMicros
+    this.retryReason = data.retryReason
+  }
+
+  /**
+   * The total duration of the attempt, in microseconds.
+   */
+  durationMicros: number
+
+  /**
+   * The time spent in each kind of operation, such as staging mutations
+   * (insert, replace, remove), queries or the commit, keyed by the name of
+   * the operation.
+   */
+  stages: { [stage: string]: TransactionStageTiming }
+
+  /**
+   * The total time completed operations spent waiting for the JS thread
+   * before their callbacks could run, in microseconds.
+   */
+  callbackDelayMicros: number
+
+  /**
+   * The reason the attempt was retried, if it was not the final attempt.
+   */
+  retryReason?: string
+}
+
 /**
  * Contains the results of a Transaction.
  *
@@ -316,9 +457,14 @@ export class TransactionResult {
   /**
    * @internal
    */
-  constructor(data: { transactionId: string; unstagingComplete: boolean }) {
+  constructor(data: {
+    transactionId: string
+    unstagingComplete: boolean
+    attempts?: TransactionAttemptTimings[]
+  }) {
     this.transactionId = data.transactionId
     this.unstagingComplete = data.unstagingComplete
+    this.attempts = data.attempts || []
   }
 
   /**
@@ -331,6 +477,13 @@ export class TransactionResult {
    * for non-transactional operations to see.
    */
   unstagingComplete: boolean
+
+  /**
+   * Timing information for each attempt of the transaction, in the order
+   * they were made.  The number of retries is one less than the number of
+   * attempts.
+   */
+  attempts: TransactionAttemptTimings[]
 }
 
 /**
@@ -728,6 +881,54 @@ function translateGetResult(
   })
 }
 
+/**
+ * @internal
+ */
+function translateStagedResults(
+  cppRes: (CppTransactionGetResult | undefined)[] | null,
+  transcoders: Transcoder[]
+): TransactionGetResult[] | null {
+  if (!cppRes) {
+    return null
+  }
+  return cppRes.map(
+    (res, i) =>
+      translateGetResult(res || null, transcoders[i]) as TransactionGetResult
+  )
+}
+
+/**
+ * Staged content is written by the transactions library rather than by the
+ * connection, which is where values are compressed, so a compressing
+ * transcoder would store uncompressed bytes flagged as compressed.
+ *
+ * @internal
+ */
+function encodeContent(transcoder: Transcoder, content: any): [Buffer, number] {
+  if (transcoder instanceof CompressingTranscoder) {
+    throw new FeatureNotAvailableError(
+      new Error('CompressingTranscoder cannot be used within transactions.')
+    )
+  }
+  return transcoder.encode(content)
+}
+
+/**
+ * @internal
+ */
+function getResultToCpp(doc: TransactionGetResult): CppTransactionGetResult {
+  return {
+    id: doc.id,
+    content: {
+      data: Buffer.from(''),
+      flags: 0,
+    },
+    cas: doc.cas,
+    links: doc._links,
+    metadata: doc._metadata,
+  }
+}
+
 /**
  * @internal
  */
@@ -826,6 +1027,26 @@ export class TransactionAttemptContext {
     return this._impl
   }
 
+  /**
+   * @internal
+   */
+  _takeTimings(
+    durationMicros: number,
+    retryReason?: string
+  ): TransactionAttemptTimings {
+    const cppTimings = this._impl.takeTimings()
+    const stages: { [stage: string]: TransactionStageTiming } = {}
+    for (const [stage, timing] of Object.entries(cppTimings.stages)) {
+      stages[stage] = { count: timing.count, totalMicros: timing.total_us }
+    }
+    return new TransactionAttemptTimings({
+      durationMicros,
+      stages,
+      callbackDelayMicros: cppTimings.callback_delay_us,
+      retryReason,
+    })
+  }
+
   /**
    * @internal
    */
@@ -985,7 +1206,7 @@ export class TransactionAttemptContext {
     return PromiseHelper.wrap((wrapCallback) => {
       const id = collection._cppDocId(key)
       const transcoder = options?.transcoder || this._transcoder
-      const [data, flags] = transcoder.encode(content)
+      const [data, flags] = encodeContent(transcoder, content)
       this._impl.insert(
         {
           id,
@@ -1020,19 +1241,10 @@ export class TransactionAttemptContext {
   ): Promise<TransactionGetResult> {
     return PromiseHelper.wrap((wrapCallback) => {
       const transcoder = options?.transcoder || this._transcoder
-      const [data, flags] = transcoder.encode(content)
+      const [data, flags] = encodeContent(transcoder, content)
       this._impl.replace(
         {
-          doc: {
-            id: doc.id,
-            content: {
-              data: Buffer.from(''),
-              flags: 0,
-            },
-            cas: doc.cas,
-            links: doc._links,
-            metadata: doc._metadata,
-          },
+          doc: getResultToCpp(doc),
           content: {
             data,
             flags,
@@ -1059,16 +1271,90 @@ export class TransactionAttemptContext {
     return PromiseHelper.wrap((wrapCallback) => {
       this._impl.remove(
         {
-          doc: {
-            id: doc.id,
-            content: {
-              data: Buffer.from(''),
-              flags: 0,
-            },
-            cas: doc.cas,
-            links: doc._links,
-            metadata: doc._metadata,
-          },
+          doc: getResultToCpp(doc),
+        },
+        (cppErr) => {
+          const err = errorFromCpp(cppErr)
+          wrapCallback(err, null)
+        }
+      )
+    })
+  }
+
+  /**
+   * Inserts multiple new documents, failing if any of the documents already
+   * exist.  The documents are staged concurrently within the attempt, which is
+   * substantially faster than inserting them one at a time.
+   *
+   * @param specs The documents to insert.
+   */
+  async insertMulti(
+    specs: TransactionInsertMultiSpec[]
+  ): Promise<TransactionGetResult[]> {
+    return PromiseHelper.wrap((wrapCallback) => {
+      const transcoders = specs.map(
+        (spec) => spec.transcoder || this._transcoder
+      )
+      const ids: CppDocumentId[] = []
+      const contents: CppEncodedValue[] = []
+      specs.forEach((spec, i) => {
+        const [data, flags] = encodeContent(transcoders[i], spec.content)
+        ids.push(spec.collection._cppDocId(spec.id))
+        contents.push({ data, flags })
+      })
+      this._impl.insertMulti({ ids, contents }, (cppErr, cppRes) => {
+        const err = errorFromCpp(cppErr)
+        if (err) {
+          return wrapCallback(err, null)
+        }
+
+        wrapCallback(err, translateStagedResults(cppRes, transcoders))
+      })
+    })
+  }
+
+  /**
+   * Replaces multiple documents.  The replacements are staged concurrently
+   * within the attempt.
+   *
+   * @param specs The documents to replace along with their new content.
+   */
+  async replaceMulti(
+    specs: TransactionReplaceMultiSpec[]
+  ): Promise<TransactionGetResult[]> {
+    return PromiseHelper.wrap((wrapCallback) => {
+      const transcoders = specs.map(
+        (spec) => spec.transcoder || this._transcoder
+      )
+      const docs: CppTransactionGetResult[] = []
+      const contents: CppEncodedValue[] = []
+      specs.forEach((spec, i) => {
+        const [data, flags] = encodeContent(transcoders[i], spec.content)
+        docs.push(getResultToCpp(spec.doc))
+        contents.push({ data, flags })
+      })
+      this._impl.replaceMulti({ docs, contents }, (cppErr, cppRes) => {
+        const err = errorFromCpp(cppErr)
+        if (err) {
+          return wrapCallback(err, null)
+        }
+
+        wrapCallback(err, translateStagedResults(cppRes, transcoders))
+      })
+    })
+  }
+
+  /**
+   * Removes multiple documents.  The removals are staged concurrently within
+   * the attempt.
+   *
+   * @param docs The documents to remove.
+   */
+  async removeMulti(docs: TransactionGetResult[]): Promise<void> {
+    return PromiseHelper.wrap((wrapCallback) => {
+      this._impl.removeMulti(
+        {
+          docs: docs.map((doc) => getResultToCpp(doc)),
         },
         (cppErr) => {
           const err = errorFromCpp(cppErr)
@@ -1181,7 +1467,8 @@ export class TransactionAttemptContext {
  */
 export class Transactions {
   private _cluster: Cluster
-  private _impl: CppTransactions
+  private _impl?: CppTransactions
+  private _implPromise: Promise<CppTransactions>
 
   /**
   @internal
@@ -1198,42 +1485,64 @@ export class Transactions {
     }
 
     const connImpl = cluster.conn
-    try {
-      const txnsImpl = new binding.Transactions(connImpl, {
-        durability_level: durabilityToCpp(config.durabilityLevel),
-        timeout: config.timeout,
-        query_scan_consistency: queryScanConsistencyToCpp(
-          config.queryConfig.scanConsistency
-        ),
-        cleanup_window: config.cleanupConfig.cleanupWindow,
-        cleanup_lost_attempts: !config.cleanupConfig.disableLostAttemptCleanup,
-        cleanup_client_attempts:
-          !config.cleanupConfig.disableClientAttemptCleanup,
-        metadata_collection: transactionKeyspaceToCpp(
-          config.metadataCollection
-        ),
-      })
-
-      this._cluster = cluster
-      this._impl = txnsImpl
-    } catch (err) {
-      throw errorFromCpp(err as CppGenericError)
+    const txnsConfig = {
+      durability_level: durabilityToCpp(config.durabilityLevel),
+      timeout: config.timeout,
+      query_scan_consistency: queryScanConsistencyToCpp(
+        config.queryConfig.scanConsistency
+      ),
+      cleanup_window: config.cleanupConfig.cleanupWindow,
+      cleanup_lost_attempts: !config.cleanupConfig.disableLostAttemptCleanup,
+      cleanup_client_attempts:
+        !config.cleanupConfig.disableClientAttemptCleanup,
+      metadata_collection: transactionKeyspaceToCpp(config.metadataCollection),
     }
+
+    this._cluster = cluster
+    this._implPromise = new Promise((resolve, reject) => {
+      try {
+        binding.Transactions.create(connImpl, txnsConfig, (cppErr, impl) => {
+          const err = errorFromCpp(cppErr)
+          if (err) {
+            return reject(err)
+          }
+
+          this._impl = impl as CppTransactions
+          resolve(this._impl)
+        })
+      } catch (err) {
+        reject(errorFromCpp(err as CppGenericError))
+      }
+    })
+    // Creation failures are reported by the first transaction which is run,
+    // so they must not also surface as an unhandled rejection.
+    this._implPromise.catch(() => undefined)
   }
 
   /**
   @internal
   */
   get impl(): CppTransactions {
+    if (!this._impl) {
+      throw new Error('Transactions have not finished initializing.')
+    }
     return this._impl
   }
 
   /**
   @internal
   */
-  _close(): Promise<void> {
+  async _close(): Promise<void> {
+    let impl: CppTransactions
+    try {
+      impl = await this._implPromise
+    } catch (_e) {
+      // creation failed, so there is nothing to close
+      return
+    }
+
     return PromiseHelper.wrap((wrapCallback) => {
-      this._impl.close((cppErr) => {
+      impl.close((cppErr) => {
         const err = errorFromCpp(cppErr)
         wrapCallback(err, null)
       })
@@ -1250,7 +1559,19 @@ export class Transactions {
     logicFn: (attempt: TransactionAttemptContext) => Promise<void>,
     config?: TransactionOptions
   ): Promise<TransactionResult> {
+    await this._implPromise
     const txn = new TransactionAttemptContext(this, config)
+    const attempts: TransactionAttemptTimings[] = []
+    let attemptStart = timeInputToHiResTime()
+    const endAttempt = (retryReason?: string) => {
+      const durationMicros = hiResTimeToMicros(
+        getHiResTimeDelta(attemptStart, timeInputToHiResTime())
+      )
+      const timings = txn._takeTimings(durationMicros, retryReason)
+      attempts.push(timings)
+      this._recordAttemptTimings(timings)
+      attemptStart = timeInputToHiResTime()
+    }
 
     for (;;) {
       await txn._newAttempt()
@@ -1259,28 +1580,67 @@ export class Transactions {
         await logicFn(txn)
       } catch (e) {
         await txn._rollback()
+        endAttempt()
+        let err:
+          | TransactionFailedError
+          | TransactionExpiredError
+          | TransactionCommitAmbiguousError
         if (e instanceof TransactionOperationFailedError) {
-          throw new TransactionFailedError(e.cause, e.context)
+          err = new TransactionFailedError(e.cause, e.context)
         } else if (
           e instanceof TransactionExpiredError ||
           e instanceof TransactionCommitAmbiguousError
         ) {
-          throw e
+          err = e
+        } else {
+          err = new TransactionFailedError(e as Error)
         }
-        throw new TransactionFailedError(e as Error)
+        err.attempts = attempts
+        throw err
       }
 
       try {
         const txnResult = await txn._commit() // this is actually finalize internally
         if (!txnResult) {
           // no result and no error, try again
+          endAttempt('no_result')
           continue
         }
 
+        endAttempt()
+        txnResult.attempts = attempts
         return txnResult
-      } catch (_e) {
+      } catch (e) {
         // commit failed, retry...
+        endAttempt(e instanceof Error ? e.message : String(e))
       }
     }
   }
+
+  /**
+   * @internal
+   */
+  _recordAttemptTimings(timings: TransactionAttemptTimings): void {
+    const meter = this._cluster.observabilityInstruments?.meter
+    if (!meter) {
+      return
+    }
+
+    const record = (opName: string, micros: number) => {
+      meter
+        .valueRecorder(OpAttributeName.MeterNameOpDuration, {
+          [OpAttributeName.SystemName]: 'couchbase',
+          [OpAttributeName.Service]: ServiceName.Transactions,
+          [OpAttributeName.OperationName]: opName,
+          [OpAttributeName.ReservedUnit]: OpAttributeName.ReservedUnitSeconds,
+        })
+        .recordValue(micros)
+    }
+
+    record('transaction_attempt', timings.durationMicros)
+    record('transaction_callback_delay', timings.callbackDelayMicros)
+    for (const [stage, timing] of Object.entries(timings.stages)) {
+      record(`transaction_${stage}`, timing.totalMicros)
+    }
+  }
 }
@@ -1,3 +1,5 @@
+import binding from './binding'
+
 const NF_JSON = 0x00
 const NF_RAW = 0x02
 const NF_UTF8 = 0x04
@@ -11,6 +13,16 @@ const CF_RAW = 0x03 << 24
 const CF_UTF8 = 0x04 << 24
 const CF_MASK = 0xff << 24
 
+// Private formats, stored alongside CF_PRIVATE and NF_RAW, so that other SDKs
+// treat them as binary data.
+const PF_MSGPACK = 0x01 << 8
+const PF_CBOR = 0x02 << 8
+const PF_MASK = 0xff << 8
+
+const COMPRESSION_SNAPPY = 0x01 << 16
+const COMPRESSION_LZ4 = 0x02 << 16
+const COMPRESSION_MASK = 0x03 << 16
+
 /**
  * Transcoders provide functionality for converting values passed to and from
  * the SDK to byte arrays and flags data that can be stored to the server.
@@ -36,6 +48,21 @@ export interface Transcoder {
   decode(bytes: Buffer, flags: number): any
 }
 
+/**
+ * @category Key-Value
+ */
+export interface DefaultTranscoderOptions {
+  /**
+   * Encodes and decodes JSON natively rather than with JSON.stringify and
+   * JSON.parse.  Decoding builds JS values directly from the document bytes.
+   * Encoding serializes into a native scratch buffer, which is then copied
+   * into the Buffer that is sent, so it saves the intermediate JS string
+   * but not a copy.  The results are the same either way.  Defaults to
+   * false.
+   */
+  nativeJson?: boolean
+}
+
 /**
  * The default transcoder implements cross-sdk transcoding capabilities by
  * taking advantage of the common flags specification to ensure compatibility.
@@ -45,6 +72,23 @@ export interface Transcoder {
  * @category Key-Value
  */
 export class DefaultTranscoder implements Transcoder {
+  private _nativeJson: boolean
+
+  constructor(options?: DefaultTranscoderOptions) {
+    if (!options) {
+      options = {}
+    }
+
+    this._nativeJson = options.nativeJson || false
+  }
+
+  /**
+   * @internal
+   */
+  get nativeJson(): boolean {
+    return this._nativeJson
+  }
+
   /**
    * Encodes the specified value, returning a buffer and flags that are
    * stored to the server and later used for decoding.
@@ -62,7 +106,15 @@ export class DefaultTranscoder implements Transcoder {
       return [Buffer.from(value), CF_UTF8 | NF_UTF8]
     }
 
-    // Encode it to JSON and save that otherwise.
+    // Encode it to JSON and save that otherwise.  The native encoder only
+    // declines values which JSON.stringify does not encode either, which
+    // are left to fail the same way they always have.
+    if (this._nativeJson) {
+      const bytes = binding.jsonEncode(value)
+      if (bytes !== undefined) {
+        return [bytes, CF_JSON | NF_JSON]
+      }
+    }
     return [Buffer.from(JSON.stringify(value)), CF_JSON | NF_JSON]
   }
 
@@ -96,6 +148,14 @@ export class DefaultTranscoder implements Transcoder {
     } else if (format === NF_RAW) {
       return bytes
     } else if (format === NF_JSON) {
+      // The native decoder leaves invalid JSON, and the few documents it
+      // does not handle itself, to JSON.parse.
+      if (this._nativeJson) {
+        const decoded = binding.jsonDecode(bytes)
+        if (decoded !== undefined) {
+          return decoded
+        }
+      }
       try {
         return JSON.parse(bytes.toString('utf8'))
       } catch (_e) {
@@ -295,3 +355,211 @@ export class RawJsonTranscoder implements Transcoder {
     }
   }
 }
+
+/**
+ * The MessagePack transcoder stores values as MessagePack, a binary format
+ * which is usually more compact than JSON, and which stores binary data as it
+ * is rather than as an array of numbers.
+ *
+ * Any value which is encodable to JSON can be stored, with the same handling
+ * of toJSON and of members which are undefined, functions or symbols.  In
+ * addition, Buffers (and other binary views) are stored as binary data and
+ * read back as Buffers, Dates are stored as timestamps and read back as Dates,
+ * and BigInts are stored as 64-bit integers.  Integers outside of the safe
+ * integer range are read back as BigInts.
+ *
+ * Documents are stored with private flags, which other SDKs read as binary
+ * data, and sub-document operations cannot be used on them.
+ *
+ * @category Key-Value
+ */
+export class MsgpackTranscoder implements Transcoder {
+  /**
+   * Encodes the specified value, returning a buffer and flags that are
+   * stored to the server and later used for decoding.
+   *
+   * @param value The value to encode.
+   */
+  encode(value: any): [Buffer, number] {
+    return [binding.msgpackEncode(value), CF_PRIVATE | PF_MSGPACK | NF_RAW]
+  }
+
+  /**
+   * Decodes a buffer and flags tuple back to the original type of the
+   * document.
+   *
+   * @param bytes The bytes that were previously encoded.
+   * @param flags The flags associated with the data.
+   */
+  decode(bytes: Buffer, flags: number): any {
+    if ((flags & CF_MASK) === CF_PRIVATE && (flags & PF_MASK) === PF_MSGPACK) {
+      return binding.msgpackDecode(bytes)
+    }
+
+    throw new Error('Only MessagePack data supported by MsgpackTranscoder.')
+  }
+}
+
+/**
+ * The CBOR transcoder stores values as CBOR (RFC 8949), a binary format which
+ * is usually more compact than JSON, and which stores binary data as it is
+ * rather than as an array of numbers.
+ *
+ * Values are mapped as they are by the {@link MsgpackTranscoder}, with Dates
+ * stored as epoch-based date/times (tag 1).  Reading also accepts
+ * indefinite-length items, half-precision floats, date/time strings (tag 0)
+ * and bignums (tags 2 and 3).
+ *
+ * Documents are stored with private flags, which other SDKs read as binary
+ * data, and sub-document operations cannot be used on them.
+ *
+ * @category Key-Value
+ */
+export class CborTranscoder implements Transcoder {
+  /**
+   * Encodes the specified value, returning a buffer and flags that are
+   * stored to the server and later used for decoding.
+   *
+   * @param value The value to encode.
+   */
+  encode(value: any): [Buffer, number] {
+    return [binding.cborEncode(value), CF_PRIVATE | PF_CBOR | NF_RAW]
+  }
+
+  /**
+   * Decodes a buffer and flags tuple back to the original type of the
+   * document.
+   *
+   * @param bytes The bytes that were previously encoded.
+   * @param flags The flags associated with the data.
+   */
+  decode(bytes: Buffer, flags: number): any {
+    if ((flags & CF_MASK) === CF_PRIVATE && (flags & PF_MASK) === PF_CBOR) {
+      return binding.cborDecode(bytes)
+    }
+
+    throw new Error('Only CBOR data supported by CborTranscoder.')
+  }
+}
+
+/**
+ * Specifies the algorithm a {@link CompressingTranscoder} compresses values
+ * with.
+ *
+ * @category Key-Value
+ */
+export enum CompressionAlgorithm {
+  /**
+   * Compress values with Snappy.
+   */
+  Snappy = 'snappy',
+
+  /**
+   * Compress values with LZ4.  This is only available if the SDK was built
+   * with LZ4 support, which is the default.
+   */
+  Lz4 = 'lz4',
+}
+
+/**
+ * @category Key-Value
+ */
+export interface CompressingTranscoderOptions {
+  /**
+   * The transcoder used to encode values before they are compressed, and to
+   * decode them once they have been decompressed.  Defaults to a
+   * {@link DefaultTranscoder}.
+   */
+  transcoder?: Transcoder
+
+  /**
+   * The algorithm to compress values with.  Defaults to Snappy.
+   */
+  algorithm?: CompressionAlgorithm
+
+  /**
+   * Encoded values smaller than this number of bytes are stored uncompressed.
+   * Defaults to 1024.
+   */
+  minSize?: number
+}
+
+/**
+ * The compressing transcoder compresses the values encoded by another
+ * transcoder before they are stored, marking them as compressed in the flags.
+ *
+ * Compression happens natively, on the SDK's io thread rather than the JS
+ * thread, and only values which actually get smaller are stored compressed.
+ * Values read back with this transcoder are decompressed natively before
+ * being decoded.  Compressed documents are stored as private binary data, so
+ * other transcoders (and other SDKs) read them as compressed bytes.  As the
+ * server only sees compressed bytes, sub-document operations cannot be used
+ * on compressed documents, and this transcoder cannot be used to write
+ * documents within transactions.
+ *
+ * @category Key-Value
+ */
+export class CompressingTranscoder implements Transcoder {
+  private _transcoder: Transcoder
+  private _compressionFlag: number
+  private _minSize: number
+
+  constructor(options?: CompressingTranscoderOptions) {
+    if (!options) {
+      options = {}
+    }
+
+    const algorithm = options.algorithm || CompressionAlgorithm.Snappy
+    if (algorithm === CompressionAlgorithm.Snappy) {
+      this._compressionFlag = COMPRESSION_SNAPPY
+    } else if (algorithm === CompressionAlgorithm.Lz4) {
+      this._compressionFlag = COMPRESSION_LZ4
+    } else {
+      throw new Error(`Unrecognized compression algorithm: ${algorithm}.`)
+    }
+    if (!binding.valueCompressionAlgorithms.includes(algorithm)) {
+      throw new Error(
+        `Compression algorithm ${algorithm} is not supported by this build.`
+      )
+    }
+
+    this._transcoder = options.transcoder || new DefaultTranscoder()
+    this._minSize = options.minSize !== undefined ? options.minSize : 1024
+  }
+
+  /**
+   * Encodes the specified value, returning a buffer and flags that are
+   * stored to the server and later used for decoding.
+   *
+   * @param value The value to encode.
+   */
+  encode(value: any): [Buffer, number] {
+    const [bytes, flags] = this._transcoder.encode(value)
+    if (flags & COMPRESSION_MASK) {
+      throw new Error(
+        'Flags of the wrapped transcoder conflict with compression.'
+      )
+    }
+
+    if (bytes.length < this._minSize) {
+      return [bytes, flags]
+    }
+    return [bytes, flags | this._compressionFlag]
+  }
+
+  /**
+   * Decodes a buffer and flags tuple back to the original type of the
+   * document.
+   *
+   * @param bytes The bytes that were previously encoded.
+   * @param flags The flags associated with the data.
+   */
+  decode(bytes: Buffer, flags: number): any {
+    // Compressed values are decompressed before they reach the transcoder,
+    // so any compression flags left mean that decompression failed.
+    if (flags & COMPRESSION_MASK) {
+      throw new Error('Compressed value could not be decompressed.')
+    }
+    return this._transcoder.decode(bytes, flags)
+  }
+}
@@ -217,6 +217,8 @@ function configureBinary(
         '--CDCPM_DOWNLOAD_ALL=ON',
         '--CDCPM_USE_NAMED_CACHE_DIRECTORIES=ON',
         '--CDCPM_USE_LOCAL_PACKAGES=OFF',
+        // LZ4 is optional for a build, but the cache must always carry it.
+        '--CDUSE_LZ4_COMPRESSION=ON',
       ]
     )
   }
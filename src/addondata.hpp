@@ -23,6 +23,15 @@ public:
     Napi::FunctionReference _transactionsCtor;
     Napi::FunctionReference _transactionCtor;
     Napi::FunctionReference _scanIteratorCtor;
+    Napi::FunctionReference _operationMeterCtor;
+    Napi::FunctionReference _thresholdLoggerCtor;
+    Napi::FunctionReference _jsonStringify;
+    Napi::ObjectReference _objectPrototype;
+    Napi::FunctionReference _arrayOf;
+    Napi::ObjectReference _numberPrototype;
+    Napi::ObjectReference _stringPrototype;
+    Napi::ObjectReference _booleanPrototype;
+    Napi::ObjectReference _bigIntPrototype;
 };
 
 } // namespace couchnode
@@ -0,0 +1,1485 @@
+#include "binary_transcoders.hpp"
+#include "addondata.hpp"
+#include "scratch_buffer.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace couchnode
+{
+
+// Values nested deeper than this are rejected, which keeps the recursion
+// here well clear of the native stack limit.
+static constexpr std::size_t MAX_DEPTH = 512;
+
+// Integers up to this magnitude are encoded and decoded as JS numbers.
+static constexpr double MAX_SAFE_INTEGER = 9007199254740991.0;
+static constexpr std::uint64_t MAX_SAFE_UINT = 9007199254740991;
+
+static void checkStatus(Napi::Env env, napi_status status)
+{
+    if (status != napi_ok) {
+        throw Napi::Error::New(env);
+    }
+}
+
+static void appendBigEndian(std::string &out, std::uint64_t value, int size)
+{
+    for (int i = size - 1; i >= 0; --i) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+    }
+}
+
+static std::uint64_t doubleBits(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static std::uint32_t floatBits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Whether a number survives a round trip through a float32 unchanged.
+static bool fitsFloat(double value)
+{
+    if (std::isinf(value)) {
+        return true;
+    }
+    if (!(std::fabs(value) <= std::numeric_limits<float>::max())) {
+        return false;
+    }
+    return static_cast<double>(static_cast<float>(value)) == value;
+}
+
+class MsgpackWriter
+{
+public:
+    static constexpr std::uint64_t MAX_LENGTH = 0xffffffff;
+
+    explicit MsgpackWriter(std::string &out)
+        : _out(out)
+    {
+    }
+
+    std::string &out()
+    {
+        return _out;
+    }
+
+    void writeNull()
+    {
+        writeByte(0xc0);
+    }
+
+    void writeUndefined()
+    {
+        writeNull();
+    }
+
+    void writeBool(bool value)
+    {
+        writeByte(value ? 0xc3 : 0xc2);
+    }
+
+    void writeUint(std::uint64_t value)
+    {
+        if (value <= 0x7f) {
+            writeByte(static_cast<std::uint8_t>(value));
+        } else if (value <= 0xff) {
+            writeHead(0xcc, value, 1);
+        } else if (value <= 0xffff) {
+            writeHead(0xcd, value, 2);
+        } else if (value <= 0xffffffff) {
+            writeHead(0xce, value, 4);
+        } else {
+            writeHead(0xcf, value, 8);
+        }
+    }
+
+    void writeInt(std::int64_t value)
+    {
+        auto bits = static_cast<std::uint64_t>(value);
+        if (value >= 0) {
+            writeUint(bits);
+        } else if (value >= -32) {
+            writeByte(static_cast<std::uint8_t>(bits));
+        } else if (value >= std::numeric_limits<std::int8_t>::min()) {
+            writeHead(0xd0, bits, 1);
+        } else if (value >= std::numeric_limits<std::int16_t>::min()) {
+            writeHead(0xd1, bits, 2);
+        } else if (value >= std::numeric_limits<std::int32_t>::min()) {
+            writeHead(0xd2, bits, 4);
+        } else {
+            writeHead(0xd3, bits, 8);
+        }
+    }
+
+    void writeFloat(double value)
+    {
+        if (fitsFloat(value)) {
+            writeHead(0xca, floatBits(static_cast<float>(value)), 4);
+        } else {
+            writeHead(0xcb, doubleBits(value), 8);
+        }
+    }
+
+    void writeStringHeader(std::uint64_t length)
+    {
+        if (length < 32) {
+            writeByte(static_cast<std::uint8_t>(0xa0 | length));
+        } else if (length <= 0xff) {
+            writeHead(0xd9, length, 1);
+        } else if (length <= 0xffff) {
+            writeHead(0xda, length, 2);
+        } else {
+            writeHead(0xdb, length, 4);
+        }
+    }
+
+    void writeBinaryHeader(std::uint64_t length)
+    {
+        if (length <= 0xff) {
+            writeHead(0xc4, length, 1);
+        } else if (length <= 0xffff) {
+            writeHead(0xc5, length, 2);
+        } else {
+            writeHead(0xc6, length, 4);
+        }
+    }
+
+    void writeArrayHeader(std::uint64_t length)
+    {
+        if (length < 16) {
+            writeByte(static_cast<std::uint8_t>(0x90 | length));
+        } else if (length <= 0xffff) {
+            writeHead(0xdc, length, 2);
+        } else {
+            writeHead(0xdd, length, 4);
+        }
+    }
+
+    void writeMapHeader(std::uint64_t length)
+    {
+        if (length < 16) {
+            writeByte(static_cast<std::uint8_t>(0x80 | length));
+        } else if (length <= 0xffff) {
+            writeHead(0xde, length, 2);
+        } else {
+            writeHead(0xdf, length, 4);
+        }
+    }
+
+    // Dates use the timestamp extension type (-1), in its smallest form.
+    void writeDate(double ms)
+    {
+        auto seconds = std::floor(ms / 1000);
+        auto nanos = static_cast<std::uint64_t>((ms - seconds * 1000) * 1e6);
+        auto secs = static_cast<std::int64_t>(seconds);
+        if (secs >= 0 && secs <= 0x3ffffffff) {
+            if (nanos == 0 && secs <= 0xffffffff) {
+                writeByte(0xd6);
+                writeByte(0xff);
+                appendBigEndian(_out, static_cast<std::uint64_t>(secs), 4);
+            } else {
+                writeByte(0xd7);
+                writeByte(0xff);
+                appendBigEndian(
+                    _out, (nanos << 34) | static_cast<std::uint64_t>(secs), 8);
+            }
+        } else {
+            writeByte(0xc7);
+            writeByte(12);
+            writeByte(0xff);
+            appendBigEndian(_out, nanos, 4);
+            appendBigEndian(_out, static_cast<std::uint64_t>(secs), 8);
+        }
+    }
+
+private:
+    void writeByte(std::uint8_t value)
+    {
+        _out.push_back(static_cast<char>(value));
+    }
+
+    void writeHead(std::uint8_t type, std::uint64_t value, int size)
+    {
+        writeByte(type);
+        appendBigEndian(_out, value, size);
+    }
+
+    std::string &_out;
+};
+
+class CborWriter
+{
+public:
+    static constexpr std::uint64_t MAX_LENGTH =
+        std::numeric_limits<std::uint64_t>::max();
+
+    explicit CborWriter(std::string &out)
+        : _out(out)
+    {
+    }
+
+    std::string &out()
+    {
+        return _out;
+    }
+
+    void writeNull()
+    {
+        writeByte(0xf6);
+    }
+
+    void writeUndefined()
+    {
+        writeByte(0xf7);
+    }
+
+    void writeBool(bool value)
+    {
+        writeByte(value ? 0xf5 : 0xf4);
+    }
+
+    void writeUint(std::uint64_t value)
+    {
+        writeHead(0, value);
+    }
+
+    void writeInt(std::int64_t value)
+    {
+        if (value >= 0) {
+            writeHead(0, static_cast<std::uint64_t>(value));
+        } else {
+            writeHead(1, static_cast<std::uint64_t>(-(value + 1)));
+        }
+    }
+
+    void writeFloat(double value)
+    {
+        if (fitsFloat(value)) {
+            writeByte(0xfa);
+            appendBigEndian(_out, floatBits(static_cast<float>(value)), 4);
+        } else {
+            writeByte(0xfb);
+            appendBigEndian(_out, doubleBits(value), 8);
+        }
+    }
+
+    void writeStringHeader(std::uint64_t length)
+    {
+        writeHead(3, length);
+    }
+
+    void writeBinaryHeader(std::uint64_t length)
+    {
+        writeHead(2, length);
+    }
+
+    void writeArrayHeader(std::uint64_t length)
+    {
+        writeHead(4, length);
+    }
+
+    void writeMapHeader(std::uint64_t length)
+    {
+        writeHead(5, length);
+    }
+
+    // Dates are stored as epoch-based seconds (tag 1), as an integer when
+    // they fall on a whole second.
+    void writeDate(double ms)
+    {
+        writeHead(6, 1);
+        if (std::fmod(ms, 1000) == 0) {
+            writeInt(static_cast<std::int64_t>(ms / 1000));
+        } else {
+            writeFloat(ms / 1000);
+        }
+    }
+
+private:
+    void writeByte(std::uint8_t value)
+    {
+        _out.push_back(static_cast<char>(value));
+    }
+
+    void writeHead(std::uint8_t major, std::uint64_t value)
+    {
+        auto type = static_cast<std::uint8_t>(major << 5);
+        if (value < 24) {
+            writeByte(static_cast<std::uint8_t>(type | value));
+        } else if (value <= 0xff) {
+            writeByte(type | 24);
+            appendBigEndian(_out, value, 1);
+        } else if (value <= 0xffff) {
+            writeByte(type | 25);
+            appendBigEndian(_out, value, 2);
+        } else if (value <= 0xffffffff) {
+            writeByte(type | 26);
+            appendBigEndian(_out, value, 4);
+        } else {
+            writeByte(type | 27);
+            appendBigEndian(_out, value, 8);
+        }
+    }
+
+    std::string &_out;
+};
+
+// Walks a JS value, writing it out through one of the writers above.  Every
+// N-API call costs a trip through V8's API layer, so the type of each value
+// is only looked up once, and plain objects and arrays are recognized before
+// trying the less common kinds of object.
+template <typename Writer>
+class BinaryEncoder
+{
+public:
+    BinaryEncoder(Napi::Env env, std::string &out)
+        : _env(env)
+        , _writer(out)
+        , _data(AddonData::fromEnv(env))
+    {
+    }
+
+    void encode(Napi::Value value)
+    {
+        // Shared with the JSON encoder, which sets it up.
+        _objectPrototype = _data->_objectPrototype.Value();
+        auto type = resolve(value, Napi::String::New(_env, ""), 0);
+        if (type == napi_undefined) {
+            _writer.writeUndefined();
+        } else if (isOmitted(type)) {
+            throw Napi::TypeError::New(
+                _env, std::string("Cannot encode a ") +
+                          (type == napi_symbol ? "symbol" : "function") +
+                          " value");
+        } else {
+            writeValue(value, type);
+        }
+    }
+
+private:
+    enum class ObjectKind { plain, array, binary, date, other };
+
+    static bool isOmitted(napi_valuetype type)
+    {
+        return type == napi_undefined || type == napi_function ||
+               type == napi_symbol;
+    }
+
+    napi_valuetype typeOf(napi_value value)
+    {
+        napi_valuetype type;
+        checkStatus(_env, napi_typeof(_env, value, &type));
+        return type;
+    }
+
+    ObjectKind kindOf(napi_value obj)
+    {
+        bool result;
+        checkStatus(_env, napi_is_array(_env, obj, &result));
+        if (result) {
+            return ObjectKind::array;
+        }
+
+        napi_value proto;
+        checkStatus(_env, napi_get_prototype(_env, obj, &proto));
+        checkStatus(_env,
+                    napi_strict_equals(_env, proto, _objectPrototype, &result));
+        if (result) {
+            return ObjectKind::plain;
+        }
+
+        checkStatus(_env, napi_is_typedarray(_env, obj, &result));
+        if (result) {
+            return ObjectKind::binary;
+        }
+        checkStatus(_env, napi_is_date(_env, obj, &result));
+        if (result) {
+            return ObjectKind::date;
+        }
+        checkStatus(_env, napi_is_arraybuffer(_env, obj, &result));
+        if (!result) {
+            checkStatus(_env, napi_is_dataview(_env, obj, &result));
+        }
+        return result ? ObjectKind::binary : ObjectKind::other;
+    }
+
+    // Replaces an object with the result of its toJSON, as JSON.stringify
+    // does, except for Dates and binary data, which have an encoding of their
+    // own.  The key is passed to toJSON, for array elements only the index is
+    // passed and the key is created if it is needed.  Returns the type of the
+    // resolved value, and for objects, the kind of object in _kind.
+    napi_valuetype resolve(Napi::Value &value, napi_value key,
+                           std::uint32_t index)
+    {
+        auto type = typeOf(value);
+        if (type != napi_object) {
+            return type;
+        }
+        _kind = kindOf(value);
+        if (_kind == ObjectKind::binary || _kind == ObjectKind::date) {
+            return type;
+        }
+
+        if (_toJSONKey == nullptr) {
+            _toJSONKey = Napi::String::New(_env, "toJSON");
+        }
+        auto toJSON = value.As<Napi::Object>().Get(_toJSONKey);
+        if (!toJSON.IsFunction()) {
+            return _kind == ObjectKind::other ? unbox(value) : type;
+        }
+        if (key == nullptr) {
+            key = Napi::String::New(_env, std::to_string(index));
+        }
+        value = toJSON.As<Napi::Function>().Call(value, {key});
+        type = typeOf(value);
+        if (type == napi_object) {
+            _kind = kindOf(value);
+            if (_kind == ObjectKind::other) {
+                type = unbox(value);
+            }
+        }
+        return type;
+    }
+
+    // Replaces a boxed primitive with the primitive, as JSON.stringify does,
+    // rather than encoding it as an empty map.  Numbers and strings are
+    // converted as JSON.stringify converts them, the others are unwrapped
+    // with the valueOf of their own prototype.
+    napi_valuetype unbox(Napi::Value &value)
+    {
+        napi_value proto;
+        checkStatus(_env, napi_get_prototype(_env, value, &proto));
+        auto isProto = [this, proto](const Napi::ObjectReference &ref) {
+            bool result;
+            checkStatus(_env,
+                        napi_strict_equals(_env, proto, ref.Value(), &result));
+            return result;
+        };
+
+        napi_value result;
+        if (isProto(_data->_numberPrototype)) {
+            checkStatus(_env, napi_coerce_to_number(_env, value, &result));
+        } else if (isProto(_data->_stringPrototype)) {
+            checkStatus(_env, napi_coerce_to_string(_env, value, &result));
+        } else if (isProto(_data->_booleanPrototype) ||
+                   isProto(_data->_bigIntPrototype)) {
+            auto valueOf = Napi::Object(_env, proto).Get("valueOf");
+            result = valueOf.As<Napi::Function>().Call(value, {});
+        } else {
+            return napi_object;
+        }
+        value = Napi::Value(_env, result);
+        return typeOf(value);
+    }
+
+    void writeValue(Napi::Value value, napi_valuetype type)
+    {
+        switch (type) {
+        case napi_null:
+            _writer.writeNull();
+            return;
+        case napi_boolean:
+            _writer.writeBool(value.As<Napi::Boolean>().Value());
+            return;
+        case napi_number:
+            writeNumber(value.As<Napi::Number>().DoubleValue());
+            return;
+        case napi_string:
+            writeString(value);
+            return;
+        case napi_bigint:
+            writeBigInt(value.As<Napi::BigInt>());
+            return;
+        case napi_object:
+            writeObject(value.As<Napi::Object>(), _kind);
+            return;
+        default:
+            throw Napi::TypeError::New(_env, "Cannot encode an external value");
+        }
+    }
+
+    void writeNumber(double value)
+    {
+        if (std::trunc(value) == value &&
+            std::fabs(value) <= MAX_SAFE_INTEGER &&
+            !(value == 0 && std::signbit(value))) {
+            _writer.writeInt(static_cast<std::int64_t>(value));
+        } else {
+            _writer.writeFloat(value);
+        }
+    }
+
+    void writeBigInt(Napi::BigInt value)
+    {
+        bool lossless;
+        auto signedValue = value.Int64Value(&lossless);
+        if (lossless) {
+            _writer.writeInt(signedValue);
+            return;
+        }
+        auto unsignedValue = value.Uint64Value(&lossless);
+        if (lossless) {
+            _writer.writeUint(unsignedValue);
+            return;
+        }
+        throw Napi::RangeError::New(
+            _env, "Cannot encode a BigInt which does not fit in 64 bits");
+    }
+
+    // Most strings (and nearly all keys) are short, and are copied out with
+    // a single call.  As a copy stops short of a character which does not
+    // fit, it can only have been cut short if it came within the size of the
+    // largest character (4 bytes) of filling the scratch space.
+    void writeString(napi_value value)
+    {
+        std::size_t len;
+        checkStatus(_env,
+                    napi_get_value_string_utf8(_env, value, _shortString,
+                                               sizeof(_shortString), &len));
+        if (len + 4 < sizeof(_shortString)) {
+            _writer.writeStringHeader(len);
+            _writer.out().append(_shortString, len);
+            return;
+        }
+
+        checkStatus(_env,
+                    napi_get_value_string_utf8(_env, value, nullptr, 0, &len));
+        checkLength(len);
+        _writer.writeStringHeader(len);
+
+        auto &out = _writer.out();
+        auto offset = out.size();
+        out.resize(offset + len + 1);
+        checkStatus(_env, napi_get_value_string_utf8(_env, value, &out[offset],
+                                                     len + 1, &len));
+        out.resize(offset + len);
+    }
+
+    void writeBinary(const void *data, std::size_t len)
+    {
+        checkLength(len);
+        _writer.writeBinaryHeader(len);
+        if (len > 0) {
+            _writer.out().append(static_cast<const char *>(data), len);
+        }
+    }
+
+    void writeObject(Napi::Object obj, ObjectKind kind)
+    {
+        switch (kind) {
+        case ObjectKind::array:
+            writeArray(obj.As<Napi::Array>());
+            return;
+        case ObjectKind::binary:
+            writeBinaryObject(obj);
+            return;
+        case ObjectKind::date: {
+            auto ms = obj.As<Napi::Date>().ValueOf();
+            if (std::isfinite(ms)) {
+                _writer.writeDate(ms);
+            } else {
+                _writer.writeNull();
+            }
+            return;
+        }
+        default:
+            writeMap(obj);
+            return;
+        }
+    }
+
+    void writeBinaryObject(Napi::Object obj)
+    {
+        if (obj.IsTypedArray()) {
+            auto view = obj.As<Napi::TypedArray>();
+            writeBinary(static_cast<const char *>(view.ArrayBuffer().Data()) +
+                            view.ByteOffset(),
+                        view.ByteLength());
+        } else if (obj.IsArrayBuffer()) {
+            auto buffer = obj.As<Napi::ArrayBuffer>();
+            writeBinary(buffer.Data(), buffer.ByteLength());
+        } else {
+            auto view = obj.As<Napi::DataView>();
+            writeBinary(static_cast<const char *>(view.ArrayBuffer().Data()) +
+                            view.ByteOffset(),
+                        view.ByteLength());
+        }
+    }
+
+    void enter(Napi::Object obj)
+    {
+        if (_stack.size() >= MAX_DEPTH) {
+            throw Napi::RangeError::New(_env,
+                                        "Value is nested too deeply to encode");
+        }
+        for (const auto &parent : _stack) {
+            if (obj.StrictEquals(Napi::Value(_env, parent))) {
+                throw Napi::TypeError::New(
+                    _env, "Cannot encode a circular structure");
+            }
+        }
+        _stack.push_back(obj);
+    }
+
+    void leave()
+    {
+        _stack.pop_back();
+    }
+
+    void writeArray(Napi::Array arr)
+    {
+        enter(arr);
+        auto length = arr.Length();
+        _writer.writeArrayHeader(length);
+        for (std::uint32_t i = 0; i < length; ++i) {
+            auto value = arr.Get(i);
+            auto type = resolve(value, nullptr, i);
+            if (isOmitted(type)) {
+                _writer.writeNull();
+            } else {
+                writeValue(value, type);
+            }
+        }
+        leave();
+    }
+
+    void writeMap(Napi::Object obj)
+    {
+        enter(obj);
+
+        // The same keys, in the same order, as Object.keys().
+        napi_value keys;
+        checkStatus(_env, napi_get_all_property_names(
+                              _env, obj, napi_key_own_only,
+                              static_cast<napi_key_filter>(
+                                  napi_key_enumerable | napi_key_skip_symbols),
+                              napi_key_numbers_to_strings, &keys));
+        auto jsKeys = Napi::Array(_env, keys);
+
+        // The map header needs the number of members, so the omitted ones
+        // are filtered out first.  Nested maps push their members after ours
+        // and truncate them again before we get to write ours.
+        auto first = _members.size();
+        auto length = jsKeys.Length();
+        for (std::uint32_t i = 0; i < length; ++i) {
+            auto key = jsKeys.Get(i);
+            auto value = obj.Get(key);
+            auto type = resolve(value, key, 0);
+            if (!isOmitted(type)) {
+                _members.push_back({key, value, type, _kind});
+            }
+        }
+
+        auto last = _members.size();
+        _writer.writeMapHeader(last - first);
+        for (auto i = first; i < last; ++i) {
+            auto member = _members[i];
+            writeString(member.key);
+            _kind = member.kind;
+            writeValue(Napi::Value(_env, member.value), member.type);
+        }
+        _members.resize(first);
+        leave();
+    }
+
+    void checkLength(std::size_t len)
+    {
+        if (static_cast<std::uint64_t>(len) > Writer::MAX_LENGTH) {
+            throw Napi::RangeError::New(_env, "Value is too large to encode");
+        }
+    }
+
+    struct Member {
+        napi_value key;
+        napi_value value;
+        napi_valuetype type;
+        ObjectKind kind;
+    };
+
+    Napi::Env _env;
+    Writer _writer;
+    AddonData *_data;
+    napi_value _objectPrototype = nullptr;
+    napi_value _toJSONKey = nullptr;
+    ObjectKind _kind = ObjectKind::other;
+    std::vector<napi_value> _stack;
+    std::vector<Member> _members;
+    char _shortString[128];
+};
+
+// Helpers shared by the decoders for reading the input and building values.
+class BinaryReader
+{
+protected:
+    BinaryReader(Napi::Env env, const char *data, std::size_t size,
+                 const char *format)
+        : _env(env)
+        , _pos(data)
+        , _end(data + size)
+        , _format(format)
+        , _data(AddonData::fromEnv(env))
+    {
+    }
+
+    [[noreturn]] void fail(const char *reason)
+    {
+        throw Napi::Error::New(_env, std::string("Invalid ") + _format +
+                                         " data: " + reason);
+    }
+
+    void need(std::uint64_t size)
+    {
+        if (static_cast<std::uint64_t>(_end - _pos) < size) {
+            fail("unexpected end of input");
+        }
+    }
+
+    std::uint8_t readByte()
+    {
+        need(1);
+        return static_cast<std::uint8_t>(*_pos++);
+    }
+
+    std::uint8_t peekByte()
+    {
+        need(1);
+        return static_cast<std::uint8_t>(*_pos);
+    }
+
+    std::uint64_t readBigEndian(int size)
+    {
+        need(size);
+        std::uint64_t value = 0;
+        for (int i = 0; i < size; ++i) {
+            value = (value << 8) | static_cast<std::uint8_t>(*_pos++);
+        }
+        return value;
+    }
+
+    double readFloat()
+    {
+        auto bits = static_cast<std::uint32_t>(readBigEndian(4));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double readDouble()
+    {
+        auto bits = readBigEndian(8);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    const char *readBytes(std::uint64_t size)
+    {
+        need(size);
+        auto bytes = _pos;
+        _pos += size;
+        return bytes;
+    }
+
+    // Guards the preallocation of containers against lengths which the
+    // remaining input could never satisfy.
+    void checkCount(std::uint64_t count, std::uint64_t minItemSize)
+    {
+        if (count > static_cast<std::uint64_t>(_end - _pos) / minItemSize) {
+            fail("unexpected end of input");
+        }
+        if (count > std::numeric_limits<std::uint32_t>::max()) {
+            fail("too many items");
+        }
+    }
+
+    void checkDepth(std::size_t depth)
+    {
+        if (depth >= MAX_DEPTH) {
+            fail("nested too deeply");
+        }
+    }
+
+    Napi::Value makeUnsigned(std::uint64_t value)
+    {
+        if (value <= MAX_SAFE_UINT) {
+            return Napi::Number::New(_env, static_cast<double>(value));
+        }
+        return Napi::BigInt::New(_env, value);
+    }
+
+    Napi::Value makeSigned(std::int64_t value)
+    {
+        if (value >= -static_cast<std::int64_t>(MAX_SAFE_UINT) &&
+            value <= static_cast<std::int64_t>(MAX_SAFE_UINT)) {
+            return Napi::Number::New(_env, static_cast<double>(value));
+        }
+        return Napi::BigInt::New(_env, value);
+    }
+
+    Napi::Value makeString(const char *data, std::size_t len)
+    {
+        return Napi::String::New(_env, data, len);
+    }
+
+    Napi::Value makeBinary(const char *data, std::size_t len)
+    {
+        return Napi::Buffer<char>::Copy(_env, data, len);
+    }
+
+    // Keys tend to repeat throughout a document (every element of an array
+    // of records has the same ones), so the strings created for short keys
+    // are remembered for the rest of the decode.
+    napi_value makeKey(const char *data, std::size_t len)
+    {
+        if (len > MAX_CACHED_KEY_LENGTH) {
+            return makeString(data, len);
+        }
+
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < len; ++i) {
+            hash = (hash ^ static_cast<std::uint8_t>(data[i])) * 16777619u;
+        }
+        auto &entry = _keys[hash % KEY_CACHE_SIZE];
+        if (entry.value != nullptr && entry.len == len &&
+            std::memcmp(entry.data, data, len) == 0) {
+            return entry.value;
+        }
+        entry = {data, len, makeString(data, len)};
+        return entry.value;
+    }
+
+    // Map keys which are not strings must be numbers, and are converted to
+    // strings as they would be by a property set.
+    napi_value makeKey(Napi::Value key)
+    {
+        if (!key.IsString() && !key.IsNumber()) {
+            fail("map keys must be strings or numbers");
+        }
+        return key.ToString();
+    }
+
+    // Members are collected as the map is read and then defined together,
+    // which takes one call per map rather than one per member.  Defining
+    // them creates own properties, as JSON.parse does, where a plain set of
+    // "__proto__" would replace the prototype of the object.  Nested maps
+    // push their members after ours and truncate them again when done.
+    std::size_t beginMap()
+    {
+        return _members.size();
+    }
+
+    void addMember(napi_value key, napi_value value)
+    {
+        napi_property_descriptor desc = {};
+        desc.name = key;
+        desc.value = value;
+        desc.attributes = static_cast<napi_property_attributes>(
+            napi_writable | napi_enumerable | napi_configurable);
+        _members.push_back(desc);
+    }
+
+    Napi::Value endMap(std::size_t first)
+    {
+        auto obj = Napi::Object::New(_env);
+        if (_members.size() > first) {
+            checkStatus(_env, napi_define_properties(_env, obj,
+                                                     _members.size() - first,
+                                                     &_members[first]));
+        }
+        _members.resize(first);
+        return obj;
+    }
+
+    // Elements are collected in the same way, and arrays are created with a
+    // single call to Array.of, rather than with one call per element, unless
+    // they are too long to pass as arguments.
+    std::size_t beginArray()
+    {
+        return _elements.size();
+    }
+
+    void addElement(napi_value value)
+    {
+        _elements.push_back(value);
+    }
+
+    Napi::Value endArray(std::size_t first)
+    {
+        auto length = _elements.size() - first;
+        napi_value arr;
+        if (length <= MAX_ARRAY_OF_LENGTH) {
+            auto arrayOf = _data->_arrayOf.Value();
+            checkStatus(_env,
+                        napi_call_function(_env, arrayOf, arrayOf, length,
+                                           _elements.data() + first, &arr));
+        } else {
+            checkStatus(_env,
+                        napi_create_array_with_length(_env, length, &arr));
+            for (std::size_t i = 0; i < length; ++i) {
+                checkStatus(_env, napi_set_element(
+                                      _env, arr, static_cast<std::uint32_t>(i),
+                                      _elements[first + i]));
+            }
+        }
+        _elements.resize(first);
+        return Napi::Value(_env, arr);
+    }
+
+    bool atEnd() const
+    {
+        return _pos == _end;
+    }
+
+    Napi::Env _env;
+    const char *_pos;
+    const char *_end;
+    const char *_format;
+
+private:
+    static constexpr std::size_t MAX_CACHED_KEY_LENGTH = 64;
+    static constexpr std::size_t KEY_CACHE_SIZE = 64;
+
+    struct CachedKey {
+        const char *data;
+        std::size_t len;
+        napi_value value;
+    };
+
+    static constexpr std::size_t MAX_ARRAY_OF_LENGTH = 4096;
+
+    AddonData *_data;
+    CachedKey _keys[KEY_CACHE_SIZE] = {};
+    std::vector<napi_property_descriptor> _members;
+    std::vector<napi_value> _elements;
+};
+
+class MsgpackDecoder : private BinaryReader
+{
+public:
+    MsgpackDecoder(Napi::Env env, const char *data, std::size_t size)
+        : BinaryReader(env, data, size, "MessagePack")
+    {
+    }
+
+    Napi::Value decode()
+    {
+        auto value = readValue(0);
+        if (!atEnd()) {
+            fail("unexpected data after the value");
+        }
+        return value;
+    }
+
+private:
+    Napi::Value readValue(std::size_t depth)
+    {
+        auto type = readByte();
+        if (type <= 0x7f) {
+            return Napi::Number::New(_env, type);
+        }
+        if (type >= 0xe0) {
+            return Napi::Number::New(_env, static_cast<std::int8_t>(type));
+        }
+        if (type <= 0x8f) {
+            return readMap(type & 0x0f, depth);
+        }
+        if (type <= 0x9f) {
+            return readArray(type & 0x0f, depth);
+        }
+        if (type <= 0xbf) {
+            return readString(type & 0x1f);
+        }
+
+        switch (type) {
+        case 0xc0:
+            return _env.Null();
+        case 0xc2:
+            return Napi::Boolean::New(_env, false);
+        case 0xc3:
+            return Napi::Boolean::New(_env, true);
+        case 0xc4:
+        case 0xc5:
+        case 0xc6: {
+            auto len = readBigEndian(1 << (type - 0xc4));
+            return makeBinary(readBytes(len), len);
+        }
+        case 0xc7:
+        case 0xc8:
+        case 0xc9:
+            return readExtension(readBigEndian(1 << (type - 0xc7)));
+        case 0xca:
+            return Napi::Number::New(_env, readFloat());
+        case 0xcb:
+            return Napi::Number::New(_env, readDouble());
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+            return makeUnsigned(readBigEndian(1 << (type - 0xcc)));
+        case 0xd0:
+            return makeSigned(static_cast<std::int8_t>(readBigEndian(1)));
+        case 0xd1:
+            return makeSigned(static_cast<std::int16_t>(readBigEndian(2)));
+        case 0xd2:
+            return makeSigned(static_cast<std::int32_t>(readBigEndian(4)));
+        case 0xd3:
+            return makeSigned(static_cast<std::int64_t>(readBigEndian(8)));
+        case 0xd4:
+        case 0xd5:
+        case 0xd6:
+        case 0xd7:
+        case 0xd8:
+            return readExtension(1 << (type - 0xd4));
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+            return readString(readBigEndian(1 << (type - 0xd9)));
+        case 0xdc:
+        case 0xdd:
+            return readArray(readBigEndian(type == 0xdc ? 2 : 4), depth);
+        case 0xde:
+        case 0xdf:
+            return readMap(readBigEndian(type == 0xde ? 2 : 4), depth);
+        default:
+            fail("unknown type");
+        }
+    }
+
+    Napi::Value readString(std::uint64_t len)
+    {
+        return makeString(readBytes(len), len);
+    }
+
+    // Only the timestamp extension type is understood.
+    Napi::Value readExtension(std::uint64_t len)
+    {
+        auto type = static_cast<std::int8_t>(readByte());
+        need(len);
+        if (type != -1) {
+            fail("unsupported extension type");
+        }
+
+        std::uint64_t nanos = 0;
+        std::int64_t secs;
+        if (len == 4) {
+            secs = static_cast<std::int64_t>(readBigEndian(4));
+        } else if (len == 8) {
+            auto value = readBigEndian(8);
+            nanos = value >> 34;
+            secs = static_cast<std::int64_t>(value & 0x3ffffffff);
+        } else if (len == 12) {
+            nanos = readBigEndian(4);
+            secs = static_cast<std::int64_t>(readBigEndian(8));
+        } else {
+            fail("invalid timestamp");
+        }
+        if (nanos > 999999999) {
+            fail("invalid timestamp");
+        }
+        return Napi::Date::New(_env, static_cast<double>(secs) * 1000 +
+                                         static_cast<double>(nanos) / 1e6);
+    }
+
+    Napi::Value readArray(std::uint64_t length, std::size_t depth)
+    {
+        checkDepth(depth);
+        checkCount(length, 1);
+        auto first = beginArray();
+        for (std::uint64_t i = 0; i < length; ++i) {
+            addElement(readValue(depth + 1));
+        }
+        return endArray(first);
+    }
+
+    Napi::Value readMap(std::uint64_t length, std::size_t depth)
+    {
+        checkDepth(depth);
+        checkCount(length, 2);
+        auto first = beginMap();
+        for (std::uint64_t i = 0; i < length; ++i) {
+            std::uint64_t keyLen;
+            napi_value key;
+            if (readStringHeader(keyLen)) {
+                key = makeKey(readBytes(keyLen), keyLen);
+            } else {
+                key = makeKey(readValue(depth + 1));
+            }
+            addMember(key, readValue(depth + 1));
+        }
+        return endMap(first);
+    }
+
+    // Reads the header of a string, if a string is next.
+    bool readStringHeader(std::uint64_t &len)
+    {
+        auto type = peekByte();
+        if (type >= 0xa0 && type <= 0xbf) {
+            ++_pos;
+            len = type & 0x1f;
+            return true;
+        }
+        if (type >= 0xd9 && type <= 0xdb) {
+            ++_pos;
+            len = readBigEndian(1 << (type - 0xd9));
+            return true;
+        }
+        return false;
+    }
+};
+
+class CborDecoder : private BinaryReader
+{
+public:
+    CborDecoder(Napi::Env env, const char *data, std::size_t size)
+        : BinaryReader(env, data, size, "CBOR")
+    {
+    }
+
+    Napi::Value decode()
+    {
+        auto value = readValue(0);
+        if (!atEnd()) {
+            fail("unexpected data after the value");
+        }
+        return value;
+    }
+
+private:
+    static constexpr std::uint8_t INDEFINITE = 31;
+    static constexpr std::uint8_t BREAK = 0xff;
+
+    Napi::Value readValue(std::size_t depth)
+    {
+        auto initial = readByte();
+        auto major = initial >> 5;
+        auto info = static_cast<std::uint8_t>(initial & 0x1f);
+        if (major == 7) {
+            return readSimple(info);
+        }
+
+        if (info == INDEFINITE) {
+            switch (major) {
+            case 2:
+                readChunks(2);
+                return makeBinary(_scratch.data(), _scratch.size());
+            case 3:
+                readChunks(3);
+                return makeString(_scratch.data(), _scratch.size());
+            case 4:
+                return readIndefiniteArray(depth);
+            case 5:
+                return readIndefiniteMap(depth);
+            default:
+                fail("invalid indefinite length");
+            }
+        }
+
+        auto arg = readArgument(info);
+        switch (major) {
+        case 0:
+            return makeUnsigned(arg);
+        case 1:
+            return makeNegative(arg);
+        case 2:
+            return makeBinary(readBytes(arg), arg);
+        case 3:
+            return makeString(readBytes(arg), arg);
+        case 4:
+            return readArray(arg, depth);
+        case 5:
+            return readMap(arg, depth);
+        default:
+            return readTagged(arg, depth);
+        }
+    }
+
+    std::uint64_t readArgument(std::uint8_t info)
+    {
+        if (info < 24) {
+            return info;
+        }
+        if (info <= 27) {
+            return readBigEndian(1 << (info - 24));
+        }
+        fail("invalid additional information");
+    }
+
+    // Returns -1 - value.
+    Napi::Value makeNegative(std::uint64_t value)
+    {
+        if (value < MAX_SAFE_UINT) {
+            return Napi::Number::New(_env, -1 - static_cast<double>(value));
+        }
+        if (value <= static_cast<std::uint64_t>(
+                         std::numeric_limits<std::int64_t>::max())) {
+            return Napi::BigInt::New(_env,
+                                     -1 - static_cast<std::int64_t>(value));
+        }
+        std::uint64_t words[2] = {value + 1, value + 1 == 0 ? 1u : 0u};
+        return Napi::BigInt::New(_env, 1, words[1] ? 2 : 1, words);
+    }
+
+    // Concatenates the chunks of an indefinite length string into _scratch.
+    void readChunks(int major)
+    {
+        _scratch.clear();
+        while (peekByte() != BREAK) {
+            auto initial = readByte();
+            if ((initial >> 5) != major || (initial & 0x1f) == INDEFINITE) {
+                fail("invalid indefinite length string chunk");
+            }
+            auto len = readArgument(initial & 0x1f);
+            _scratch.append(readBytes(len), len);
+        }
+        ++_pos;
+    }
+
+    Napi::Value readSimple(std::uint8_t info)
+    {
+        switch (info) {
+        case 20:
+            return Napi::Boolean::New(_env, false);
+        case 21:
+            return Napi::Boolean::New(_env, true);
+        case 22:
+            return _env.Null();
+        case 23:
+            return _env.Undefined();
+        case 25:
+            return Napi::Number::New(
+                _env, decodeHalf(static_cast<std::uint16_t>(readBigEndian(2))));
+        case 26:
+            return Napi::Number::New(_env, readFloat());
+        case 27:
+            return Napi::Number::New(_env, readDouble());
+        case INDEFINITE:
+            fail("unexpected break");
+        default:
+            fail("unsupported simple value");
+        }
+    }
+
+    static double decodeHalf(std::uint16_t half)
+    {
+        int exponent = (half >> 10) & 0x1f;
+        int mantissa = half & 0x3ff;
+        double value;
+        if (exponent == 0) {
+            value = std::ldexp(mantissa, -24);
+        } else if (exponent != 31) {
+            value = std::ldexp(mantissa + 1024, exponent - 25);
+        } else {
+            value = mantissa == 0 ? std::numeric_limits<double>::infinity()
+                                  : std::numeric_limits<double>::quiet_NaN();
+        }
+        return (half & 0x8000) ? -value : value;
+    }
+
+    Napi::Value readArray(std::uint64_t length, std::size_t depth)
+    {
+        checkDepth(depth);
+        checkCount(length, 1);
+        auto first = beginArray();
+        for (std::uint64_t i = 0; i < length; ++i) {
+            addElement(readValue(depth + 1));
+        }
+        return endArray(first);
+    }
+
+    Napi::Value readIndefiniteArray(std::size_t depth)
+    {
+        checkDepth(depth);
+        auto first = beginArray();
+        while (peekByte() != BREAK) {
+            addElement(readValue(depth + 1));
+        }
+        ++_pos;
+        return endArray(first);
+    }
+
+    Napi::Value readMap(std::uint64_t length, std::size_t depth)
+    {
+        checkDepth(depth);
+        checkCount(length, 2);
+        auto first = beginMap();
+        for (std::uint64_t i = 0; i < length; ++i) {
+            readMember(depth);
+        }
+        return endMap(first);
+    }
+
+    Napi::Value readIndefiniteMap(std::size_t depth)
+    {
+        checkDepth(depth);
+        auto first = beginMap();
+        while (peekByte() != BREAK) {
+            readMember(depth);
+        }
+        ++_pos;
+        return endMap(first);
+    }
+
+    void readMember(std::size_t depth)
+    {
+        auto initial = peekByte();
+        napi_value key;
+        if ((initial >> 5) == 3 && (initial & 0x1f) != INDEFINITE) {
+            ++_pos;
+            auto keyLen = readArgument(initial & 0x1f);
+            key = makeKey(readBytes(keyLen), keyLen);
+        } else {
+            key = makeKey(readValue(depth + 1));
+        }
+        addMember(key, readValue(depth + 1));
+    }
+
+    // Date/time strings and epoch-based dates become Dates, and bignums
+    // become BigInts.  Any other tag is ignored.
+    Napi::Value readTagged(std::uint64_t tag, std::size_t depth)
+    {
+        checkDepth(depth);
+        if (tag == 2 || tag == 3) {
+            return readBignum(tag == 3);
+        }
+
+        auto value = readValue(depth + 1);
+        if (tag == 0) {
+            if (!value.IsString()) {
+                fail("invalid date/time string");
+            }
+            return _env.Global()
+                .Get("Date")
+                .As<Napi::Function>()
+                .New({value});
+        }
+        if (tag == 1) {
+            if (!value.IsNumber()) {
+                fail("invalid epoch-based date/time");
+            }
+            auto seconds = value.As<Napi::Number>().DoubleValue();
+            return Napi::Date::New(_env, std::round(seconds * 1000));
+        }
+        return value;
+    }
+
+    Napi::Value readBignum(bool negative)
+    {
+        auto initial = readByte();
+        if ((initial >> 5) != 2 || (initial & 0x1f) == INDEFINITE) {
+            fail("invalid bignum");
+        }
+        auto len = readArgument(initial & 0x1f);
+        auto bytes = reinterpret_cast<const std::uint8_t *>(readBytes(len));
+        while (len > 0 && *bytes == 0) {
+            ++bytes;
+            --len;
+        }
+
+        // The big endian bytes become little endian words, for a negative
+        // bignum the value is -1 - n, so n + 1 is stored with the sign bit.
+        std::vector<std::uint64_t> words((len + 7) / 8 + 1, 0);
+        for (std::uint64_t i = 0; i < len; ++i) {
+            words[i / 8] |= static_cast<std::uint64_t>(bytes[len - 1 - i])
+                            << ((i % 8) * 8);
+        }
+        if (negative) {
+            for (auto &word : words) {
+                if (++word != 0) {
+                    break;
+                }
+            }
+        }
+        while (words.size() > 1 && words.back() == 0) {
+            words.pop_back();
+        }
+        return Napi::BigInt::New(_env, negative ? 1 : 0, words.size(),
+                                 words.data());
+    }
+
+    std::string _scratch;
+};
+
+void BinaryTranscoders::Init(Napi::Env env, Napi::Object exports)
+{
+    auto data = AddonData::fromEnv(env);
+    data->_arrayOf = Napi::Persistent(env.Global()
+                                          .Get("Array")
+                                          .As<Napi::Object>()
+                                          .Get("of")
+                                          .As<Napi::Function>());
+
+    auto prototypeOf = [&env](const char *name) {
+        return Napi::Persistent(env.Global()
+                                    .Get(name)
+                                    .As<Napi::Object>()
+                                    .Get("prototype")
+                                    .As<Napi::Object>());
+    };
+    data->_numberPrototype = prototypeOf("Number");
+    data->_stringPrototype = prototypeOf("String");
+    data->_booleanPrototype = prototypeOf("Boolean");
+    data->_bigIntPrototype = prototypeOf("BigInt");
+
+    exports.Set("msgpackEncode", Napi::Function::New<jsMsgpackEncode>(env));
+    exports.Set("msgpackDecode", Napi::Function::New<jsMsgpackDecode>(env));
+    exports.Set("cborEncode", Napi::Function::New<jsCborEncode>(env));
+    exports.Set("cborDecode", Napi::Function::New<jsCborDecode>(env));
+}
+
+template <typename Writer>
+static Napi::Value encodeWith(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    ScratchBuffer buffer;
+    BinaryEncoder<Writer> encoder(env, buffer.get());
+    encoder.encode(info[0]);
+    return Napi::Buffer<char>::Copy(env, buffer.get().data(),
+                                    buffer.get().size());
+}
+
+template <typename Decoder>
+static Napi::Value decodeWith(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    if (!info[0].IsBuffer()) {
+        throw Napi::TypeError::New(env, "Expected a Buffer to decode");
+    }
+
+    auto bytes = info[0].As<Napi::Buffer<char>>();
+    Decoder decoder(env, bytes.Data(), bytes.Length());
+    return decoder.decode();
+}
+
+Napi::Value BinaryTranscoders::jsMsgpackEncode(const Napi::CallbackInfo &info)
+{
+    return encodeWith<MsgpackWriter>(info);
+}
+
+Napi::Value BinaryTranscoders::jsMsgpackDecode(const Napi::CallbackInfo &info)
+{
+    return decodeWith<MsgpackDecoder>(info);
+}
+
+Napi::Value BinaryTranscoders::jsCborEncode(const Napi::CallbackInfo &info)
+{
+    return encodeWith<CborWriter>(info);
+}
+
+Napi::Value BinaryTranscoders::jsCborDecode(const Napi::CallbackInfo &info)
+{
+    return decodeWith<CborDecoder>(info);
+}
+
+} // namespace couchnode
@@ -0,0 +1,30 @@
+#pragma once
+#include <napi.h>
+
+namespace couchnode
+{
+
+// Native MessagePack and CBOR encoding for the MsgpackTranscoder and the
+// CborTranscoder.  Values are serialized straight from V8 and decoded
+// straight into V8 values.
+//
+// Both formats map JS values the same way: numbers are stored as integers
+// when they are integral (and as the smaller of a float32 or float64
+// otherwise), Buffers and other binary views as byte strings which decode to
+// Buffers, Dates as timestamps, and BigInts as 64-bit integers.  Integers
+// outside of the safe integer range decode to BigInts.  Objects are treated
+// as JSON.stringify would treat them: toJSON is honoured, only own
+// enumerable string keys are stored, and members which are undefined,
+// functions or symbols are omitted.  Invalid input throws.
+class BinaryTranscoders
+{
+public:
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    static Napi::Value jsMsgpackEncode(const Napi::CallbackInfo &info);
+    static Napi::Value jsMsgpackDecode(const Napi::CallbackInfo &info);
+    static Napi::Value jsCborEncode(const Napi::CallbackInfo &info);
+    static Napi::Value jsCborDecode(const Napi::CallbackInfo &info);
+};
+
+} // namespace couchnode
@@ -1,11 +1,16 @@
 #include "addondata.hpp"
+#include "binary_transcoders.hpp"
 #include "cas.hpp"
 #include "connection.hpp"
 #include "constants.hpp"
+#include "json_transcoder.hpp"
 #include "mutationtoken.hpp"
+#include "operation_meter.hpp"
 #include "scan_iterator.hpp"
+#include "threshold_logging.hpp"
 #include "transaction.hpp"
 #include "transactions.hpp"
+#include "value_compression.hpp"
 #include <core/logger/configuration.hxx>
 #include <core/meta/version.hxx>
 #include <napi.h>
@@ -84,6 +89,11 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
     Transactions::Init(env, exports);
     Transaction::Init(env, exports);
     ScanIterator::Init(env, exports);
+    OperationMeter::Init(env, exports);
+    ThresholdLogger::Init(env, exports);
+    JsonTranscoder::Init(env, exports);
+    BinaryTranscoders::Init(env, exports);
+    ValueCompression::Init(env, exports);
 
     exports.Set(Napi::String::New(env, "cbppVersion"),
                 Napi::String::New(env, "1.0.0-beta"));
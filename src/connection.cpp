@@ -16,18 +16,23 @@ namespace couchnode
 {
 
 void jscbForward(Napi::Env env, Napi::Function callback, std::nullptr_t *,
-                 FwdFunc *fn)
+                 CallCookieCompletion *completion)
 {
+    COUCHNODE_PROBE1(cookie__dispatch, completion);
+    if (completion->stats) {
+        completion->stats->completionDispatched(completion->queuedAt);
+    }
+
     if (env == nullptr || callback == nullptr) {
-        delete fn;
+        delete completion;
         return;
     }
 
     try {
-        (*fn)(env, callback);
+        completion->fn(env, callback);
     } catch (const Napi::Error &e) {
     }
-    delete fn;
+    delete completion;
 }
 
 void Connection::Init(Napi::Env env, Napi::Object exports)
@@ -44,6 +49,16 @@ void Connection::Init(Napi::Env env, Napi::Object exports)
             InstanceMethod<&Connection::jsPing>("ping"),
             InstanceMethod<&Connection::jsScan>("scan"),
             InstanceMethod<&Connection::jsGetClusterLabels>("getClusterLabels"),
+            InstanceMethod<&Connection::jsSetThresholdLogger>(
+                "setThresholdLogger"),
+            InstanceMethod<&Connection::jsSetOperationMeter>(
+                "setOperationMeter"),
+            InstanceMethod<&Connection::jsStats>("stats"),
+            InstanceMethod<&Connection::jsNodeStats>("nodeStats"),
+            InstanceMethod<&Connection::jsGetAllReplicasStream>(
+                "getAllReplicasStream"),
+            InstanceMethod<&Connection::jsLookupInAllReplicasStream>(
+                "lookupInAllReplicasStream"),
 
             //#region Autogenerated Method Registration
 
@@ -271,6 +286,8 @@ Connection::Connection(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<Connection>(info)
 {
     _instance = new Instance();
+    _stats = std::make_shared<ConnectionStats>();
+    _nodeStats = std::make_shared<NodeStats>();
 }
 
 Connection::~Connection()
@@ -510,6 +527,28 @@ Napi::Value Connection::jsPing(const Napi::CallbackInfo &info)
     return info.Env().Null();
 }
 
+tl::expected<couchbase::core::agent, std::error_code>
+Connection::scanAgent(const std::string &bucketName)
+{
+    // The agent group is only ever touched from the JS thread, so we lazily
+    // create it once and reuse the per-bucket agents across scans.
+    if (!_agentGroup.has_value()) {
+        _agentGroup.emplace(
+            this->_instance->_io,
+            couchbase::core::agent_group_config{{this->_instance->_cluster}});
+    }
+
+    auto agent = _agentGroup->get_agent(bucketName);
+    if (agent.has_value()) {
+        return agent;
+    }
+
+    if (auto ec = _agentGroup->open_bucket(bucketName); ec) {
+        return tl::unexpected(ec);
+    }
+    return _agentGroup->get_agent(bucketName);
+}
+
 Napi::Value Connection::jsScan(const Napi::CallbackInfo &info)
 {
     auto bucketName = info[0].ToString().Utf8Value();
@@ -518,40 +557,47 @@ Napi::Value Connection::jsScan(const Napi::CallbackInfo &info)
     auto scanTypeName = info[3].ToString().Utf8Value();
     // scanType handled below
     auto optionsObj = info[5].As<Napi::Object>();
+    auto iteratorOptionsObj = info[6].As<Napi::Object>();
+    auto callbackJsFn = info[7].As<Napi::Function>();
 
     auto env = info.Env();
-    auto resObj = Napi::Object::New(env);
+    auto cookie = CallCookie(env, callbackJsFn, "cbScanCallback");
+
+    auto trackProgress =
+        jsToCbpp<bool>(iteratorOptionsObj.Get("track_progress"));
+    auto bufferByteLimit = jsToCbpp<std::optional<std::size_t>>(
+        iteratorOptionsObj.Get("buffer_byte_limit"));
+    auto decompressValues =
+        jsToCbpp<bool>(iteratorOptionsObj.Get("decompress_values"));
+    std::shared_ptr<const ScanCheckpoint> resumeFrom;
+    auto resumeFromBytes = jsToCbpp<std::vector<std::byte>>(
+        iteratorOptionsObj.Get("resume_from"));
+    if (!resumeFromBytes.empty()) {
+        auto checkpoint = ScanCheckpoint::decode(resumeFromBytes.data(),
+                                                 resumeFromBytes.size());
+        if (!checkpoint.has_value()) {
+            cookie.invoke([](Napi::Env env, Napi::Function callback) {
+                callback.Call(
+                    {cbpp_to_js(env,
+                                couchbase::errc::make_error_code(
+                                    couchbase::errc::common::invalid_argument)),
+                     env.Null()});
+            });
+            return env.Null();
+        }
+        resumeFrom =
+            std::make_shared<const ScanCheckpoint>(std::move(*checkpoint));
+    }
 
-    auto barrier = std::make_shared<std::promise<
-        tl::expected<couchbase::core::topology::configuration::vbucket_map,
-                     std::error_code>>>();
-    auto f = barrier->get_future();
-    this->_instance->_cluster.with_bucket_configuration(
-        bucketName,
-        [barrier](std::error_code ec,
-                  std::shared_ptr<couchbase::core::topology::configuration>
-                      config) mutable {
-            if (ec) {
-                return barrier->set_value(tl::unexpected(ec));
-            }
-            if (!config->vbmap || config->vbmap->empty()) {
-                return barrier->set_value(tl::unexpected(
-                    couchbase::errc::common::feature_not_available));
-            }
-            barrier->set_value(config->vbmap.value());
+    auto agent = this->scanAgent(bucketName);
+    if (!agent.has_value()) {
+        cookie.invoke([ec = agent.error()](Napi::Env env,
+                                           Napi::Function callback) {
+            callback.Call({cbpp_to_js(env, ec), env.Null()});
         });
-    auto vbucket_map = f.get();
-    if (!vbucket_map.has_value()) {
-        resObj.Set("cppErr", cbpp_to_js(env, vbucket_map.error()));
-        resObj.Set("result", env.Null());
-        return resObj;
+        return env.Null();
     }
 
-    auto agentGroup = couchbase::core::agent_group(
-        this->_instance->_io,
-        couchbase::core::agent_group_config{{this->_instance->_cluster}});
-    agentGroup.open_bucket(bucketName);
-    auto agent = agentGroup.get_agent(bucketName);
     std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span> wrapper_span;
     auto span_name = jsToCbpp<std::string>(optionsObj.Get("wrapper_span_name"));
     if (!span_name.empty()) {
@@ -562,12 +608,6 @@ Napi::Value Connection::jsScan(const Napi::CallbackInfo &info)
     auto options = jsToCbpp<couchbase::core::range_scan_orchestrator_options>(
         optionsObj, wrapper_span);
 
-    if (!agent.has_value()) {
-        resObj.Set("cppErr", cbpp_to_js(env, agent.error()));
-        resObj.Set("result", env.Null());
-        return resObj;
-    }
-
     std::variant<std::monostate, couchbase::core::range_scan,
                  couchbase::core::prefix_scan, couchbase::core::sampling_scan>
         scanType;
@@ -579,23 +619,93 @@ Napi::Value Connection::jsScan(const Napi::CallbackInfo &info)
         scanType = js_to_cbpp<couchbase::core::prefix_scan>(info[4]);
     }
 
-    auto orchestrator = couchbase::core::range_scan_orchestrator(
-        this->_instance->_io, agent.value(), vbucket_map.value(), scopeName,
-        collectionName, scanType, options);
-    auto scanResult = orchestrator.scan();
-    if (!scanResult.has_value()) {
-        resObj.Set("cppErr", cbpp_to_js(env, scanResult.error()));
-        resObj.Set("result", env.Null());
-        return resObj;
-    }
+    // with_bucket_configuration hands us the most recent configuration the
+    // cluster has seen for the bucket, so the vbucket map used here is always
+    // refreshed on config change without any additional bookkeeping.
+    this->_instance->_cluster.with_bucket_configuration(
+        bucketName,
+        [io = &this->_instance->_io, agent = std::move(agent.value()),
+         scopeName = std::move(scopeName),
+         collectionName = std::move(collectionName),
+         scanType = std::move(scanType), options = std::move(options),
+         trackProgress, resumeFrom = std::move(resumeFrom), bufferByteLimit,
+         decompressValues, cookie = std::move(cookie)](
+            std::error_code ec,
+            std::shared_ptr<couchbase::core::topology::configuration>
+                config) mutable {
+            if (!ec && (!config->vbmap || config->vbmap->empty())) {
+                ec = couchbase::errc::make_error_code(
+                    couchbase::errc::common::feature_not_available);
+            }
+            if (!ec && resumeFrom &&
+                resumeFrom->numVbuckets() != config->vbmap->size()) {
+                // The checkpoint was taken against a different number of
+                // vbuckets, so its per-vbucket progress no longer applies.
+                ec = couchbase::errc::make_error_code(
+                    couchbase::errc::common::invalid_argument);
+            }
+            if (ec) {
+                cookie.invoke([ec](Napi::Env env, Napi::Function callback) {
+                    callback.Call({cbpp_to_js(env, ec), env.Null()});
+                });
+                return;
+            }
 
-    auto ext = Napi::External<couchbase::core::scan_result>::New(
-        env, &scanResult.value());
-    auto scanIterator = ScanIterator::constructor(info.Env()).New({ext});
-    resObj.Set("cppErr", env.Null());
-    resObj.Set("result", scanIterator);
+            // When every vbucket has progressed past some key, no vbucket
+            // can produce anything at or below the smallest of those keys
+            // and the range can be narrowed on the server side as well.
+            // Otherwise the orchestrator only takes a single range for all
+            // vbuckets, so they are all scanned from the start again and
+            // the items already delivered are skipped on this side.
+            auto *rangeScan =
+                std::get_if<couchbase::core::range_scan>(&scanType);
+            if (rangeScan && resumeFrom &&
+                resumeFrom->lastKeys().size() == resumeFrom->numVbuckets()) {
+                auto minKey = std::min_element(
+                    resumeFrom->lastKeys().begin(),
+                    resumeFrom->lastKeys().end(),
+                    [](const auto &a, const auto &b) {
+                        return a.second < b.second;
+                    });
+                if (!rangeScan->from.has_value() ||
+                    rangeScan->from->term < minKey->second) {
+                    rangeScan->from =
+                        couchbase::core::scan_term{minKey->second, true};
+                }
+            }
 
-    return resObj;
+            auto orchestrator = couchbase::core::range_scan_orchestrator(
+                *io, std::move(agent), config->vbmap.value(), scopeName,
+                collectionName, scanType, options);
+            orchestrator.scan([io, config, trackProgress,
+                               resumeFrom = std::move(resumeFrom),
+                               bufferByteLimit, decompressValues,
+                               cookie = std::move(cookie)](
+                                  std::error_code ec,
+                                  couchbase::core::scan_result result) mutable {
+                cookie.invoke([ec,
+                               init = ScanIteratorInit{
+                                   std::move(result), std::move(config),
+                                   trackProgress, std::move(resumeFrom),
+                                   bufferByteLimit.value_or(0), io,
+                                   decompressValues}](
+                                  Napi::Env env,
+                                  Napi::Function callback) mutable {
+                    if (ec) {
+                        callback.Call({cbpp_to_js(env, ec), env.Null()});
+                        return;
+                    }
+
+                    auto ext =
+                        Napi::External<ScanIteratorInit>::New(env, &init);
+                    auto scanIterator =
+                        ScanIterator::constructor(env).New({ext});
+                    callback.Call({env.Null(), scanIterator});
+                });
+            });
+        });
+
+    return env.Null();
 }
 
 std::pair<std::optional<std::string>, std::optional<std::string>>
@@ -626,4 +736,36 @@ Napi::Value Connection::jsGetClusterLabels(const Napi::CallbackInfo &info)
     return resObj;
 }
 
+Napi::Value Connection::jsSetThresholdLogger(const Napi::CallbackInfo &info)
+{
+    if (info[0].IsNull() || info[0].IsUndefined()) {
+        this->_thresholdLog = nullptr;
+    } else {
+        auto logger = ThresholdLogger::Unwrap(info[0].As<Napi::Object>());
+        this->_thresholdLog = logger->state();
+    }
+    return info.Env().Null();
+}
+
+Napi::Value Connection::jsSetOperationMeter(const Napi::CallbackInfo &info)
+{
+    if (info[0].IsNull() || info[0].IsUndefined()) {
+        this->_operationMeter = nullptr;
+    } else {
+        auto meter = OperationMeter::Unwrap(info[0].As<Napi::Object>());
+        this->_operationMeter = meter->state();
+    }
+    return info.Env().Null();
+}
+
+Napi::Value Connection::jsStats(const Napi::CallbackInfo &info)
+{
+    return this->_stats->takeSnapshot(info.Env());
+}
+
+Napi::Value Connection::jsNodeStats(const Napi::CallbackInfo &info)
+{
+    return this->_nodeStats->takeSnapshot(info.Env());
+}
+
 } // namespace couchnode
@@ -1,7 +1,14 @@
 #pragma once
 #include "addondata.hpp"
+#include "connection_stats.hpp"
 #include "instance.hpp"
 #include "jstocbpp.hpp"
+#include "operation_meter.hpp"
+#include "probes.hpp"
+#include "threshold_logging.hpp"
+#include "value_compression.hpp"
+#include <asio/post.hpp>
+#include <core/agent_group.hxx>
 #include <core/tracing/wrapper_sdk_tracer.hxx>
 #include <core/utils/movable_function.hxx>
 #include <napi.h>
@@ -9,41 +16,81 @@
 namespace couchnode
 {
 
+// What the Connection records about an operation on the io thread, on behalf
+// of the ObservableRequestHandler which issued it.  Operations which JS traces
+// or meters itself are left alone, as they would otherwise be counted twice.
+// Values are only decompressed for reads whose transcoder asked for it.
+struct NativeObservation {
+    bool thresholdLog{false};
+    std::optional<std::size_t> meterRecorderId;
+    bool decompressValues{false};
+};
+
 typedef couchbase::core::utils::movable_function<void(Napi::Env,
                                                       Napi::Function)>
     FwdFunc;
 
+struct CallCookieCompletion {
+    FwdFunc fn;
+    std::shared_ptr<ConnectionStats> stats;
+    ConnectionStats::time_point queuedAt;
+};
+
 void jscbForward(Napi::Env env, Napi::Function callback, std::nullptr_t *,
-                 FwdFunc *fn);
-typedef Napi::TypedThreadSafeFunction<std::nullptr_t, FwdFunc, &jscbForward>
+                 CallCookieCompletion *completion);
+typedef Napi::TypedThreadSafeFunction<std::nullptr_t, CallCookieCompletion,
+                                      &jscbForward>
     CallCookieTTSF;
 
 class CallCookie
 {
 public:
     CallCookie(Napi::Env env, Napi::Function jsCallback,
-               const std::string &resourceName)
+               const std::string &resourceName,
+               std::shared_ptr<ConnectionStats> stats = nullptr)
+        : _stats(std::move(stats))
     {
         _ttsf =
             CallCookieTTSF::New(env, jsCallback, resourceName, 0, 1, nullptr);
         _ttsf.Ref(env);
+        if (_stats) {
+            _stats->operationStarted();
+        }
     }
 
     CallCookie(CallCookie &o) = delete;
 
     CallCookie(CallCookie &&o)
         : _ttsf(std::move(o._ttsf))
+        , _stats(std::move(o._stats))
     {
     }
 
     void invoke(FwdFunc &&callback)
     {
-        _ttsf.BlockingCall(new FwdFunc(std::move(callback)));
+        auto completion =
+            new CallCookieCompletion{std::move(callback), _stats, {}};
+        if (_stats) {
+            completion->queuedAt = _stats->operationCompleted();
+        }
+        COUCHNODE_PROBE1(cookie__enqueue, completion);
+        _ttsf.BlockingCall(completion);
         _ttsf.Release();
     }
 
+    // Delivers a partial result of an operation which completes in several
+    // parts.  Partial results are not counted as completions, and invoke()
+    // must still be called once to deliver the final one.
+    void notify(FwdFunc &&callback)
+    {
+        auto completion = new CallCookieCompletion{std::move(callback), {}, {}};
+        COUCHNODE_PROBE1(cookie__enqueue, completion);
+        _ttsf.BlockingCall(completion);
+    }
+
 private:
     CallCookieTTSF _ttsf;
+    std::shared_ptr<ConnectionStats> _stats;
 };
 
 class Connection : public Napi::ObjectWrap<Connection>
@@ -75,6 +122,12 @@ public:
     Napi::Value jsPing(const Napi::CallbackInfo &info);
     Napi::Value jsScan(const Napi::CallbackInfo &info);
     Napi::Value jsGetClusterLabels(const Napi::CallbackInfo &info);
+    Napi::Value jsSetThresholdLogger(const Napi::CallbackInfo &info);
+    Napi::Value jsSetOperationMeter(const Napi::CallbackInfo &info);
+    Napi::Value jsStats(const Napi::CallbackInfo &info);
+    Napi::Value jsNodeStats(const Napi::CallbackInfo &info);
+    Napi::Value jsGetAllReplicasStream(const Napi::CallbackInfo &info);
+    Napi::Value jsLookupInAllReplicasStream(const Napi::CallbackInfo &info);
 
     //#region Autogenerated Method Declarations
 
@@ -225,38 +278,120 @@ public:
     //#endregion Autogenerated Method Declarations
 
 private:
+    tl::expected<couchbase::core::agent, std::error_code>
+    scanAgent(const std::string &bucketName);
+
+    static NativeObservation nativeObservation(const Napi::Object &optsJsObj)
+    {
+        NativeObservation observation;
+        observation.thresholdLog =
+            optsJsObj.Get("native_threshold_log").ToBoolean().Value();
+        auto recorderId = optsJsObj.Get("meter_recorder_id");
+        if (recorderId.IsNumber()) {
+            observation.meterRecorderId =
+                recorderId.As<Napi::Number>().Uint32Value();
+        }
+        observation.decompressValues =
+            optsJsObj.Get("decompress_values").ToBoolean().Value();
+        return observation;
+    }
+
     template <typename Request, typename Handler>
-    void executeOp(const std::string &opName, const Request &req,
-                   Napi::Function jsCallback, Handler &&handler)
+    void executeOp(const std::string &opName, Request req,
+                   Napi::Function jsCallback, Handler &&handler,
+                   std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span>
+                       wrapperSpan = nullptr,
+                   NativeObservation observation = {})
     {
         using response_type = typename Request::response_type;
 
-        auto cookie = CallCookie(jsCallback.Env(), jsCallback, opName);
-        this->_instance->_cluster.execute(
-            req, [cookie = std::move(cookie),
-                  handler = std::move(handler)](response_type resp) mutable {
+        auto cookie =
+            CallCookie(jsCallback.Env(), jsCallback, opName, this->_stats);
+        auto thresholdLog = wrapperSpan && observation.thresholdLog
+                                ? this->_thresholdLog
+                                : nullptr;
+        auto meter =
+            observation.meterRecorderId ? this->_operationMeter : nullptr;
+        auto service = ThresholdLogState::serviceForOp(opName);
+        auto startedAt = std::chrono::steady_clock::now();
+        auto probeId = nextProbeOpId();
+        COUCHNODE_PROBE2(op__start, probeId, opName.c_str());
+        auto onResponse =
+            [cookie = std::move(cookie), handler = std::move(handler),
+             thresholdLog = std::move(thresholdLog),
+             meter = std::move(meter),
+             meterRecorderId = observation.meterRecorderId,
+             decompressValues = observation.decompressValues,
+             nodeStats = this->_nodeStats, service, startedAt, probeId,
+             wrapperSpan = std::move(wrapperSpan)](response_type resp) mutable {
+                auto latency = std::chrono::steady_clock::now() - startedAt;
+                auto ec = get_cbpp_error_code(resp.ctx);
+                COUCHNODE_PROBE4(
+                    op__done, probeId, service, ec.value(),
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        latency)
+                        .count());
+                nodeStats->record(service,
+                                  get_cbpp_last_dispatched_to(resp.ctx),
+                                  latency, static_cast<bool>(ec));
+                if (thresholdLog) {
+                    thresholdLog->recordOp(service, startedAt, *wrapperSpan);
+                }
+                if (meter) {
+                    meter->record(
+                        *meterRecorderId,
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            latency)
+                            .count());
+                }
+                if (decompressValues) {
+                    decompressResponseValues(resp);
+                }
                 cookie.invoke(
                     [handler = std::move(handler), resp = std::move(resp)](
                         Napi::Env env, Napi::Function callback) mutable {
                         handler(env, callback, std::move(resp));
                     });
-            });
+            };
+
+        // Values flagged for compression are compressed on the io thread,
+        // rather than holding up the JS thread.
+        if (wantsValueCompression(req)) {
+            asio::post(this->_instance->_io,
+                       [cluster = this->_instance->_cluster,
+                        req = std::move(req),
+                        onResponse = std::move(onResponse)]() mutable {
+                           compressRequestValue(req);
+                           cluster.execute(std::move(req),
+                                           std::move(onResponse));
+                       });
+            return;
+        }
+        this->_instance->_cluster.execute(std::move(req),
+                                          std::move(onResponse));
     }
 
     template <typename Request>
-    void executeOp(const std::string &opName, const Request &req,
+    void executeOp(const std::string &opName, Request req,
                    Napi::Function jsCallback,
                    std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span>
-                       wrapperSpan = nullptr)
+                       wrapperSpan = nullptr,
+                   NativeObservation observation = {})
     {
         using response_type = typename Request::response_type;
-        auto clusterLabels = wrapperSpan != nullptr
+        // With native threshold logging the spans are consumed on the io
+        // thread, so there is no need to hand them over to JS as well.
+        auto jsSpan = observation.thresholdLog && this->_thresholdLog
+                          ? nullptr
+                          : wrapperSpan;
+        auto clusterLabels = jsSpan != nullptr
                                  ? this->getClusterLabels()
                                  : std::make_pair(std::optional<std::string>{},
                                                   std::optional<std::string>{});
         executeOp(
-            opName, req, jsCallback,
-            [wrapperSpan, clusterLabels = std::move(clusterLabels)](
+            opName, std::move(req), jsCallback,
+            [wrapperSpan = std::move(jsSpan),
+             clusterLabels = std::move(clusterLabels)](
                 Napi::Env env, Napi::Function callback,
                 response_type resp) mutable {
                 Napi::Value jsErr, jsRes;
@@ -286,10 +421,16 @@ private:
                     jsRes = env.Null();
                 }
                 callback.Call({jsErr, jsRes});
-            });
+            },
+            wrapperSpan, observation);
     }
 
     Instance *_instance;
+    std::optional<couchbase::core::agent_group> _agentGroup;
+    std::shared_ptr<ThresholdLogState> _thresholdLog;
+    std::shared_ptr<OperationMeterState> _operationMeter;
+    std::shared_ptr<ConnectionStats> _stats;
+    std::shared_ptr<NodeStats> _nodeStats;
 };
 
 } // namespace couchnode
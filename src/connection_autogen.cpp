@@ -22,7 +22,8 @@ Napi::Value Connection::jsPrepend(const Napi::CallbackInfo &info)
     executeOp("prepend",
               jsToCbpp<couchbase::core::operations::prepend_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -45,7 +46,8 @@ Connection::jsPrependWithLegacyDurability(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::
                            prepend_request_with_legacy_durability>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -66,7 +68,8 @@ Napi::Value Connection::jsExists(const Napi::CallbackInfo &info)
     executeOp("exists",
               jsToCbpp<couchbase::core::operations::exists_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -87,7 +90,8 @@ Napi::Value Connection::jsHttpNoop(const Napi::CallbackInfo &info)
     executeOp("httpNoop",
               jsToCbpp<couchbase::core::operations::http_noop_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -108,7 +112,8 @@ Napi::Value Connection::jsUnlock(const Napi::CallbackInfo &info)
     executeOp("unlock",
               jsToCbpp<couchbase::core::operations::unlock_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -129,7 +134,8 @@ Napi::Value Connection::jsGetAllReplicas(const Napi::CallbackInfo &info)
     executeOp("getAllReplicas",
               jsToCbpp<couchbase::core::operations::get_all_replicas_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -150,7 +156,8 @@ Napi::Value Connection::jsUpsert(const Napi::CallbackInfo &info)
     executeOp("upsert",
               jsToCbpp<couchbase::core::operations::upsert_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -174,7 +181,7 @@ Connection::jsUpsertWithLegacyDurability(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::upsert_request_with_legacy_durability>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -195,7 +202,8 @@ Napi::Value Connection::jsGetAnyReplica(const Napi::CallbackInfo &info)
     executeOp("getAnyReplica",
               jsToCbpp<couchbase::core::operations::get_any_replica_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -216,7 +224,8 @@ Napi::Value Connection::jsAppend(const Napi::CallbackInfo &info)
     executeOp("append",
               jsToCbpp<couchbase::core::operations::append_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -240,7 +249,7 @@ Connection::jsAppendWithLegacyDurability(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::append_request_with_legacy_durability>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -261,7 +270,8 @@ Napi::Value Connection::jsQuery(const Napi::CallbackInfo &info)
     executeOp("query",
               jsToCbpp<couchbase::core::operations::query_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -282,7 +292,8 @@ Napi::Value Connection::jsReplace(const Napi::CallbackInfo &info)
     executeOp("replace",
               jsToCbpp<couchbase::core::operations::replace_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -305,7 +316,8 @@ Connection::jsReplaceWithLegacyDurability(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::
                            replace_request_with_legacy_durability>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -326,7 +338,8 @@ Napi::Value Connection::jsGetAndTouch(const Napi::CallbackInfo &info)
     executeOp("getAndTouch",
               jsToCbpp<couchbase::core::operations::get_and_touch_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -347,7 +360,8 @@ Napi::Value Connection::jsRemove(const Napi::CallbackInfo &info)
     executeOp("remove",
               jsToCbpp<couchbase::core::operations::remove_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -371,7 +385,7 @@ Connection::jsRemoveWithLegacyDurability(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::remove_request_with_legacy_durability>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -392,7 +406,8 @@ Napi::Value Connection::jsGet(const Napi::CallbackInfo &info)
     executeOp("get",
               jsToCbpp<couchbase::core::operations::get_request>(optsJsObj,
                                                                  wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -414,7 +429,7 @@ Napi::Value Connection::jsLookupInAllReplicas(const Napi::CallbackInfo &info)
         "lookupInAllReplicas",
         jsToCbpp<couchbase::core::operations::lookup_in_all_replicas_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -435,7 +450,8 @@ Napi::Value Connection::jsAnalytics(const Napi::CallbackInfo &info)
     executeOp("analytics",
               jsToCbpp<couchbase::core::operations::analytics_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -456,7 +472,8 @@ Napi::Value Connection::jsGetProjected(const Napi::CallbackInfo &info)
     executeOp("getProjected",
               jsToCbpp<couchbase::core::operations::get_projected_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -477,7 +494,8 @@ Napi::Value Connection::jsDecrement(const Napi::CallbackInfo &info)
     executeOp("decrement",
               jsToCbpp<couchbase::core::operations::decrement_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -500,7 +518,8 @@ Connection::jsDecrementWithLegacyDurability(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::
                            decrement_request_with_legacy_durability>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -521,7 +540,8 @@ Napi::Value Connection::jsSearch(const Napi::CallbackInfo &info)
     executeOp("search",
               jsToCbpp<couchbase::core::operations::search_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -542,7 +562,8 @@ Napi::Value Connection::jsTouch(const Napi::CallbackInfo &info)
     executeOp("touch",
               jsToCbpp<couchbase::core::operations::touch_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -563,7 +584,8 @@ Napi::Value Connection::jsLookupIn(const Napi::CallbackInfo &info)
     executeOp("lookupIn",
               jsToCbpp<couchbase::core::operations::lookup_in_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -584,7 +606,8 @@ Napi::Value Connection::jsDocumentView(const Napi::CallbackInfo &info)
     executeOp("documentView",
               jsToCbpp<couchbase::core::operations::document_view_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -605,7 +628,8 @@ Napi::Value Connection::jsGetAndLock(const Napi::CallbackInfo &info)
     executeOp("getAndLock",
               jsToCbpp<couchbase::core::operations::get_and_lock_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -626,7 +650,8 @@ Napi::Value Connection::jsInsert(const Napi::CallbackInfo &info)
     executeOp("insert",
               jsToCbpp<couchbase::core::operations::insert_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -650,7 +675,7 @@ Connection::jsInsertWithLegacyDurability(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::insert_request_with_legacy_durability>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -672,7 +697,7 @@ Napi::Value Connection::jsLookupInAnyReplica(const Napi::CallbackInfo &info)
         "lookupInAnyReplica",
         jsToCbpp<couchbase::core::operations::lookup_in_any_replica_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -693,7 +718,8 @@ Napi::Value Connection::jsMutateIn(const Napi::CallbackInfo &info)
     executeOp("mutateIn",
               jsToCbpp<couchbase::core::operations::mutate_in_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -716,7 +742,8 @@ Connection::jsMutateInWithLegacyDurability(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::
                            mutate_in_request_with_legacy_durability>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -737,7 +764,8 @@ Napi::Value Connection::jsIncrement(const Napi::CallbackInfo &info)
     executeOp("increment",
               jsToCbpp<couchbase::core::operations::increment_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -760,7 +788,8 @@ Connection::jsIncrementWithLegacyDurability(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::
                            increment_request_with_legacy_durability>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -782,7 +811,7 @@ Napi::Value Connection::jsManagementGroupUpsert(const Napi::CallbackInfo &info)
         "managementGroupUpsert",
         jsToCbpp<couchbase::core::operations::management::group_upsert_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -805,7 +834,7 @@ Connection::jsManagementEventingPauseFunction(const Napi::CallbackInfo &info)
         "managementEventingPauseFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_pause_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -828,7 +857,7 @@ Connection::jsManagementQueryIndexGetAll(const Napi::CallbackInfo &info)
         "managementQueryIndexGetAll",
         jsToCbpp<couchbase::core::operations::management::
                      query_index_get_all_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -852,7 +881,7 @@ Connection::jsManagementCollectionCreate(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::collection_create_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -875,7 +904,7 @@ Connection::jsManagementEventingResumeFunction(const Napi::CallbackInfo &info)
         "managementEventingResumeFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_resume_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -898,7 +927,7 @@ Connection::jsManagementSearchIndexGetStats(const Napi::CallbackInfo &info)
         "managementSearchIndexGetStats",
         jsToCbpp<couchbase::core::operations::management::
                      search_index_get_stats_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -921,7 +950,7 @@ Napi::Value Connection::jsManagementBucketGetAll(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::bucket_get_all_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -944,7 +973,8 @@ Connection::jsManagementQueryIndexBuildDeferred(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            query_index_build_deferred_request>(optsJsObj,
                                                                wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -968,7 +998,7 @@ Connection::jsManagementClusterDescribe(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::cluster_describe_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -991,7 +1021,7 @@ Connection::jsManagementSearchIndexGetAll(const Napi::CallbackInfo &info)
         "managementSearchIndexGetAll",
         jsToCbpp<couchbase::core::operations::management::
                      search_index_get_all_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1014,7 +1044,8 @@ Napi::Value Connection::jsManagementSearchIndexAnalyzeDocument(
               jsToCbpp<couchbase::core::operations::management::
                            search_index_analyze_document_request>(optsJsObj,
                                                                   wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1038,7 +1069,7 @@ Connection::jsManagementQueryIndexDrop(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::query_index_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1061,7 +1092,7 @@ Connection::jsManagementAnalyticsDatasetCreate(const Napi::CallbackInfo &info)
         "managementAnalyticsDatasetCreate",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_dataset_create_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1083,7 +1114,7 @@ Napi::Value Connection::jsManagementBucketFlush(const Napi::CallbackInfo &info)
         "managementBucketFlush",
         jsToCbpp<couchbase::core::operations::management::bucket_flush_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1106,7 +1137,7 @@ Connection::jsManagementAnalyticsIndexDrop(const Napi::CallbackInfo &info)
         "managementAnalyticsIndexDrop",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_index_drop_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1128,7 +1159,8 @@ Connection::jsManagementQueryIndexCreate(const Napi::CallbackInfo &info)
     executeOp("managementQueryIndexCreate",
               jsToCbpp<couchbase::core::operations::management::
                            query_index_create_request>(optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1151,7 +1183,7 @@ Connection::jsManagementSearchIndexUpsert(const Napi::CallbackInfo &info)
         "managementSearchIndexUpsert",
         jsToCbpp<couchbase::core::operations::management::
                      search_index_upsert_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1174,7 +1206,8 @@ Connection::jsManagementAnalyticsDatasetGetAll(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            analytics_dataset_get_all_request>(optsJsObj,
                                                               wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1197,7 +1230,7 @@ Connection::jsManagementAnalyticsIndexGetAll(const Napi::CallbackInfo &info)
         "managementAnalyticsIndexGetAll",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_index_get_all_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1220,7 +1253,8 @@ Napi::Value Connection::jsManagementAnalyticsGetPendingMutations(
               jsToCbpp<couchbase::core::operations::management::
                            analytics_get_pending_mutations_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1243,7 +1277,7 @@ Connection::jsManagementAnalyticsDataverseDrop(const Napi::CallbackInfo &info)
         "managementAnalyticsDataverseDrop",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_dataverse_drop_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1266,7 +1300,7 @@ Connection::jsManagementAnalyticsLinkConnect(const Napi::CallbackInfo &info)
         "managementAnalyticsLinkConnect",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_link_connect_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1289,7 +1323,7 @@ Connection::jsManagementCollectionsManifestGet(const Napi::CallbackInfo &info)
         "managementCollectionsManifestGet",
         jsToCbpp<couchbase::core::operations::management::
                      collections_manifest_get_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1313,7 +1347,7 @@ Connection::jsManagementChangePassword(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::change_password_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1336,7 +1370,8 @@ Napi::Value Connection::jsManagementClusterDeveloperPreviewEnable(
               jsToCbpp<couchbase::core::operations::management::
                            cluster_developer_preview_enable_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1359,7 +1394,7 @@ Connection::jsManagementAnalyticsLinkDrop(const Napi::CallbackInfo &info)
         "managementAnalyticsLinkDrop",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_link_drop_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1383,7 +1418,7 @@ Connection::jsManagementCollectionUpdate(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::collection_update_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1407,7 +1442,7 @@ Connection::jsManagementBucketDescribe(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::bucket_describe_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1430,7 +1465,7 @@ Connection::jsManagementEventingUpsertFunction(const Napi::CallbackInfo &info)
         "managementEventingUpsertFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_upsert_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1452,7 +1487,8 @@ Connection::jsManagementViewIndexGetAll(const Napi::CallbackInfo &info)
     executeOp("managementViewIndexGetAll",
               jsToCbpp<couchbase::core::operations::management::
                            view_index_get_all_request>(optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1474,7 +1510,7 @@ Napi::Value Connection::jsManagementBucketGet(const Napi::CallbackInfo &info)
         "managementBucketGet",
         jsToCbpp<couchbase::core::operations::management::bucket_get_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1497,7 +1533,7 @@ Napi::Value Connection::jsManagementBucketUpdate(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::bucket_update_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1519,7 +1555,7 @@ Napi::Value Connection::jsManagementBucketDrop(const Napi::CallbackInfo &info)
         "managementBucketDrop",
         jsToCbpp<couchbase::core::operations::management::bucket_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1541,7 +1577,7 @@ Napi::Value Connection::jsManagementFreeform(const Napi::CallbackInfo &info)
         "managementFreeform",
         jsToCbpp<couchbase::core::operations::management::freeform_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1563,7 +1599,7 @@ Napi::Value Connection::jsManagementScopeDrop(const Napi::CallbackInfo &info)
         "managementScopeDrop",
         jsToCbpp<couchbase::core::operations::management::scope_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1587,7 +1623,7 @@ Connection::jsManagementViewIndexUpsert(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::view_index_upsert_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1609,7 +1645,7 @@ Napi::Value Connection::jsManagementUserGetAll(const Napi::CallbackInfo &info)
         "managementUserGetAll",
         jsToCbpp<couchbase::core::operations::management::user_get_all_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1631,7 +1667,7 @@ Napi::Value Connection::jsManagementScopeCreate(const Napi::CallbackInfo &info)
         "managementScopeCreate",
         jsToCbpp<couchbase::core::operations::management::scope_create_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1654,7 +1690,7 @@ Connection::jsManagementEventingGetFunction(const Napi::CallbackInfo &info)
         "managementEventingGetFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_get_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1678,7 +1714,7 @@ Connection::jsManagementViewIndexDrop(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::view_index_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1703,7 +1739,8 @@ Napi::Value Connection::jsManagementAnalyticsLinkReplaceAzureBlobExternalLink(
                                couchbase::core::management::analytics::
                                    azure_blob_external_link>>(optsJsObj,
                                                               wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1728,7 +1765,7 @@ Napi::Value Connection::jsManagementAnalyticsLinkReplaceCouchbaseRemoteLink(
                      analytics_link_replace_request<
                          couchbase::core::management::analytics::
                              couchbase_remote_link>>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1754,7 +1791,7 @@ Napi::Value Connection::jsManagementAnalyticsLinkReplaceS3ExternalLink(
                 analytics_link_replace_request<
                     couchbase::core::management::analytics::s3_external_link>>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1777,7 +1814,8 @@ Connection::jsManagementAnalyticsLinkDisconnect(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            analytics_link_disconnect_request>(optsJsObj,
                                                               wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1799,7 +1837,7 @@ Napi::Value Connection::jsManagementUserUpsert(const Napi::CallbackInfo &info)
         "managementUserUpsert",
         jsToCbpp<couchbase::core::operations::management::user_upsert_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1822,7 +1860,7 @@ Connection::jsManagementEventingGetStatus(const Napi::CallbackInfo &info)
         "managementEventingGetStatus",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_get_status_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1845,7 +1883,8 @@ Connection::jsManagementEventingGetAllFunctions(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            eventing_get_all_functions_request>(optsJsObj,
                                                                wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1868,7 +1907,7 @@ Connection::jsManagementAnalyticsIndexCreate(const Napi::CallbackInfo &info)
         "managementAnalyticsIndexCreate",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_index_create_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1891,7 +1930,7 @@ Napi::Value Connection::jsManagementScopeGetAll(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::scope_get_all_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1913,7 +1952,7 @@ Napi::Value Connection::jsManagementUserGet(const Napi::CallbackInfo &info)
         "managementUserGet",
         jsToCbpp<couchbase::core::operations::management::user_get_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1937,7 +1976,7 @@ Connection::jsManagementSearchIndexDrop(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::search_index_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1960,7 +1999,8 @@ Napi::Value Connection::jsManagementSearchIndexControlPlanFreeze(
               jsToCbpp<couchbase::core::operations::management::
                            search_index_control_plan_freeze_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -1984,7 +2024,7 @@ Connection::jsManagementSearchGetStats(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::search_get_stats_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2006,7 +2046,7 @@ Napi::Value Connection::jsManagementUserDrop(const Napi::CallbackInfo &info)
         "managementUserDrop",
         jsToCbpp<couchbase::core::operations::management::user_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2029,7 +2069,8 @@ Connection::jsManagementAnalyticsDataverseCreate(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            analytics_dataverse_create_request>(optsJsObj,
                                                                wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2052,7 +2093,8 @@ Connection::jsManagementSearchIndexControlQuery(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            search_index_control_query_request>(optsJsObj,
                                                                wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2074,7 +2116,7 @@ Napi::Value Connection::jsManagementRoleGetAll(const Napi::CallbackInfo &info)
         "managementRoleGetAll",
         jsToCbpp<couchbase::core::operations::management::role_get_all_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2097,7 +2139,7 @@ Napi::Value Connection::jsManagementGroupGetAll(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::group_get_all_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2122,7 +2164,8 @@ Napi::Value Connection::jsManagementAnalyticsLinkCreateAzureBlobExternalLink(
                                couchbase::core::management::analytics::
                                    azure_blob_external_link>>(optsJsObj,
                                                               wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2147,7 +2190,7 @@ Napi::Value Connection::jsManagementAnalyticsLinkCreateCouchbaseRemoteLink(
                      analytics_link_create_request<
                          couchbase::core::management::analytics::
                              couchbase_remote_link>>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2173,7 +2216,7 @@ Napi::Value Connection::jsManagementAnalyticsLinkCreateS3ExternalLink(
                 analytics_link_create_request<
                     couchbase::core::management::analytics::s3_external_link>>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2196,7 +2239,7 @@ Connection::jsManagementEventingDropFunction(const Napi::CallbackInfo &info)
         "managementEventingDropFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_drop_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2220,7 +2263,7 @@ Connection::jsManagementCollectionDrop(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::collection_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2243,7 +2286,8 @@ Connection::jsManagementSearchIndexControlIngest(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            search_index_control_ingest_request>(optsJsObj,
                                                                 wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2266,7 +2310,7 @@ Connection::jsManagementEventingDeployFunction(const Napi::CallbackInfo &info)
         "managementEventingDeployFunction",
         jsToCbpp<couchbase::core::operations::management::
                      eventing_deploy_function_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2288,7 +2332,7 @@ Napi::Value Connection::jsManagementGroupGet(const Napi::CallbackInfo &info)
         "managementGroupGet",
         jsToCbpp<couchbase::core::operations::management::group_get_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2311,7 +2355,7 @@ Napi::Value Connection::jsManagementViewIndexGet(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::view_index_get_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2334,7 +2378,7 @@ Napi::Value Connection::jsManagementBucketCreate(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::bucket_create_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2357,7 +2401,7 @@ Connection::jsManagementAnalyticsDatasetDrop(const Napi::CallbackInfo &info)
         "managementAnalyticsDatasetDrop",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_dataset_drop_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2379,7 +2423,7 @@ Napi::Value Connection::jsManagementGroupDrop(const Napi::CallbackInfo &info)
         "managementGroupDrop",
         jsToCbpp<couchbase::core::operations::management::group_drop_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2403,7 +2447,7 @@ Connection::jsManagementSearchIndexGet(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::search_index_get_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2426,7 +2470,8 @@ Connection::jsManagementQueryIndexGetAllDeferred(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            query_index_get_all_deferred_request>(optsJsObj,
                                                                  wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2450,7 +2495,7 @@ Connection::jsManagementQueryIndexBuild(const Napi::CallbackInfo &info)
         jsToCbpp<
             couchbase::core::operations::management::query_index_build_request>(
             optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2473,7 +2518,8 @@ Connection::jsManagementEventingUndeployFunction(const Napi::CallbackInfo &info)
               jsToCbpp<couchbase::core::operations::management::
                            eventing_undeploy_function_request>(optsJsObj,
                                                                wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2496,7 +2542,8 @@ Napi::Value Connection::jsManagementSearchIndexGetDocumentsCount(
               jsToCbpp<couchbase::core::operations::management::
                            search_index_get_documents_count_request>(
                   optsJsObj, wrapper_span),
-              callbackJsFn, wrapper_span);
+              callbackJsFn, wrapper_span,
+              nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -2519,7 +2566,7 @@ Connection::jsManagementAnalyticsLinkGetAll(const Napi::CallbackInfo &info)
         "managementAnalyticsLinkGetAll",
         jsToCbpp<couchbase::core::operations::management::
                      analytics_link_get_all_request>(optsJsObj, wrapper_span),
-        callbackJsFn, wrapper_span);
+        callbackJsFn, wrapper_span, nativeObservation(optsJsObj));
 
     return info.Env().Null();
 }
@@ -0,0 +1,350 @@
+#include "connection.hpp"
+#include "jstocbpp.hpp"
+#include <atomic>
+#include <core/impl/get_replica.hxx>
+#include <core/impl/lookup_in_replica.hxx>
+#include <core/impl/replica_utils.hxx>
+
+namespace couchnode
+{
+
+namespace
+{
+
+typedef couchbase::core::operations::get_all_replicas_response::entry
+    GetReplicaEntry;
+typedef couchbase::core::operations::lookup_in_all_replicas_response::entry
+    LookupInReplicaEntry;
+
+// The state shared by the per-node requests of a streamed all-replicas
+// read.  Each successful response is handed to JS as soon as it arrives,
+// rather than once every node has responded, and whichever response arrives
+// last completes the call.  Like the aggregated operation, failed responses
+// are skipped and the call only fails if none of them succeeded.
+//
+// JS receives (err, entry, false) for each replica, and then a final
+// (err, {cpp_core_span}, true).
+template <typename Entry>
+class ReplicaStream
+{
+public:
+    ReplicaStream(
+        CallCookie cookie,
+        std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span>
+            wrapperSpan,
+        std::shared_ptr<ThresholdLogState> thresholdLog,
+        std::shared_ptr<OperationMeterState> meter,
+        std::optional<std::size_t> meterRecorderId,
+        std::shared_ptr<NodeStats> nodeStats)
+        : _cookie(std::move(cookie))
+        , _wrapperSpan(std::move(wrapperSpan))
+        , _thresholdLog(std::move(thresholdLog))
+        , _meter(std::move(meter))
+        , _meterRecorderId(meterRecorderId)
+        , _nodeStats(std::move(nodeStats))
+        , _startedAt(std::chrono::steady_clock::now())
+    {
+    }
+
+    // Must be called before any of the requests are dispatched.
+    void expect(std::size_t numResponses)
+    {
+        _remaining.store(numResponses, std::memory_order_relaxed);
+    }
+
+    // Called on the io thread with each response.  The entry is only used
+    // when the response succeeded.
+    template <typename Context>
+    void deliver(const Context &ctx, Entry &&entry)
+    {
+        auto ec = get_cbpp_error_code(ctx);
+        _nodeStats->record("kv", get_cbpp_last_dispatched_to(ctx),
+                           std::chrono::steady_clock::now() - _startedAt,
+                           static_cast<bool>(ec));
+
+        if (!ec) {
+            _delivered.fetch_add(1, std::memory_order_relaxed);
+            _cookie.notify([entry = std::move(entry)](
+                               Napi::Env env, Napi::Function callback) {
+                callback.Call({env.Null(), cbpp_to_js(env, entry),
+                               Napi::Boolean::New(env, false)});
+            });
+        }
+
+        // The partial results above are queued before the count drops, so
+        // the final result is always the last one JS sees.
+        if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::error_code finalEc;
+            if (_delivered.load(std::memory_order_relaxed) == 0) {
+                finalEc = couchbase::errc::make_error_code(
+                    couchbase::errc::key_value::document_irretrievable);
+            }
+            complete(finalEc);
+        }
+    }
+
+    void complete(std::error_code ec)
+    {
+        if (_thresholdLog && _wrapperSpan) {
+            _thresholdLog->recordOp("kv", _startedAt, *_wrapperSpan);
+        }
+        if (_meter && _meterRecorderId) {
+            _meter->record(
+                *_meterRecorderId,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - _startedAt)
+                    .count());
+        }
+
+        // With native threshold logging the spans are consumed on the io
+        // thread, so there is no need to hand them over to JS as well.
+        auto jsSpan = _thresholdLog ? nullptr : _wrapperSpan;
+        _cookie.invoke([ec, jsSpan = std::move(jsSpan)](
+                           Napi::Env env, Napi::Function callback) {
+            auto jsCoreSpan = cbpp_wrapper_span_to_js(env, jsSpan);
+            Napi::Value jsErr = env.Null();
+            if (ec) {
+                auto errObj = cbpp_to_js(env, ec).As<Napi::Object>();
+                errObj.Set("cpp_core_span", jsCoreSpan);
+                jsErr = errObj;
+            }
+            auto resObj = Napi::Object::New(env);
+            resObj.Set("cpp_core_span", jsCoreSpan);
+            callback.Call({jsErr, resObj, Napi::Boolean::New(env, true)});
+        });
+    }
+
+private:
+    CallCookie _cookie;
+    std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span> _wrapperSpan;
+    std::shared_ptr<ThresholdLogState> _thresholdLog;
+    std::shared_ptr<OperationMeterState> _meter;
+    std::optional<std::size_t> _meterRecorderId;
+    std::shared_ptr<NodeStats> _nodeStats;
+    std::chrono::steady_clock::time_point _startedAt;
+    std::atomic<std::size_t> _remaining{0};
+    std::atomic<std::size_t> _delivered{0};
+};
+
+// Picks the nodes to read a document from, following the read preference
+// in the same way as the aggregated all-replicas operations.
+std::vector<couchbase::core::impl::readable_node>
+replicaNodes(couchbase::core::cluster &cluster,
+             const couchbase::core::document_id &id,
+             const std::shared_ptr<couchbase::core::topology::configuration>
+                 &config,
+             couchbase::read_preference readPreference, std::error_code &ec)
+{
+    if (ec) {
+        return {};
+    }
+
+    auto [originEc, origin] = cluster.origin();
+    if (originEc) {
+        ec = originEc;
+        return {};
+    }
+
+    auto nodes = couchbase::core::impl::effective_nodes(
+        id, config, readPreference, origin.options().server_group);
+    if (nodes.empty()) {
+        ec = couchbase::errc::make_error_code(
+            couchbase::errc::key_value::document_irretrievable);
+    }
+    return nodes;
+}
+
+template <typename Response>
+LookupInReplicaEntry toLookupInReplicaEntry(Response &&resp, bool isReplica)
+{
+    LookupInReplicaEntry entry{};
+    entry.cas = resp.cas;
+    entry.deleted = resp.deleted;
+    entry.is_replica = isReplica;
+    for (auto &field : resp.fields) {
+        LookupInReplicaEntry::lookup_in_entry fieldEntry{};
+        fieldEntry.path = std::move(field.path);
+        fieldEntry.value = std::move(field.value);
+        fieldEntry.original_index = field.original_index;
+        fieldEntry.exists = field.exists;
+        fieldEntry.opcode = field.opcode;
+        fieldEntry.status = field.status;
+        fieldEntry.ec = field.ec;
+        entry.fields.emplace_back(std::move(fieldEntry));
+    }
+    return entry;
+}
+
+std::shared_ptr<couchbase::core::tracing::wrapper_sdk_span>
+wrapperSpanFor(const Napi::Object &optsJsObj)
+{
+    auto span_name = jsToCbpp<std::string>(optsJsObj.Get("wrapper_span_name"));
+    if (span_name.empty()) {
+        return nullptr;
+    }
+    return std::make_shared<couchbase::core::tracing::wrapper_sdk_span>(
+        span_name);
+}
+
+} // namespace
+
+Napi::Value Connection::jsGetAllReplicasStream(const Napi::CallbackInfo &info)
+{
+    auto optsJsObj = info[0].As<Napi::Object>();
+    auto callbackJsFn = info[1].As<Napi::Function>();
+
+    auto wrapper_span = wrapperSpanFor(optsJsObj);
+    auto observation = nativeObservation(optsJsObj);
+    auto req =
+        jsToCbpp<couchbase::core::operations::get_all_replicas_request>(
+            optsJsObj, wrapper_span);
+
+    auto stream = std::make_shared<ReplicaStream<GetReplicaEntry>>(
+        CallCookie(info.Env(), callbackJsFn, "getAllReplicasStream",
+                   this->_stats),
+        wrapper_span,
+        wrapper_span && observation.thresholdLog ? this->_thresholdLog
+                                                 : nullptr,
+        this->_operationMeter, observation.meterRecorderId, this->_nodeStats);
+
+    auto cluster = this->_instance->_cluster;
+    cluster.with_bucket_configuration(
+        req.id.bucket(),
+        [cluster, req = std::move(req), stream,
+         decompressValues = observation.decompressValues](
+            std::error_code ec,
+            std::shared_ptr<couchbase::core::topology::configuration>
+                config) mutable {
+            auto nodes =
+                replicaNodes(cluster, req.id, config, req.read_preference, ec);
+            if (ec) {
+                stream->complete(ec);
+                return;
+            }
+
+            stream->expect(nodes.size());
+            for (const auto &node : nodes) {
+                if (node.is_replica) {
+                    couchbase::core::impl::get_replica_request replicaReq{};
+                    replicaReq.id = req.id;
+                    replicaReq.id.node_index(node.index);
+                    replicaReq.timeout = req.timeout;
+                    replicaReq.parent_span = req.parent_span;
+                    cluster.execute(
+                        std::move(replicaReq),
+                        [stream, decompressValues](
+                            couchbase::core::impl::get_replica_response resp) {
+                            if (decompressValues) {
+                                decompressResponseValues(resp);
+                            }
+                            stream->deliver(
+                                resp.ctx,
+                                GetReplicaEntry{std::move(resp.value),
+                                                resp.cas, resp.flags, true});
+                        });
+                } else {
+                    couchbase::core::operations::get_request activeReq{};
+                    activeReq.id = req.id;
+                    activeReq.timeout = req.timeout;
+                    activeReq.parent_span = req.parent_span;
+                    cluster.execute(
+                        std::move(activeReq),
+                        [stream, decompressValues](
+                            couchbase::core::operations::get_response resp) {
+                            if (decompressValues) {
+                                decompressResponseValues(resp);
+                            }
+                            stream->deliver(
+                                resp.ctx,
+                                GetReplicaEntry{std::move(resp.value),
+                                                resp.cas, resp.flags, false});
+                        });
+                }
+            }
+        });
+
+    return info.Env().Null();
+}
+
+Napi::Value
+Connection::jsLookupInAllReplicasStream(const Napi::CallbackInfo &info)
+{
+    auto optsJsObj = info[0].As<Napi::Object>();
+    auto callbackJsFn = info[1].As<Napi::Function>();
+
+    auto wrapper_span = wrapperSpanFor(optsJsObj);
+    auto observation = nativeObservation(optsJsObj);
+    auto req =
+        jsToCbpp<couchbase::core::operations::lookup_in_all_replicas_request>(
+            optsJsObj, wrapper_span);
+
+    auto stream = std::make_shared<ReplicaStream<LookupInReplicaEntry>>(
+        CallCookie(info.Env(), callbackJsFn, "lookupInAllReplicasStream",
+                   this->_stats),
+        wrapper_span,
+        wrapper_span && observation.thresholdLog ? this->_thresholdLog
+                                                 : nullptr,
+        this->_operationMeter, observation.meterRecorderId, this->_nodeStats);
+
+    auto cluster = this->_instance->_cluster;
+    cluster.with_bucket_configuration(
+        req.id.bucket(),
+        [cluster, req = std::move(req), stream](
+            std::error_code ec,
+            std::shared_ptr<couchbase::core::topology::configuration>
+                config) mutable {
+            // As with the aggregated operation, reading subdocuments from
+            // replicas needs the bucket to support it.
+            if (!ec && !config->supports_subdoc_read_replica()) {
+                ec = couchbase::errc::make_error_code(
+                    couchbase::errc::common::feature_not_available);
+            }
+            auto nodes =
+                replicaNodes(cluster, req.id, config, req.read_preference, ec);
+            if (ec) {
+                stream->complete(ec);
+                return;
+            }
+
+            stream->expect(nodes.size());
+            for (const auto &node : nodes) {
+                if (node.is_replica) {
+                    couchbase::core::impl::lookup_in_replica_request
+                        replicaReq{};
+                    replicaReq.id = req.id;
+                    replicaReq.id.node_index(node.index);
+                    replicaReq.specs = req.specs;
+                    replicaReq.timeout = req.timeout;
+                    replicaReq.parent_span = req.parent_span;
+                    cluster.execute(
+                        std::move(replicaReq),
+                        [stream](
+                            couchbase::core::impl::lookup_in_replica_response
+                                resp) {
+                            stream->deliver(resp.ctx,
+                                            toLookupInReplicaEntry(
+                                                std::move(resp), true));
+                        });
+                } else {
+                    couchbase::core::operations::lookup_in_request activeReq{};
+                    activeReq.id = req.id;
+                    activeReq.specs = req.specs;
+                    activeReq.timeout = req.timeout;
+                    activeReq.access_deleted = req.access_deleted;
+                    activeReq.parent_span = req.parent_span;
+                    cluster.execute(
+                        std::move(activeReq),
+                        [stream](couchbase::core::operations::lookup_in_response
+                                     resp) {
+                            stream->deliver(resp.ctx,
+                                            toLookupInReplicaEntry(
+                                                std::move(resp), false));
+                        });
+                }
+            }
+        });
+
+    return info.Env().Null();
+}
+
+} // namespace couchnode
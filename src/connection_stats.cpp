@@ -0,0 +1,138 @@
+#include "connection_stats.hpp"
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace couchnode
+{
+
+void ConnectionStats::completionDispatched(time_point queuedAt)
+{
+    _pendingCompletions.fetch_sub(1, std::memory_order_relaxed);
+    _completionDelay.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - queuedAt)
+            .count());
+}
+
+Napi::Value ConnectionStats::takeSnapshot(Napi::Env env)
+{
+    auto pending = _pendingCompletions.load(std::memory_order_relaxed);
+    auto maxPending =
+        _maxPendingCompletions.exchange(pending, std::memory_order_relaxed);
+
+    auto resObj = Napi::Object::New(env);
+    resObj.Set("in_flight",
+               Napi::Number::New(env, static_cast<double>(_inFlight.load(
+                                          std::memory_order_relaxed))));
+    resObj.Set("pending_completions",
+               Napi::Number::New(env, static_cast<double>(pending)));
+    resObj.Set("max_pending_completions",
+               Napi::Number::New(env, static_cast<double>(maxPending)));
+    resObj.Set("completion_delay_us", _completionDelay.takeSnapshot(env));
+    return resObj;
+}
+
+NodeStats::Entry *NodeStats::findEntry(const std::string &node,
+                                       std::string_view service)
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto nodeIt = _nodes.find(node);
+    if (nodeIt == _nodes.end()) {
+        return nullptr;
+    }
+    auto it = nodeIt->second.find(service);
+    return it != nodeIt->second.end() ? it->second.get() : nullptr;
+}
+
+void NodeStats::record(const char *service,
+                       const std::optional<std::string> &lastDispatchedTo,
+                       std::chrono::steady_clock::duration latency,
+                       bool failed)
+{
+    // Operations which never made it to a node (e.g. failed to resolve a
+    // collection) are grouped together rather than dropped.
+    static const std::string UNDISPATCHED = "";
+    const auto &node = lastDispatchedTo ? *lastDispatchedTo : UNDISPATCHED;
+
+    auto *entry = findEntry(node, service);
+    if (!entry) {
+        // The histogram of a new entry is allocated before taking the
+        // exclusive lock.  This runs on the io thread, so running out of
+        // memory only loses this sample rather than escaping.
+        try {
+            auto newEntry = std::make_unique<Entry>();
+            std::unique_lock<std::shared_mutex> lock(_mutex);
+            auto &services = _nodes[node];
+            auto it = services.find(std::string_view(service));
+            if (it == services.end()) {
+                it = services.emplace(service, std::move(newEntry)).first;
+            }
+            entry = it->second.get();
+        } catch (const std::bad_alloc &) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    entry->totalCount++;
+    if (failed) {
+        entry->errorCount++;
+    }
+    entry->latency.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(latency)
+            .count());
+}
+
+Napi::Value NodeStats::takeSnapshot(Napi::Env env)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto intervalSecs = std::chrono::duration<double>(
+                            now - std::exchange(_intervalStart, now))
+                            .count();
+
+    // Entries are reset rather than removed, and those which saw no
+    // operations during the interval are left out.
+    auto jsNodes = Napi::Object::New(env);
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    for (auto &[node, services] : _nodes) {
+        auto jsServices = Napi::Object::New(env);
+        bool hasServices = false;
+        for (auto &[service, entry] : services) {
+            std::lock_guard<std::mutex> entryLock(entry->mutex);
+            if (entry->totalCount == 0) {
+                continue;
+            }
+
+            auto jsEntry = Napi::Object::New(env);
+            jsEntry.Set("total_count",
+                        Napi::Number::New(
+                            env, static_cast<double>(entry->totalCount)));
+            jsEntry.Set("error_count",
+                        Napi::Number::New(
+                            env, static_cast<double>(entry->errorCount)));
+            jsEntry.Set("throughput_per_s",
+                        Napi::Number::New(
+                            env, intervalSecs > 0
+                                     ? static_cast<double>(entry->totalCount) /
+                                           intervalSecs
+                                     : 0));
+            jsEntry.Set("latency_us", entry->latency.takeSnapshot(env));
+            jsServices.Set(service, jsEntry);
+            entry->totalCount = 0;
+            entry->errorCount = 0;
+            hasServices = true;
+        }
+        if (hasServices) {
+            jsNodes.Set(node, jsServices);
+        }
+    }
+    lock.unlock();
+
+    auto resObj = Napi::Object::New(env);
+    resObj.Set("interval_s", Napi::Number::New(env, intervalSecs));
+    resObj.Set("nodes", jsNodes);
+    return resObj;
+}
+
+} // namespace couchnode
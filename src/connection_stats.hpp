@@ -0,0 +1,104 @@
+#pragma once
+#include "latency_histogram.hpp"
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+namespace couchnode
+{
+
+// Tracks where the operations of a Connection currently are.  An operation is
+// in flight from the moment it is handed to the core until the core completes
+// it on the io thread, and is then a pending completion until its callback is
+// actually run on the JS thread.  The time spent as a pending completion is
+// the completion queue delay, which grows as the event loop saturates.
+class ConnectionStats
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    void operationStarted()
+    {
+        _inFlight.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Called on the io thread, returns the time the completion was queued.
+    time_point operationCompleted()
+    {
+        _inFlight.fetch_sub(1, std::memory_order_relaxed);
+        auto pending =
+            _pendingCompletions.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto maxPending =
+            _maxPendingCompletions.load(std::memory_order_relaxed);
+        while (pending > maxPending &&
+               !_maxPendingCompletions.compare_exchange_weak(
+                   maxPending, pending, std::memory_order_relaxed)) {
+        }
+        return std::chrono::steady_clock::now();
+    }
+
+    // Called on the JS thread right before the callback of an operation runs.
+    void completionDispatched(time_point queuedAt);
+
+    // Returns {in_flight, pending_completions, max_pending_completions,
+    // completion_delay_us} and starts a new interval for the histogram and
+    // the high-water mark.
+    Napi::Value takeSnapshot(Napi::Env env);
+
+private:
+    std::atomic<std::int64_t> _inFlight{0};
+    std::atomic<std::int64_t> _pendingCompletions{0};
+    std::atomic<std::int64_t> _maxPendingCompletions{0};
+    // Only ever touched from the JS thread.
+    LatencyHistogram _completionDelay;
+};
+
+// Latency and throughput of the operations of a Connection broken down by the
+// node they were last dispatched to, so that a single degraded node shows up
+// well before its operations start timing out.  Recorded on the io thread.
+//
+// Entries are created the first time a node and service are seen and are
+// then kept for the life of the connection, so that recording only allocates
+// once per pair.  Each has its own lock, and the map of entries is only
+// locked exclusively when a new one is added.
+class NodeStats
+{
+public:
+    void record(const char *service,
+                const std::optional<std::string> &lastDispatchedTo,
+                std::chrono::steady_clock::duration latency, bool failed);
+
+    // Returns {interval_s, nodes: {<node>: {<service>: {total_count,
+    // error_count, throughput_per_s, latency_us}}}} for the operations
+    // completed since the previous call, and starts a new interval.
+    Napi::Value takeSnapshot(Napi::Env env);
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        std::uint64_t totalCount{0};
+        std::uint64_t errorCount{0};
+        LatencyHistogram latency;
+    };
+
+    using ServiceMap =
+        std::map<std::string, std::unique_ptr<Entry>, std::less<>>;
+
+    Entry *findEntry(const std::string &node, std::string_view service);
+
+    std::shared_mutex _mutex;
+    std::map<std::string, ServiceMap, std::less<>> _nodes;
+    // Only ever touched from the JS thread.
+    std::chrono::steady_clock::time_point _intervalStart{
+        std::chrono::steady_clock::now()};
+};
+
+} // namespace couchnode
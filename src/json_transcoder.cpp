@@ -0,0 +1,829 @@
+#include "json_transcoder.hpp"
+#include "scratch_buffer.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace couchnode
+{
+
+// Documents nested deeper than this are left to JSON.stringify/JSON.parse,
+// which keeps the recursion here well clear of the native stack limit.
+static constexpr std::size_t MAX_DEPTH = 512;
+
+// Integers up to this magnitude are formatted and parsed exactly as int64s.
+static constexpr double MAX_SAFE_INTEGER = 9007199254740991.0;
+
+static void checkStatus(Napi::Env env, napi_status status)
+{
+    if (status != napi_ok) {
+        throw Napi::Error::New(env);
+    }
+}
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static void appendUtf8(std::string &out, std::uint32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+// Serializes a JS value to JSON text, following the SerializeJSONProperty
+// steps of JSON.stringify (without a replacer or indentation).
+class JsonEncoder
+{
+public:
+    JsonEncoder(Napi::Env env, std::string &out)
+        : _env(env)
+        , _out(out)
+        , _data(AddonData::fromEnv(env))
+    {
+    }
+
+    // Returns false if the value has no JSON representation (undefined,
+    // functions and symbols), in which case nothing was written.
+    bool encode(Napi::Value value)
+    {
+        _root = value;
+        return writeValue(value, Napi::String::New(_env, ""), 0);
+    }
+
+private:
+    // The key is used as the argument to toJSON.  For array elements, only
+    // the index is passed, and the key is created if it is needed.
+    bool writeValue(Napi::Value value, napi_value key, std::uint32_t index)
+    {
+        if (value.IsObject() && !value.IsFunction()) {
+            auto toJSON = value.As<Napi::Object>().Get("toJSON");
+            if (toJSON.IsFunction()) {
+                if (key == nullptr) {
+                    key = Napi::String::New(_env, std::to_string(index));
+                }
+                value = toJSON.As<Napi::Function>().Call(value, {key});
+            }
+        }
+
+        switch (value.Type()) {
+        case napi_undefined:
+        case napi_function:
+        case napi_symbol:
+            return false;
+        case napi_null:
+            _out.append("null");
+            return true;
+        case napi_boolean:
+            _out.append(value.As<Napi::Boolean>().Value() ? "true" : "false");
+            return true;
+        case napi_number:
+            writeNumber(value.As<Napi::Number>().DoubleValue());
+            return true;
+        case napi_string:
+            writeString(value);
+            return true;
+        case napi_object:
+            if (_stack.size() >= MAX_DEPTH) {
+                return writeWithStringify(value);
+            }
+            if (value.IsArray()) {
+                writeArray(value.As<Napi::Array>());
+                return true;
+            }
+            if (isPlainObject(value.As<Napi::Object>())) {
+                writeObject(value.As<Napi::Object>());
+                return true;
+            }
+            return writeWithStringify(value);
+        default:
+            // BigInts (which JSON.stringify rejects, unless a toJSON is
+            // installed for them) and externals.
+            return writeWithStringify(value);
+        }
+    }
+
+    // Objects from a different realm, class instances, boxed primitives,
+    // Maps and the like are left to JSON.stringify.
+    bool isPlainObject(Napi::Object obj)
+    {
+        napi_value proto;
+        checkStatus(_env, napi_get_prototype(_env, obj, &proto));
+        Napi::Value jsProto(_env, proto);
+        return jsProto.IsNull() ||
+               jsProto.StrictEquals(_data->_objectPrototype.Value());
+    }
+
+    bool writeWithStringify(Napi::Value value)
+    {
+        auto res = _data->_jsonStringify.Call({value});
+        if (!res.IsString()) {
+            return false;
+        }
+
+        // The output of JSON.stringify escapes any lone surrogates, so it
+        // always converts to UTF-8 without loss.
+        std::size_t len;
+        checkStatus(_env,
+                    napi_get_value_string_utf8(_env, res, nullptr, 0, &len));
+        auto offset = _out.size();
+        _out.resize(offset + len + 1);
+        checkStatus(_env, napi_get_value_string_utf8(_env, res, &_out[offset],
+                                                     len + 1, &len));
+        _out.resize(offset + len);
+        return true;
+    }
+
+    void enter(Napi::Object obj)
+    {
+        for (const auto &parent : _stack) {
+            if (obj.StrictEquals(Napi::Value(_env, parent))) {
+                // Let JSON.stringify produce its usual (descriptive) error.
+                _data->_jsonStringify.Call({_root});
+                throw Napi::TypeError::New(
+                    _env, "Converting circular structure to JSON");
+            }
+        }
+        _stack.push_back(obj);
+    }
+
+    void leave()
+    {
+        _stack.pop_back();
+    }
+
+    void writeArray(Napi::Array arr)
+    {
+        enter(arr);
+        _out.push_back('[');
+        auto length = arr.Length();
+        for (std::uint32_t i = 0; i < length; ++i) {
+            if (i > 0) {
+                _out.push_back(',');
+            }
+            if (!writeValue(arr.Get(i), nullptr, i)) {
+                _out.append("null");
+            }
+        }
+        _out.push_back(']');
+        leave();
+    }
+
+    void writeObject(Napi::Object obj)
+    {
+        enter(obj);
+
+        // The same keys, in the same order, as Object.keys().
+        napi_value keys;
+        checkStatus(_env, napi_get_all_property_names(
+                              _env, obj, napi_key_own_only,
+                              static_cast<napi_key_filter>(
+                                  napi_key_enumerable | napi_key_skip_symbols),
+                              napi_key_numbers_to_strings, &keys));
+        auto jsKeys = Napi::Array(_env, keys);
+
+        _out.push_back('{');
+        bool first = true;
+        auto length = jsKeys.Length();
+        for (std::uint32_t i = 0; i < length; ++i) {
+            auto key = jsKeys.Get(i);
+            auto mark = _out.size();
+            if (!first) {
+                _out.push_back(',');
+            }
+            writeString(key);
+            _out.push_back(':');
+            if (!writeValue(obj.Get(key), key, 0)) {
+                // Members without a JSON representation are omitted.
+                _out.resize(mark);
+                continue;
+            }
+            first = false;
+        }
+        _out.push_back('}');
+        leave();
+    }
+
+    // Formats a number as Number.prototype.toString() does.
+    void writeNumber(double value)
+    {
+        if (!std::isfinite(value)) {
+            _out.append("null");
+            return;
+        }
+        if (value == 0) {
+            // Including -0.
+            _out.push_back('0');
+            return;
+        }
+
+        char buf[32];
+        if (std::trunc(value) == value && std::abs(value) <= MAX_SAFE_INTEGER) {
+            auto res = std::to_chars(buf, buf + sizeof(buf),
+                                     static_cast<std::int64_t>(value));
+            _out.append(buf, res.ptr);
+            return;
+        }
+
+        if (value < 0) {
+            _out.push_back('-');
+            value = -value;
+        }
+
+        // The shortest digits which round-trip, and the decimal exponent.
+        std::string digits;
+        int exponent = 0;
+        formatShortest(value, buf, sizeof(buf));
+        for (const char *p = buf; *p != '\0'; ++p) {
+            if (*p >= '0' && *p <= '9') {
+                digits.push_back(*p);
+            } else if (*p == 'e') {
+                exponent = std::atoi(p + 1);
+                break;
+            }
+        }
+        while (digits.size() > 1 && digits.back() == '0') {
+            digits.pop_back();
+        }
+
+        auto k = static_cast<int>(digits.size());
+        auto n = exponent + 1;
+        if (k <= n && n <= 21) {
+            _out.append(digits);
+            _out.append(n - k, '0');
+        } else if (0 < n && n <= 21) {
+            _out.append(digits, 0, n);
+            _out.push_back('.');
+            _out.append(digits, n, std::string::npos);
+        } else if (-6 < n && n <= 0) {
+            _out.append("0.");
+            _out.append(-n, '0');
+            _out.append(digits);
+        } else {
+            _out.push_back(digits[0]);
+            if (k > 1) {
+                _out.push_back('.');
+                _out.append(digits, 1, std::string::npos);
+            }
+            _out.push_back('e');
+            _out.push_back(n - 1 >= 0 ? '+' : '-');
+            _out.append(std::to_string(std::abs(n - 1)));
+        }
+    }
+
+    // Writes the value in scientific notation with the fewest digits which
+    // parse back to the same value.
+    static void formatShortest(double value, char *buf, std::size_t size)
+    {
+#if defined(__cpp_lib_to_chars)
+        auto res =
+            std::to_chars(buf, buf + size - 1, value,
+                          std::chars_format::scientific);
+        *res.ptr = '\0';
+#else
+        for (int precision = 0; precision < 17; ++precision) {
+            std::snprintf(buf, size, "%.*e", precision, value);
+            if (std::strtod(buf, nullptr) == value) {
+                return;
+            }
+        }
+        std::snprintf(buf, size, "%.17e", value);
+#endif
+    }
+
+    // Writes a quoted string with the escaping of JSON.stringify, which
+    // escapes lone surrogates rather than replacing them.
+    void writeString(Napi::Value value)
+    {
+        std::size_t len;
+        checkStatus(_env,
+                    napi_get_value_string_utf16(_env, value, nullptr, 0, &len));
+        _utf16.resize(len + 1);
+        checkStatus(_env, napi_get_value_string_utf16(_env, value, &_utf16[0],
+                                                      len + 1, &len));
+
+        _out.push_back('"');
+        for (std::size_t i = 0; i < len; ++i) {
+            std::uint32_t c = _utf16[i];
+            if (c < 0x80) {
+                switch (c) {
+                case '"':
+                    _out.append("\\\"");
+                    break;
+                case '\\':
+                    _out.append("\\\\");
+                    break;
+                case '\b':
+                    _out.append("\\b");
+                    break;
+                case '\f':
+                    _out.append("\\f");
+                    break;
+                case '\n':
+                    _out.append("\\n");
+                    break;
+                case '\r':
+                    _out.append("\\r");
+                    break;
+                case '\t':
+                    _out.append("\\t");
+                    break;
+                default:
+                    if (c < 0x20) {
+                        writeUnicodeEscape(c);
+                    } else {
+                        _out.push_back(static_cast<char>(c));
+                    }
+                }
+            } else if (c >= 0xd800 && c <= 0xdfff) {
+                std::uint32_t next = i + 1 < len ? _utf16[i + 1] : 0;
+                if (c <= 0xdbff && next >= 0xdc00 && next <= 0xdfff) {
+                    auto cp = 0x10000 + ((c - 0xd800) << 10) + (next - 0xdc00);
+                    appendUtf8(_out, cp);
+                    ++i;
+                } else {
+                    writeUnicodeEscape(c);
+                }
+            } else {
+                appendUtf8(_out, c);
+            }
+        }
+        _out.push_back('"');
+    }
+
+    void writeUnicodeEscape(std::uint32_t c)
+    {
+        _out.append("\\u");
+        _out.push_back(HEX_DIGITS[(c >> 12) & 0xf]);
+        _out.push_back(HEX_DIGITS[(c >> 8) & 0xf]);
+        _out.push_back(HEX_DIGITS[(c >> 4) & 0xf]);
+        _out.push_back(HEX_DIGITS[c & 0xf]);
+    }
+
+    Napi::Env _env;
+    std::string &_out;
+    AddonData *_data;
+    Napi::Value _root;
+    std::vector<napi_value> _stack;
+    std::u16string _utf16;
+};
+
+// Parses JSON text into JS values.  Any input this does not accept is left
+// to JSON.parse: invalid JSON (so that the error handling stays in one
+// place), escaped lone surrogates (which UTF-8 cannot hold), numbers out of
+// the range of a double and very deeply nested documents.
+class JsonParser
+{
+public:
+    JsonParser(Napi::Env env, const char *data, std::size_t size)
+        : _env(env)
+        , _pos(data)
+        , _end(data + size)
+    {
+    }
+
+    // Returns an empty value if the input should be left to JSON.parse.
+    Napi::Value parse()
+    {
+        Napi::Value result;
+        if (!parseValue(result, 0)) {
+            return Napi::Value();
+        }
+        skipWhitespace();
+        if (_pos != _end) {
+            return Napi::Value();
+        }
+        return result;
+    }
+
+private:
+    void skipWhitespace()
+    {
+        while (_pos != _end &&
+               (*_pos == ' ' || *_pos == '\n' || *_pos == '\r' ||
+                *_pos == '\t')) {
+            ++_pos;
+        }
+    }
+
+    bool consumeLiteral(const char *literal, std::size_t len)
+    {
+        if (static_cast<std::size_t>(_end - _pos) < len ||
+            std::memcmp(_pos, literal, len) != 0) {
+            return false;
+        }
+        _pos += len;
+        return true;
+    }
+
+    bool parseValue(Napi::Value &result, std::size_t depth)
+    {
+        skipWhitespace();
+        if (_pos == _end) {
+            return false;
+        }
+
+        switch (*_pos) {
+        case '{':
+            return parseObject(result, depth);
+        case '[':
+            return parseArray(result, depth);
+        case '"': {
+            const char *str;
+            std::size_t len;
+            if (!parseString(str, len)) {
+                return false;
+            }
+            result = Napi::String::New(_env, str, len);
+            return true;
+        }
+        case 't':
+            result = Napi::Boolean::New(_env, true);
+            return consumeLiteral("true", 4);
+        case 'f':
+            result = Napi::Boolean::New(_env, false);
+            return consumeLiteral("false", 5);
+        case 'n':
+            result = _env.Null();
+            return consumeLiteral("null", 4);
+        default:
+            return parseNumber(result);
+        }
+    }
+
+    // Members are collected as the object is parsed and then defined
+    // together, which takes one call per object rather than one per member.
+    // Defining them creates own properties, as JSON.parse does, where a
+    // plain set of "__proto__" would replace the prototype of the object.
+    // Nested objects push their members after ours and truncate them again
+    // when done.
+    bool parseObject(Napi::Value &result, std::size_t depth)
+    {
+        if (depth >= MAX_DEPTH) {
+            return false;
+        }
+        ++_pos;
+
+        skipWhitespace();
+        if (_pos != _end && *_pos == '}') {
+            ++_pos;
+            result = Napi::Object::New(_env);
+            return true;
+        }
+
+        auto first = _members.size();
+        while (true) {
+            skipWhitespace();
+            if (_pos == _end || *_pos != '"') {
+                return false;
+            }
+            const char *keyStr;
+            std::size_t keyLen;
+            if (!parseString(keyStr, keyLen)) {
+                return false;
+            }
+            auto key = Napi::String::New(_env, keyStr, keyLen);
+
+            skipWhitespace();
+            if (_pos == _end || *_pos != ':') {
+                return false;
+            }
+            ++_pos;
+
+            Napi::Value value;
+            if (!parseValue(value, depth + 1)) {
+                return false;
+            }
+            napi_property_descriptor desc = {};
+            desc.name = key;
+            desc.value = value;
+            desc.attributes = static_cast<napi_property_attributes>(
+                napi_writable | napi_enumerable | napi_configurable);
+            _members.push_back(desc);
+
+            skipWhitespace();
+            if (_pos == _end) {
+                return false;
+            }
+            if (*_pos == ',') {
+                ++_pos;
+                continue;
+            }
+            if (*_pos == '}') {
+                ++_pos;
+                auto obj = Napi::Object::New(_env);
+                checkStatus(_env, napi_define_properties(
+                                      _env, obj, _members.size() - first,
+                                      &_members[first]));
+                _members.resize(first);
+                result = obj;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool parseArray(Napi::Value &result, std::size_t depth)
+    {
+        if (depth >= MAX_DEPTH) {
+            return false;
+        }
+        ++_pos;
+
+        auto arr = Napi::Array::New(_env);
+        skipWhitespace();
+        if (_pos != _end && *_pos == ']') {
+            ++_pos;
+            result = arr;
+            return true;
+        }
+
+        std::uint32_t index = 0;
+        while (true) {
+            Napi::Value value;
+            if (!parseValue(value, depth + 1)) {
+                return false;
+            }
+            arr.Set(index++, value);
+
+            skipWhitespace();
+            if (_pos == _end) {
+                return false;
+            }
+            if (*_pos == ',') {
+                ++_pos;
+                continue;
+            }
+            if (*_pos == ']') {
+                ++_pos;
+                result = arr;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    // Parses a quoted string.  The UTF-8 contents are left pointing into the
+    // input if the string has no escapes, or into a scratch buffer which is
+    // only valid until the next string is parsed.  Invalid UTF-8 is passed
+    // through, and replaced when the JS string is created, as it is when
+    // the bytes are decoded in JS.
+    bool parseString(const char *&str, std::size_t &len)
+    {
+        ++_pos;
+        const char *start = _pos;
+        while (_pos != _end) {
+            auto c = static_cast<unsigned char>(*_pos);
+            if (c == '"') {
+                str = start;
+                len = _pos - start;
+                ++_pos;
+                return true;
+            }
+            if (c == '\\') {
+                break;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            ++_pos;
+        }
+        if (_pos == _end) {
+            return false;
+        }
+
+        _scratch.assign(start, _pos);
+        while (_pos != _end) {
+            auto c = static_cast<unsigned char>(*_pos++);
+            if (c == '"') {
+                str = _scratch.data();
+                len = _scratch.size();
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                _scratch.push_back(static_cast<char>(c));
+                continue;
+            }
+            if (_pos == _end) {
+                return false;
+            }
+            switch (*_pos++) {
+            case '"':
+                _scratch.push_back('"');
+                break;
+            case '\\':
+                _scratch.push_back('\\');
+                break;
+            case '/':
+                _scratch.push_back('/');
+                break;
+            case 'b':
+                _scratch.push_back('\b');
+                break;
+            case 'f':
+                _scratch.push_back('\f');
+                break;
+            case 'n':
+                _scratch.push_back('\n');
+                break;
+            case 'r':
+                _scratch.push_back('\r');
+                break;
+            case 't':
+                _scratch.push_back('\t');
+                break;
+            case 'u': {
+                std::uint32_t cp;
+                if (!parseUnicodeEscape(cp)) {
+                    return false;
+                }
+                if (cp >= 0xd800 && cp <= 0xdbff) {
+                    std::uint32_t low;
+                    if (!consumeLiteral("\\u", 2) || !parseUnicodeEscape(low) ||
+                        low < 0xdc00 || low > 0xdfff) {
+                        return false;
+                    }
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                } else if (cp >= 0xdc00 && cp <= 0xdfff) {
+                    return false;
+                }
+                appendUtf8(_scratch, cp);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseUnicodeEscape(std::uint32_t &cp)
+    {
+        if (_end - _pos < 4) {
+            return false;
+        }
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            auto c = *_pos++;
+            cp <<= 4;
+            if (c >= '0' && c <= '9') {
+                cp |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                cp |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                cp |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    bool parseNumber(Napi::Value &result)
+    {
+        const char *start = _pos;
+        bool negative = false;
+        if (*_pos == '-') {
+            negative = true;
+            ++_pos;
+        }
+        if (_pos == _end) {
+            return false;
+        }
+        if (*_pos == '0') {
+            ++_pos;
+        } else if (isDigit(*_pos)) {
+            while (_pos != _end && isDigit(*_pos)) {
+                ++_pos;
+            }
+        } else {
+            return false;
+        }
+
+        bool isInteger = true;
+        if (_pos != _end && *_pos == '.') {
+            isInteger = false;
+            ++_pos;
+            if (_pos == _end || !isDigit(*_pos)) {
+                return false;
+            }
+            while (_pos != _end && isDigit(*_pos)) {
+                ++_pos;
+            }
+        }
+        if (_pos != _end && (*_pos == 'e' || *_pos == 'E')) {
+            isInteger = false;
+            ++_pos;
+            if (_pos != _end && (*_pos == '+' || *_pos == '-')) {
+                ++_pos;
+            }
+            if (_pos == _end || !isDigit(*_pos)) {
+                return false;
+            }
+            while (_pos != _end && isDigit(*_pos)) {
+                ++_pos;
+            }
+        }
+
+        // Up to 15 digits always fit in a double exactly.
+        auto numDigits = (_pos - start) - (negative ? 1 : 0);
+        if (isInteger && numDigits <= 15) {
+            std::int64_t value = 0;
+            for (const char *p = start + (negative ? 1 : 0); p != _pos; ++p) {
+                value = value * 10 + (*p - '0');
+            }
+            double number = static_cast<double>(value);
+            result = Napi::Number::New(_env, negative ? -number : number);
+            return true;
+        }
+
+        // strtod rounds correctly, as JSON.parse does, but needs the number
+        // to be terminated.
+        std::string text(start, _pos);
+        char *parsedEnd;
+        double value = std::strtod(text.c_str(), &parsedEnd);
+        if (parsedEnd != text.c_str() + text.size()) {
+            return false;
+        }
+        result = Napi::Number::New(_env, value);
+        return true;
+    }
+
+    Napi::Env _env;
+    const char *_pos;
+    const char *_end;
+    std::string _scratch;
+    std::vector<napi_property_descriptor> _members;
+};
+
+void JsonTranscoder::Init(Napi::Env env, Napi::Object exports)
+{
+    auto data = AddonData::fromEnv(env);
+    auto global = env.Global();
+    data->_jsonStringify = Napi::Persistent(global.Get("JSON")
+                                                .As<Napi::Object>()
+                                                .Get("stringify")
+                                                .As<Napi::Function>());
+    data->_objectPrototype = Napi::Persistent(global.Get("Object")
+                                                  .As<Napi::Object>()
+                                                  .Get("prototype")
+                                                  .As<Napi::Object>());
+
+    exports.Set("jsonEncode", Napi::Function::New<jsEncode>(env));
+    exports.Set("jsonDecode", Napi::Function::New<jsDecode>(env));
+}
+
+Napi::Value JsonTranscoder::jsEncode(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    ScratchBuffer buffer;
+    JsonEncoder encoder(env, buffer.get());
+    if (!encoder.encode(info[0])) {
+        return env.Undefined();
+    }
+    return Napi::Buffer<char>::Copy(env, buffer.get().data(),
+                                    buffer.get().size());
+}
+
+Napi::Value JsonTranscoder::jsDecode(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    if (!info[0].IsBuffer()) {
+        return env.Undefined();
+    }
+
+    auto bytes = info[0].As<Napi::Buffer<char>>();
+    JsonParser parser(env, bytes.Data(), bytes.Length());
+    auto result = parser.parse();
+    if (result.IsEmpty()) {
+        return env.Undefined();
+    }
+    return result;
+}
+
+} // namespace couchnode
@@ -0,0 +1,29 @@
+#pragma once
+#include "addondata.hpp"
+#include <napi.h>
+
+namespace couchnode
+{
+
+// Native JSON encoding and decoding for the DefaultTranscoder.  Values are
+// serialized straight from V8 into the bytes of the returned Buffer, and
+// response bytes are parsed straight into V8 values, so neither direction
+// goes through an intermediate JS string.
+//
+// The output matches JSON.stringify and JSON.parse exactly.  Values the
+// encoder does not handle natively (class instances, boxed primitives,
+// BigInts, ...) are handed to JSON.stringify, and both functions return
+// undefined when the caller should fall back to the JS implementation.
+class JsonTranscoder
+{
+public:
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    // jsonEncode(value) -> Buffer | undefined
+    static Napi::Value jsEncode(const Napi::CallbackInfo &info);
+
+    // jsonDecode(bytes) -> any | undefined
+    static Napi::Value jsDecode(const Napi::CallbackInfo &info);
+};
+
+} // namespace couchnode
@@ -86,5 +86,52 @@ size_t get_cbpp_retries(const couchbase::core::query_error_context &ctx)
 {
     return ctx.retry_attempts();
 }
+template <typename T>
+static inline std::error_code get_cbpp_error_code(const T &ctx)
+{
+    return ctx.ec;
+}
+template <>
+std::error_code
+get_cbpp_error_code(const couchbase::core::key_value_error_context &ctx)
+{
+    return ctx.ec();
+}
+template <>
+std::error_code
+get_cbpp_error_code(const couchbase::core::subdocument_error_context &ctx)
+{
+    return ctx.ec();
+}
+template <>
+std::error_code
+get_cbpp_error_code(const couchbase::core::query_error_context &ctx)
+{
+    return ctx.ec();
+}
+template <typename T>
+static inline std::optional<std::string>
+get_cbpp_last_dispatched_to(const T &ctx)
+{
+    return ctx.last_dispatched_to;
+}
+template <>
+std::optional<std::string> get_cbpp_last_dispatched_to(
+    const couchbase::core::key_value_error_context &ctx)
+{
+    return ctx.last_dispatched_to();
+}
+template <>
+std::optional<std::string> get_cbpp_last_dispatched_to(
+    const couchbase::core::subdocument_error_context &ctx)
+{
+    return ctx.last_dispatched_to();
+}
+template <>
+std::optional<std::string>
+get_cbpp_last_dispatched_to(const couchbase::core::query_error_context &ctx)
+{
+    return ctx.last_dispatched_to();
+}
 
 } // namespace couchnode
@@ -12,26 +12,122 @@
 #include <core/transactions/transaction_get_multi_result.hxx>
 #include <core/utils/json.hxx>
 
+#include <cmath>
+
 namespace cbtxns = couchbase::transactions;
 namespace cbcoretxns = couchbase::core::transactions;
 
 namespace couchnode
 {
 
-// nlohmann::json (used by transactions currently)
+// JSON values held by transactions (such as forward compatibility data) are
+// converted directly between the tao::json DOM and V8 values rather than
+// being generated to and parsed from an intermediate string.
 template <>
 struct js_to_cbpp_t<tao::json::value> {
     static inline Napi::Value to_js(Napi::Env env,
                                     const tao::json::value &cppObj)
     {
-        return Napi::String::New(
-            env, couchbase::core::utils::json::generate(cppObj));
+        // Integers which a double cannot represent exactly are surfaced as
+        // BigInts so that they round-trip without loss.
+        static constexpr std::int64_t maxSafeInteger = (1LL << 53) - 1;
+
+        switch (cppObj.type()) {
+        case tao::json::type::NULL_:
+            return env.Null();
+        case tao::json::type::BOOLEAN:
+            return Napi::Boolean::New(env, cppObj.get_boolean());
+        case tao::json::type::SIGNED: {
+            auto value = cppObj.get_signed();
+            if (value > maxSafeInteger || value < -maxSafeInteger) {
+                return Napi::BigInt::New(env, value);
+            }
+            return Napi::Number::New(env, static_cast<double>(value));
+        }
+        case tao::json::type::UNSIGNED: {
+            auto value = cppObj.get_unsigned();
+            if (value > static_cast<std::uint64_t>(maxSafeInteger)) {
+                return Napi::BigInt::New(env, value);
+            }
+            return Napi::Number::New(env, static_cast<double>(value));
+        }
+        case tao::json::type::DOUBLE:
+            return Napi::Number::New(env, cppObj.get_double());
+        case tao::json::type::STRING:
+            return Napi::String::New(env, cppObj.get_string());
+        case tao::json::type::STRING_VIEW: {
+            auto value = cppObj.get_string_view();
+            return Napi::String::New(env, value.data(), value.size());
+        }
+        case tao::json::type::ARRAY: {
+            const auto &cppArr = cppObj.get_array();
+            auto jsArr = Napi::Array::New(env, cppArr.size());
+            for (std::size_t i = 0; i < cppArr.size(); ++i) {
+                jsArr.Set(i, to_js(env, cppArr[i]));
+            }
+            return jsArr;
+        }
+        case tao::json::type::OBJECT: {
+            auto jsObj = Napi::Object::New(env);
+            for (const auto &[key, value] : cppObj.get_object()) {
+                jsObj.Set(key, to_js(env, value));
+            }
+            return jsObj;
+        }
+        default:
+            return env.Undefined();
+        }
     }
 
     static inline tao::json::value from_js(Napi::Value jsVal)
     {
-        auto cppStr = jsVal.As<Napi::String>().Utf8Value();
-        return couchbase::core::utils::json::parse(cppStr);
+        if (jsVal.IsNull() || jsVal.IsUndefined()) {
+            return tao::json::null;
+        }
+        if (jsVal.IsBoolean()) {
+            return tao::json::value(jsVal.As<Napi::Boolean>().Value());
+        }
+        if (jsVal.IsNumber()) {
+            auto value = jsVal.As<Napi::Number>().DoubleValue();
+            if (std::trunc(value) == value &&
+                std::abs(value) <= 9007199254740991.0) {
+                return tao::json::value(static_cast<std::int64_t>(value));
+            }
+            return tao::json::value(value);
+        }
+        if (jsVal.IsBigInt()) {
+            bool lossless;
+            auto value = jsVal.As<Napi::BigInt>().Int64Value(&lossless);
+            if (lossless) {
+                return tao::json::value(value);
+            }
+            return tao::json::value(
+                jsVal.As<Napi::BigInt>().Uint64Value(&lossless));
+        }
+        if (jsVal.IsString()) {
+            return tao::json::value(jsVal.As<Napi::String>().Utf8Value());
+        }
+        if (jsVal.IsArray()) {
+            auto jsArr = jsVal.As<Napi::Array>();
+            tao::json::value cppArr = tao::json::empty_array;
+            auto &elems = cppArr.get_array();
+            elems.reserve(jsArr.Length());
+            for (uint32_t i = 0; i < jsArr.Length(); ++i) {
+                elems.emplace_back(from_js(jsArr.Get(i)));
+            }
+            return cppArr;
+        }
+
+        auto jsObj = jsVal.As<Napi::Object>();
+        tao::json::value cppObj = tao::json::empty_object;
+        auto &members = cppObj.get_object();
+        auto jsKeys = jsObj.GetPropertyNames();
+        for (uint32_t i = 0; i < jsKeys.Length(); ++i) {
+            auto jsKey = jsKeys.Get(i);
+            members.emplace(jsKey.As<Napi::String>().Utf8Value(),
+                            from_js(jsObj.Get(jsKey)));
+        }
+        return cppObj;
     }
 };
 
@@ -0,0 +1,76 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+#include <hdr/hdr_histogram.h>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace couchnode
+{
+
+static constexpr int SIGNIFICANT_FIGURES = 3;
+static constexpr double REPORTED_PERCENTILES[] = {50.0, 90.0, 99.0, 99.9,
+                                                  100.0};
+
+// Produces the same keys as Number.prototype.toString in JS, which is what
+// the reports have always been keyed by (e.g. "50" and "99.9").
+static std::string percentileKey(double percentile)
+{
+    std::ostringstream oss;
+    oss << percentile;
+    return oss.str();
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    if (hdr_init(LOWEST_DISCERNIBLE_VALUE, HIGHEST_TRACKABLE_VALUE,
+                 SIGNIFICANT_FIGURES, &_histogram) != 0) {
+        throw std::bad_alloc();
+    }
+}
+
+LatencyHistogram::LatencyHistogram(LatencyHistogram &&o) noexcept
+    : _histogram(std::exchange(o._histogram, nullptr))
+{
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+    if (_histogram) {
+        hdr_close(_histogram);
+    }
+}
+
+void LatencyHistogram::record(std::int64_t valueMicros)
+{
+    hdr_record_value(_histogram,
+                     std::clamp(valueMicros, LOWEST_DISCERNIBLE_VALUE,
+                                HIGHEST_TRACKABLE_VALUE));
+}
+
+std::int64_t LatencyHistogram::totalCount() const
+{
+    return _histogram->total_count;
+}
+
+Napi::Object LatencyHistogram::takeSnapshot(Napi::Env env)
+{
+    auto jsPercentiles = Napi::Object::New(env);
+    for (auto percentile : REPORTED_PERCENTILES) {
+        jsPercentiles.Set(
+            percentileKey(percentile),
+            Napi::Number::New(env,
+                              static_cast<double>(hdr_value_at_percentile(
+                                  _histogram, percentile))));
+    }
+
+    auto resObj = Napi::Object::New(env);
+    resObj.Set("total_count", Napi::Number::New(env, static_cast<double>(
+                                                         totalCount())));
+    resObj.Set("percentiles_us", jsPercentiles);
+    hdr_reset(_histogram);
+    return resObj;
+}
+
+} // namespace couchnode
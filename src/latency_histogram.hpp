@@ -0,0 +1,35 @@
+#pragma once
+#include <napi.h>
+#include <cstdint>
+
+struct hdr_histogram;
+
+namespace couchnode
+{
+
+// An HDR histogram of latencies in microseconds, tracking 1us to 30s at 3
+// significant digits.  Values outside of that range are clamped.  This is
+// not synchronized; owners which record from the io threads must lock.
+class LatencyHistogram
+{
+public:
+    static constexpr std::int64_t LOWEST_DISCERNIBLE_VALUE = 1;
+    static constexpr std::int64_t HIGHEST_TRACKABLE_VALUE = 30'000'000;
+
+    LatencyHistogram();
+    LatencyHistogram(LatencyHistogram &&o) noexcept;
+    LatencyHistogram(const LatencyHistogram &o) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &o) = delete;
+    ~LatencyHistogram();
+
+    void record(std::int64_t valueMicros);
+    std::int64_t totalCount() const;
+
+    // Returns {total_count, percentiles_us} and resets the histogram.
+    Napi::Object takeSnapshot(Napi::Env env);
+
+private:
+    hdr_histogram *_histogram{nullptr};
+};
+
+} // namespace couchnode
@@ -0,0 +1,109 @@
+#include "operation_meter.hpp"
+#include <algorithm>
+
+namespace couchnode
+{
+
+void OperationMeter::Init(Napi::Env env, Napi::Object exports)
+{
+    Napi::Function func = DefineClass(
+        env, "OperationMeter",
+        {
+            InstanceMethod<&OperationMeter::jsRecorder>("recorder"),
+            InstanceMethod<&OperationMeter::jsRecord>("record"),
+            InstanceMethod<&OperationMeter::jsSnapshot>("snapshot"),
+        });
+
+    constructor(env) = Napi::Persistent(func);
+    exports.Set("OperationMeter", func);
+}
+
+OperationMeter::OperationMeter(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<OperationMeter>(info)
+    , _state(std::make_shared<OperationMeterState>())
+{
+}
+
+OperationMeter::~OperationMeter()
+{
+}
+
+std::size_t OperationMeterState::recorderId(const std::string &service,
+                                            const std::string &op)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto key = std::make_pair(service, op);
+    auto it = _recorderIds.find(key);
+    if (it != _recorderIds.end()) {
+        return it->second;
+    }
+
+    auto id = _recorders.size();
+    _recorders.push_back(Recorder{service, op, LatencyHistogram()});
+    _recorderIds.emplace(std::move(key), id);
+    return id;
+}
+
+void OperationMeterState::record(std::size_t id, std::int64_t valueMicros)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (id < _recorders.size()) {
+        _recorders[id].histogram.record(valueMicros);
+    }
+}
+
+Napi::Value OperationMeter::jsRecorder(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto service = info[0].ToString().Utf8Value();
+    auto op = info[1].ToString().Utf8Value();
+
+    try {
+        return Napi::Number::New(
+            env, static_cast<double>(_state->recorderId(service, op)));
+    } catch (const std::bad_alloc &) {
+        throw Napi::Error::New(env, "failed to allocate histogram");
+    }
+}
+
+Napi::Value OperationMeter::jsRecord(const Napi::CallbackInfo &info)
+{
+    auto id = info[0].As<Napi::Number>().Uint32Value();
+    auto value = info[1].As<Napi::Number>().DoubleValue();
+    // Written so that NaN also falls back to the lowest value.
+    if (!(value > 0)) {
+        value = 0;
+    }
+    value = std::min(value, static_cast<double>(
+                                LatencyHistogram::HIGHEST_TRACKABLE_VALUE));
+    _state->record(id, static_cast<std::int64_t>(value));
+    return info.Env().Undefined();
+}
+
+Napi::Value OperationMeter::jsSnapshot(const Napi::CallbackInfo &info)
+{
+    return _state->takeSnapshot(info.Env());
+}
+
+Napi::Value OperationMeterState::takeSnapshot(Napi::Env env)
+{
+    auto resObj = Napi::Object::New(env);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &recorder : _recorders) {
+        if (recorder.histogram.totalCount() == 0) {
+            continue;
+        }
+
+        if (!resObj.Has(recorder.service)) {
+            resObj.Set(recorder.service, Napi::Object::New(env));
+        }
+        resObj.Get(recorder.service)
+            .As<Napi::Object>()
+            .Set(recorder.op, recorder.histogram.takeSnapshot(env));
+    }
+
+    return resObj;
+}
+
+} // namespace couchnode
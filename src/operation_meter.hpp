@@ -0,0 +1,69 @@
+#pragma once
+#include "addondata.hpp"
+#include "latency_histogram.hpp"
+#include "napi.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace couchnode
+{
+
+// Latency histograms for each (service, operation) pair, in microseconds.
+// Recording only takes a lock and bumps a bucket, so it is cheap enough to
+// happen on every operation, and is done on the io thread for operations
+// dispatched through a Connection.  The percentiles are only computed when a
+// snapshot is taken at emit time.
+class OperationMeterState
+{
+public:
+    // Returns the id of the histogram for the operation, creating it if this
+    // is the first time the operation has been seen.
+    std::size_t recorderId(const std::string &service, const std::string &op);
+    void record(std::size_t id, std::int64_t valueMicros);
+
+    // Returns {<service>: {<op>: {total_count, percentiles_us}}} for every
+    // operation recorded since the last snapshot and resets the histograms.
+    Napi::Value takeSnapshot(Napi::Env env);
+
+private:
+    struct Recorder {
+        std::string service;
+        std::string op;
+        LatencyHistogram histogram;
+    };
+
+    std::mutex _mutex;
+    std::deque<Recorder> _recorders;
+    std::map<std::pair<std::string, std::string>, std::size_t> _recorderIds;
+};
+
+class OperationMeter : public Napi::ObjectWrap<OperationMeter>
+{
+public:
+    static Napi::FunctionReference &constructor(Napi::Env env)
+    {
+        return AddonData::fromEnv(env)->_operationMeterCtor;
+    }
+
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    OperationMeter(const Napi::CallbackInfo &info);
+    ~OperationMeter();
+
+    std::shared_ptr<OperationMeterState> state() const
+    {
+        return _state;
+    }
+
+    Napi::Value jsRecorder(const Napi::CallbackInfo &info);
+    Napi::Value jsRecord(const Napi::CallbackInfo &info);
+    Napi::Value jsSnapshot(const Napi::CallbackInfo &info);
+
+private:
+    std::shared_ptr<OperationMeterState> _state;
+};
+
+} // namespace couchnode
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Statically defined tracepoints (USDT) under the "couchnode" provider, for
+// use with bpftrace, perf or systemtap against the loaded addon.  Each probe
+// is a single nop plus an ELF note until a tracer attaches to it, so they are
+// left in release builds.  Arguments are evaluated regardless, so only pass
+// values which are already at hand.
+//
+//   op__start(id, name)          Connection::executeOp issued a request
+//   op__done(id, service, ec, latency_us)
+//                                the request completed on the io thread
+//   cookie__enqueue(completion)  a completion was queued for the JS thread
+//   cookie__dispatch(completion) the queued completion reached the JS thread
+//   scan__next__start(iterator)  ScanIterator::next was called
+//   scan__next__done(iterator, ec)
+//                                the next scan item became available
+//   txn__op__start(slot, stage)  a transaction operation was issued
+//   txn__op__done(slot, stage, latency_us)
+//                                the transaction operation completed
+//   txn__op__dispatch(slot, stage)
+//                                its completion reached the JS thread
+//
+// The id, completion, iterator and slot arguments are only meant to pair up
+// the start and end of the same operation.  Op ids come from nextProbeOpId(),
+// as timestamps can collide between requests issued in quick succession.
+#if defined(__linux__) && !defined(COUCHNODE_DISABLE_USDT) &&                  \
+    __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define COUCHNODE_PROBE1(name, a1) DTRACE_PROBE1(couchnode, name, a1)
+#define COUCHNODE_PROBE2(name, a1, a2) DTRACE_PROBE2(couchnode, name, a1, a2)
+#define COUCHNODE_PROBE3(name, a1, a2, a3)                                     \
+    DTRACE_PROBE3(couchnode, name, a1, a2, a3)
+#define COUCHNODE_PROBE4(name, a1, a2, a3, a4)                                 \
+    DTRACE_PROBE4(couchnode, name, a1, a2, a3, a4)
+#else
+// Still reference the arguments so that values computed only for a probe do
+// not trigger unused warnings; they have no side effects and are elided.
+#define COUCHNODE_PROBE1(name, a1) ((void)(a1))
+#define COUCHNODE_PROBE2(name, a1, a2) ((void)(a1), (void)(a2))
+#define COUCHNODE_PROBE3(name, a1, a2, a3) ((void)(a1), (void)(a2), (void)(a3))
+#define COUCHNODE_PROBE4(name, a1, a2, a3, a4)                                 \
+    ((void)(a1), (void)(a2), (void)(a3), (void)(a4))
+#endif
+
+namespace couchnode
+{
+
+inline std::uint64_t nextProbeOpId()
+{
+    static std::atomic<std::uint64_t> nextId{0};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace couchnode
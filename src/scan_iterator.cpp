@@ -1,17 +1,210 @@
 #include "scan_iterator.hpp"
 #include "connection.hpp"
 #include "jstocbpp.hpp"
+#include "probes.hpp"
+#include "value_compression.hpp"
+#include <algorithm>
+#include <asio/post.hpp>
 
 namespace couchnode
 {
 
+static constexpr std::uint8_t SCAN_CHECKPOINT_VERSION = 1;
+
+template <typename T>
+static void writeLE(std::vector<std::byte> &out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xff));
+    }
+}
+
+template <typename T>
+static bool readLE(const std::byte *&data, const std::byte *end, T &value)
+{
+    if (static_cast<std::size_t>(end - data) < sizeof(T)) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(std::to_integer<std::uint8_t>(data[i]))
+                 << (i * 8);
+    }
+    data += sizeof(T);
+    return true;
+}
+
+// Layout (little endian):
+//   u8 version, u16 vbucket count, u16 entry count,
+//   entries of { u16 vbucket, u32 key length, key bytes }
+std::vector<std::byte> ScanCheckpoint::encode() const
+{
+    std::vector<std::byte> out;
+    writeLE<std::uint8_t>(out, SCAN_CHECKPOINT_VERSION);
+    writeLE<std::uint16_t>(out, static_cast<std::uint16_t>(_numVbuckets));
+    writeLE<std::uint16_t>(out, static_cast<std::uint16_t>(_lastKeys.size()));
+    for (const auto &[vbucket, key] : _lastKeys) {
+        writeLE<std::uint16_t>(out, vbucket);
+        writeLE<std::uint32_t>(out, static_cast<std::uint32_t>(key.size()));
+        auto keyBytes = reinterpret_cast<const std::byte *>(key.data());
+        out.insert(out.end(), keyBytes, keyBytes + key.size());
+    }
+    return out;
+}
+
+std::optional<ScanCheckpoint> ScanCheckpoint::decode(const std::byte *data,
+                                                     std::size_t size)
+{
+    const std::byte *end = data + size;
+    std::uint8_t version;
+    std::uint16_t numVbuckets, numEntries;
+    if (!readLE(data, end, version) || version != SCAN_CHECKPOINT_VERSION ||
+        !readLE(data, end, numVbuckets) || !readLE(data, end, numEntries)) {
+        return {};
+    }
+
+    ScanCheckpoint checkpoint(numVbuckets);
+    for (std::uint16_t i = 0; i < numEntries; ++i) {
+        std::uint16_t vbucket;
+        std::uint32_t keyLen;
+        if (!readLE(data, end, vbucket) || !readLE(data, end, keyLen) ||
+            vbucket >= numVbuckets ||
+            static_cast<std::size_t>(end - data) < keyLen) {
+            return {};
+        }
+        checkpoint.update(vbucket,
+                          std::string(reinterpret_cast<const char *>(data),
+                                      keyLen));
+        data += keyLen;
+    }
+    return checkpoint;
+}
+
+bool ScanCheckpoint::seen(std::uint16_t vbucket, const std::string &key) const
+{
+    auto it = _lastKeys.find(vbucket);
+    return it != _lastKeys.end() && key <= it->second;
+}
+
+// Buffered scan items are handed over synchronously, so fetching one item
+// from the completion of another nests on the stack.  After this many nested
+// fetches the next one is posted to the io context instead, which bounds the
+// stack depth however many items are collected or skipped.
+static constexpr std::size_t MAX_NESTED_SCAN_FETCHES = 64;
+
+struct ScanItemSource {
+    std::shared_ptr<couchbase::core::scan_result> result;
+    std::shared_ptr<couchbase::core::topology::configuration> config;
+    std::shared_ptr<const ScanCheckpoint> resumeFrom;
+    asio::io_context *io;
+    std::size_t depth{0};
+};
+
+// Runs fn, which fetches the next item of source, either directly or, once
+// too many fetches have nested, from the io context.
+template <typename Fn>
+static void continueScan(ScanItemSource &&source, Fn &&fn)
+{
+    if (++source.depth < MAX_NESTED_SCAN_FETCHES) {
+        fn(std::move(source));
+        return;
+    }
+
+    source.depth = 0;
+    asio::post(*source.io,
+               [source = std::move(source),
+                fn = std::forward<Fn>(fn)]() mutable {
+                   fn(std::move(source));
+               });
+}
+
+// Fetches the next item of the scan on the io thread, transparently skipping
+// any items which were already delivered before the checkpoint the scan was
+// resumed from.  The vbucket of the item is only resolved when a config was
+// provided, which is the case only when progress is being tracked.
+template <typename Handler>
+static void nextScanItem(ScanItemSource source, Handler &&handler)
+{
+    auto &scanResult = *source.result;
+    scanResult.next([source = std::move(source),
+                     handler = std::forward<Handler>(handler)](
+                        couchbase::core::range_scan_item item,
+                        std::error_code ec) mutable {
+        std::uint16_t vbucket = 0;
+        if (!ec && source.config) {
+            vbucket = source.config->map_key(item.key, 0).first;
+            if (source.resumeFrom &&
+                source.resumeFrom->seen(vbucket, item.key)) {
+                continueScan(std::move(source),
+                             [handler = std::move(handler)](
+                                 ScanItemSource source) mutable {
+                                 nextScanItem(std::move(source),
+                                              std::move(handler));
+                             });
+                return;
+            }
+        }
+        handler(std::move(item), vbucket, ec);
+    });
+}
+
+// Keys are packed back-to-back into a single UTF-8 buffer alongside the byte
+// length of each key so a whole batch can cross into JS as two allocations.
+struct ScanKeyBatch {
+    std::string keys;
+    std::vector<std::uint32_t> lengths;
+    std::vector<std::uint16_t> vbuckets;
+};
+
+template <typename Handler>
+static void collectScanKeys(ScanItemSource source, std::size_t limit,
+                            std::size_t byteLimit, ScanKeyBatch &&batch,
+                            Handler &&handler)
+{
+    auto nextSource = source;
+    nextScanItem(
+        std::move(nextSource),
+        [source = std::move(source), limit, byteLimit,
+         batch = std::move(batch), handler = std::forward<Handler>(handler)](
+            couchbase::core::range_scan_item item, std::uint16_t vbucket,
+            std::error_code ec) mutable {
+            if (ec) {
+                handler(std::move(batch), ec);
+                return;
+            }
+
+            batch.keys.append(item.key);
+            batch.lengths.push_back(
+                static_cast<std::uint32_t>(item.key.size()));
+            if (source.config) {
+                batch.vbuckets.push_back(vbucket);
+            }
+            if (batch.lengths.size() >= limit ||
+                (byteLimit > 0 && batch.keys.size() >= byteLimit)) {
+                handler(std::move(batch), std::error_code{});
+                return;
+            }
+
+            continueScan(std::move(source),
+                         [limit, byteLimit, batch = std::move(batch),
+                          handler = std::move(handler)](
+                             ScanItemSource source) mutable {
+                             collectScanKeys(std::move(source), limit,
+                                             byteLimit, std::move(batch),
+                                             std::move(handler));
+                         });
+        });
+}
+
 void ScanIterator::Init(Napi::Env env, Napi::Object exports)
 {
     Napi::Function func = DefineClass(
         env, "ScanIterator",
         {
             InstanceMethod<&ScanIterator::jsNext>("next"),
+            InstanceMethod<&ScanIterator::jsNextKeys>("nextKeys"),
             InstanceMethod<&ScanIterator::jsCancel>("cancel"),
+            InstanceMethod<&ScanIterator::jsCheckpoint>("checkpoint"),
             InstanceAccessor<&ScanIterator::jsCancelled>("cancelled"),
         });
 
@@ -23,12 +216,25 @@ ScanIterator::ScanIterator(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<ScanIterator>(info)
 {
     if (info.Length() > 0) {
-        auto wrapped_result =
-            *info[0]
-                 .As<const Napi::External<couchbase::core::scan_result>>()
-                 .Data();
+        auto &init =
+            *info[0].As<const Napi::External<ScanIteratorInit>>().Data();
         this->result_ =
-            std::make_shared<couchbase::core::scan_result>(wrapped_result);
+            std::make_shared<couchbase::core::scan_result>(init.result);
+        this->bufferByteLimit_ = init.bufferByteLimit;
+        this->io_ = init.io;
+        this->decompressValues_ = init.decompressValues;
+
+        if (init.trackProgress || init.resumeFrom) {
+            this->config_ = init.config;
+            this->resumeFrom_ = init.resumeFrom;
+            if (init.resumeFrom) {
+                this->progress_ =
+                    std::make_shared<ScanCheckpoint>(*init.resumeFrom);
+            } else {
+                this->progress_ = std::make_shared<ScanCheckpoint>(
+                    init.config->vbmap.value().size());
+            }
+        }
     }
 }
 
@@ -41,10 +247,12 @@ Napi::Value ScanIterator::jsNext(const Napi::CallbackInfo &info)
     auto env = info.Env();
     auto callbackJsFn = info[0].As<Napi::Function>();
     auto cookie = CallCookie(env, callbackJsFn, "cbRangeScanNext");
+    COUCHNODE_PROBE1(scan__next__start, this);
 
-    auto handler = [](Napi::Env env, Napi::Function callback,
-                      couchbase::core::range_scan_item resp,
-                      std::error_code ec) mutable {
+    auto handler = [progress = this->progress_](
+                       Napi::Env env, Napi::Function callback,
+                       couchbase::core::range_scan_item resp,
+                       std::uint16_t vbucket, std::error_code ec) mutable {
         Napi::Value jsErr, jsRes;
         if (ec && ec == couchbase::errc::key_value::range_scan_completed) {
             jsErr = env.Null();
@@ -57,17 +265,97 @@ Napi::Value ScanIterator::jsNext(const Napi::CallbackInfo &info)
                 jsErr = e.Value();
                 jsRes = env.Null();
             }
+            if (!ec && progress) {
+                progress->update(vbucket, resp.key);
+            }
         }
         callback.Call({jsErr, jsRes});
     };
 
-    this->result_->next(
-        [cookie = std::move(cookie), handler = std::move(handler)](
-            couchbase::core::range_scan_item resp, std::error_code ec) mutable {
+    nextScanItem(
+        ScanItemSource{this->result_, this->config_, this->resumeFrom_,
+                       this->io_},
+        [cookie = std::move(cookie), handler = std::move(handler),
+         iterator = this, decompressValues = this->decompressValues_](
+            couchbase::core::range_scan_item resp, std::uint16_t vbucket,
+            std::error_code ec) mutable {
+            COUCHNODE_PROBE2(scan__next__done, iterator, ec.value());
+            if (resp.body && decompressValues) {
+                ValueCompression::decompress(resp.body->value,
+                                             resp.body->flags);
+            }
             cookie.invoke([handler = std::move(handler), resp = std::move(resp),
-                           ec = std::move(ec)](
+                           vbucket, ec = std::move(ec)](
                               Napi::Env env, Napi::Function callback) mutable {
-                handler(env, callback, std::move(resp), std::move(ec));
+                handler(env, callback, std::move(resp), vbucket,
+                        std::move(ec));
+            });
+        });
+
+    return env.Null();
+}
+
+Napi::Value ScanIterator::jsNextKeys(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto limit = std::min<std::uint32_t>(info[0].ToNumber().Uint32Value(),
+                                         MAX_SCAN_ID_BATCH_SIZE);
+    auto callbackJsFn = info[1].As<Napi::Function>();
+    auto cookie = CallCookie(env, callbackJsFn, "cbRangeScanNextKeys");
+
+    // JS only asks for another batch once it has emitted all of the last,
+    // unless it stopped part way through and cancelled the scan.
+    if (this->progress_ && !this->result_->is_cancelled()) {
+        this->progress_->commitStaged(this->progress_->numStaged());
+    }
+
+    ScanKeyBatch batch;
+    batch.lengths.reserve(limit);
+
+    collectScanKeys(
+        ScanItemSource{this->result_, this->config_, this->resumeFrom_,
+                       this->io_},
+        std::max<std::size_t>(limit, 1), this->bufferByteLimit_,
+        std::move(batch),
+        [cookie = std::move(cookie), progress = this->progress_](
+            ScanKeyBatch batch, std::error_code ec) mutable {
+            cookie.invoke([batch = std::move(batch), ec = std::move(ec),
+                           progress = std::move(progress)](
+                              Napi::Env env, Napi::Function callback) mutable {
+                Napi::Value jsErr = env.Null();
+                if (ec &&
+                    ec != couchbase::errc::key_value::range_scan_completed) {
+                    jsErr = cbpp_to_js(env, ec);
+                }
+
+                // A completed scan with nothing left to deliver is signalled
+                // the same way as jsNext, with an undefined result.
+                if (batch.lengths.empty()) {
+                    callback.Call({jsErr, env.Undefined()});
+                    return;
+                }
+
+                if (progress) {
+                    std::size_t offset = 0;
+                    for (std::size_t i = 0; i < batch.lengths.size(); ++i) {
+                        progress->stage(batch.vbuckets[i],
+                                        batch.keys.substr(offset,
+                                                          batch.lengths[i]));
+                        offset += batch.lengths[i];
+                    }
+                }
+
+                auto jsLengths =
+                    Napi::Uint32Array::New(env, batch.lengths.size());
+                std::copy(batch.lengths.begin(), batch.lengths.end(),
+                          jsLengths.Data());
+
+                auto resObj = Napi::Object::New(env);
+                resObj.Set("keys", Napi::Buffer<char>::Copy(
+                                       env, batch.keys.data(),
+                                       batch.keys.size()));
+                resObj.Set("lengths", jsLengths);
+                callback.Call({jsErr, resObj});
             });
         });
 
@@ -87,4 +375,23 @@ Napi::Value ScanIterator::jsCancelled(const Napi::CallbackInfo &info)
     return Napi::Boolean::New(env, this->result_->is_cancelled());
 }
 
+Napi::Value ScanIterator::jsCheckpoint(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    if (!this->progress_) {
+        return env.Undefined();
+    }
+
+    // Ids of the last key batch are only included up to the number which JS
+    // says it has emitted, or all of them if it does not say.
+    auto consumed = this->progress_->numStaged();
+    if (info.Length() > 0 && info[0].IsNumber()) {
+        consumed = std::min<std::size_t>(consumed,
+                                         info[0].ToNumber().Uint32Value());
+    }
+    auto checkpoint = *this->progress_;
+    checkpoint.commitStaged(consumed);
+    return cbpp_to_js(env, checkpoint.encode());
+}
+
 } // namespace couchnode
@@ -1,11 +1,99 @@
 #pragma once
 #include "addondata.hpp"
 #include "napi.h"
+#include <asio/io_context.hpp>
 #include <core/scan_result.hxx>
+#include <core/topology/configuration.hxx>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace couchnode
 {
 
+// Per-vbucket progress of a scan, mapping each vbucket to the last key which
+// was handed to JS from it.  Range scans return keys in order within a
+// vbucket, so this is enough to resume a scan without repeating any items.
+// The core does not report when a vbucket has been scanned to the end, so a
+// finished vbucket cannot be told apart from one which is still in progress
+// and nothing is recorded for it; the server side range of a resumed scan
+// can therefore only be narrowed once every vbucket has a last key.
+class ScanCheckpoint
+{
+public:
+    ScanCheckpoint(std::size_t numVbuckets = 0)
+        : _numVbuckets(numVbuckets)
+    {
+    }
+
+    static std::optional<ScanCheckpoint> decode(const std::byte *data,
+                                                std::size_t size);
+    std::vector<std::byte> encode() const;
+
+    std::size_t numVbuckets() const
+    {
+        return _numVbuckets;
+    }
+
+    const std::map<std::uint16_t, std::string> &lastKeys() const
+    {
+        return _lastKeys;
+    }
+
+    // Returns true if the key has already been delivered by a previous run.
+    bool seen(std::uint16_t vbucket, const std::string &key) const;
+
+    void update(std::uint16_t vbucket, const std::string &key)
+    {
+        _lastKeys[vbucket] = key;
+    }
+
+    // The keys of a batch handed to JS only count as delivered once JS has
+    // emitted them, which it may stop doing part way through the batch, so
+    // they are staged here until JS reports how many it got through.
+    void stage(std::uint16_t vbucket, std::string key)
+    {
+        _staged.emplace_back(vbucket, std::move(key));
+    }
+
+    // Records the first count staged keys as delivered and drops the rest.
+    void commitStaged(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count && i < _staged.size(); ++i) {
+            update(_staged[i].first, _staged[i].second);
+        }
+        _staged.clear();
+    }
+
+    std::size_t numStaged() const
+    {
+        return _staged.size();
+    }
+
+private:
+    std::size_t _numVbuckets;
+    std::map<std::uint16_t, std::string> _lastKeys;
+    std::vector<std::pair<std::uint16_t, std::string>> _staged;
+};
+
+struct ScanIteratorInit {
+    couchbase::core::scan_result result;
+    std::shared_ptr<couchbase::core::topology::configuration> config;
+    bool trackProgress{false};
+    std::shared_ptr<const ScanCheckpoint> resumeFrom;
+    // Upper bound on the bytes of ids collected into a single key batch, or
+    // zero for no limit.
+    std::size_t bufferByteLimit{0};
+    asio::io_context *io{nullptr};
+    // Whether compressed values are decompressed before they reach JS.
+    bool decompressValues{false};
+};
+
+// The most ids a single key batch may hold.
+static constexpr std::uint32_t MAX_SCAN_ID_BATCH_SIZE = 65536;
+
 class ScanIterator : public Napi::ObjectWrap<ScanIterator>
 {
 public:
@@ -20,11 +108,19 @@ public:
     ~ScanIterator();
 
     Napi::Value jsNext(const Napi::CallbackInfo &info);
+    Napi::Value jsNextKeys(const Napi::CallbackInfo &info);
     Napi::Value jsCancel(const Napi::CallbackInfo &info);
     Napi::Value jsCancelled(const Napi::CallbackInfo &info);
+    Napi::Value jsCheckpoint(const Napi::CallbackInfo &info);
 
 private:
     std::shared_ptr<couchbase::core::scan_result> result_;
+    std::shared_ptr<couchbase::core::topology::configuration> config_;
+    std::shared_ptr<const ScanCheckpoint> resumeFrom_;
+    std::shared_ptr<ScanCheckpoint> progress_;
+    std::size_t bufferByteLimit_{0};
+    asio::io_context *io_{nullptr};
+    bool decompressValues_{false};
 };
 
 } // namespace couchnode
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace couchnode
+{
+
+// A buffer for the native transcoders to serialize into before the result
+// is copied into a JS Buffer.  The buffer is shared by the encodes made on a
+// thread, so that they do not allocate in the common case, unless an encode
+// is made from within another (from a toJSON or a getter), which then gets a
+// buffer of its own.
+class ScratchBuffer
+{
+public:
+    // The shared buffer is released if an unusually large value made it
+    // grow beyond this.
+    static constexpr std::size_t MAX_RETAINED_SIZE = 1024 * 1024;
+
+    ScratchBuffer()
+        : _shared(!sharedInUse())
+        , _buffer(_shared ? sharedBuffer() : _local)
+    {
+        sharedInUse() |= _shared;
+    }
+
+    ScratchBuffer(const ScratchBuffer &) = delete;
+    ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+    ~ScratchBuffer()
+    {
+        if (_shared) {
+            if (_buffer.capacity() > MAX_RETAINED_SIZE) {
+                std::string().swap(_buffer);
+            } else {
+                _buffer.clear();
+            }
+            sharedInUse() = false;
+        }
+    }
+
+    std::string &get()
+    {
+        return _buffer;
+    }
+
+private:
+    static std::string &sharedBuffer()
+    {
+        thread_local std::string buffer;
+        return buffer;
+    }
+
+    static bool &sharedInUse()
+    {
+        thread_local bool inUse = false;
+        return inUse;
+    }
+
+    std::string _local;
+    bool _shared;
+    std::string &_buffer;
+};
+
+} // namespace couchnode
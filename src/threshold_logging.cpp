@@ -0,0 +1,286 @@
+#include "threshold_logging.hpp"
+#include "jstocbpp.hpp"
+#include <algorithm>
+#include <string_view>
+
+namespace couchnode
+{
+
+static constexpr const char *DISPATCH_SPAN_NAME = "dispatch_to_server";
+
+static bool slowerThan(const ThresholdLogRecord &a,
+                       const ThresholdLogRecord &b)
+{
+    return a.totalDurationUs > b.totalDurationUs;
+}
+
+static double microsBetween(std::chrono::system_clock::time_point start,
+                            std::chrono::system_clock::time_point end)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+template <typename Map>
+static auto findTag(const Map &tags, const std::string &key)
+    -> std::optional<typename Map::mapped_type>
+{
+    auto it = tags.find(key);
+    if (it == tags.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+// Walks the spans the core created beneath the operation, accumulating the
+// dispatch and server durations and remembering the details of the last
+// dispatch, mirroring how the JS spans propagate these to their parent.
+static void
+collectDispatchSpans(const couchbase::core::tracing::wrapper_sdk_span &span,
+                     bool withServerDuration, ThresholdLogRecord &record)
+{
+    for (const auto &child : span.children()) {
+        if (child->name() != DISPATCH_SPAN_NAME) {
+            collectDispatchSpans(*child, withServerDuration, record);
+            continue;
+        }
+
+        auto dispatchUs = microsBetween(child->start_time(), child->end_time());
+        record.lastDispatchDurationUs = dispatchUs;
+        record.totalDispatchDurationUs =
+            record.totalDispatchDurationUs.value_or(0) + dispatchUs;
+
+        const auto &uintTags = child->uint_tags();
+        const auto &stringTags = child->string_tags();
+        if (auto serverUs = findTag(uintTags, "couchbase.server_duration");
+            serverUs && withServerDuration) {
+            record.lastServerDurationUs = static_cast<double>(*serverUs);
+            record.totalServerDurationUs =
+                record.totalServerDurationUs.value_or(0) +
+                static_cast<double>(*serverUs);
+        }
+        if (auto localId = findTag(stringTags, "couchbase.local_id")) {
+            record.lastLocalId = std::move(localId);
+        }
+        if (auto operationId = findTag(stringTags, "couchbase.operation_id")) {
+            record.operationId = std::move(operationId);
+        }
+
+        auto peerAddress = findTag(stringTags, "network.peer.address");
+        auto peerPort = findTag(uintTags, "network.peer.port");
+        if (peerAddress || peerPort) {
+            record.lastLocalSocket =
+                peerAddress.value_or("") + ":" +
+                (peerPort ? std::to_string(*peerPort) : std::string{});
+        }
+        auto serverAddress = findTag(stringTags, "server.address");
+        auto serverPort = findTag(uintTags, "server.port");
+        if (serverAddress || serverPort) {
+            record.lastRemoteSocket =
+                serverAddress.value_or("") + ":" +
+                (serverPort ? std::to_string(*serverPort) : std::string{});
+        }
+
+        collectDispatchSpans(*child, withServerDuration, record);
+    }
+}
+
+const char *ThresholdLogState::serviceForOp(const std::string &opName)
+{
+    auto startsWith = [&opName](const char *prefix) {
+        return opName.rfind(prefix, 0) == 0;
+    };
+
+    if (startsWith("managementEventing")) {
+        return "eventing";
+    } else if (startsWith("management")) {
+        return "mgmt";
+    } else if (startsWith("query")) {
+        return "query";
+    } else if (startsWith("analytics")) {
+        return "analytics";
+    } else if (startsWith("search")) {
+        return "search";
+    } else if (startsWith("documentView")) {
+        return "views";
+    }
+    return "kv";
+}
+
+bool ThresholdLogState::exceedsThreshold(const std::string &service,
+                                         double durationUs) const
+{
+    auto it = _thresholdsUs.find(service);
+    return it != _thresholdsUs.end() && it->second > 0 &&
+           durationUs > it->second;
+}
+
+void ThresholdLogState::add(const std::string &service,
+                            ThresholdLogRecord &&record)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &reservoir = _reservoirs[service];
+    auto &heap = reservoir.topRequests;
+    reservoir.totalCount++;
+
+    if (heap.size() < _sampleSize) {
+        heap.push_back(std::move(record));
+        std::push_heap(heap.begin(), heap.end(), slowerThan);
+        return;
+    }
+    if (heap.empty() || !slowerThan(record, heap.front())) {
+        return;
+    }
+    std::pop_heap(heap.begin(), heap.end(), slowerThan);
+    heap.back() = std::move(record);
+    std::push_heap(heap.begin(), heap.end(), slowerThan);
+}
+
+void ThresholdLogState::recordOp(
+    const char *service, std::chrono::steady_clock::time_point startedAt,
+    const couchbase::core::tracing::wrapper_sdk_span &wrapperSpan)
+{
+    auto totalUs = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - startedAt)
+                       .count();
+    if (!exceedsThreshold(service, totalUs)) {
+        return;
+    }
+
+    ThresholdLogRecord record;
+    record.operationName = wrapperSpan.name();
+    record.totalDurationUs = totalUs;
+    collectDispatchSpans(wrapperSpan, std::string_view(service) == "kv",
+                         record);
+    add(service, std::move(record));
+}
+
+std::map<std::string, ThresholdLogState::ServiceReport>
+ThresholdLogState::drain()
+{
+    std::map<std::string, ServiceReport> reservoirs;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        reservoirs.swap(_reservoirs);
+    }
+    for (auto &[service, reservoir] : reservoirs) {
+        std::sort_heap(reservoir.topRequests.begin(),
+                       reservoir.topRequests.end(), slowerThan);
+    }
+    return reservoirs;
+}
+
+void ThresholdLogger::Init(Napi::Env env, Napi::Object exports)
+{
+    Napi::Function func = DefineClass(
+        env, "ThresholdLogger",
+        {
+            InstanceMethod<&ThresholdLogger::jsAddRecord>("addRecord"),
+            InstanceMethod<&ThresholdLogger::jsReport>("report"),
+        });
+
+    constructor(env) = Napi::Persistent(func);
+    exports.Set("ThresholdLogger", func);
+}
+
+ThresholdLogger::ThresholdLogger(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<ThresholdLogger>(info)
+{
+    auto configObj = info[0].As<Napi::Object>();
+    auto thresholdsUs = js_to_cbpp<std::map<std::string, double>>(
+        configObj.Get("thresholds_us"));
+    auto sampleSize =
+        js_to_cbpp<std::uint32_t>(configObj.Get("sample_size"));
+    _state = std::make_shared<ThresholdLogState>(std::move(thresholdsUs),
+                                                 sampleSize);
+}
+
+ThresholdLogger::~ThresholdLogger()
+{
+}
+
+// Records an operation which was timed by the JS tracer rather than on the
+// io thread.  The caller has already checked it against the threshold.
+Napi::Value ThresholdLogger::jsAddRecord(const Napi::CallbackInfo &info)
+{
+    auto service = info[0].ToString().Utf8Value();
+    auto recordObj = info[1].As<Napi::Object>();
+
+    ThresholdLogRecord record;
+    record.operationName =
+        js_to_cbpp<std::string>(recordObj.Get("operation_name"));
+    record.totalDurationUs =
+        js_to_cbpp<double>(recordObj.Get("total_duration_us"));
+    record.encodeDurationUs = js_to_cbpp<std::optional<double>>(
+        recordObj.Get("encode_duration_us"));
+    record.lastDispatchDurationUs = js_to_cbpp<std::optional<double>>(
+        recordObj.Get("last_dispatch_duration_us"));
+    record.totalDispatchDurationUs = js_to_cbpp<std::optional<double>>(
+        recordObj.Get("total_dispatch_duration_us"));
+    record.lastServerDurationUs = js_to_cbpp<std::optional<double>>(
+        recordObj.Get("last_server_duration_us"));
+    record.totalServerDurationUs = js_to_cbpp<std::optional<double>>(
+        recordObj.Get("total_server_duration_us"));
+    record.lastLocalId = js_to_cbpp<std::optional<std::string>>(
+        recordObj.Get("last_local_id"));
+    record.operationId = js_to_cbpp<std::optional<std::string>>(
+        recordObj.Get("operation_id"));
+    record.lastLocalSocket = js_to_cbpp<std::optional<std::string>>(
+        recordObj.Get("last_local_socket"));
+    record.lastRemoteSocket = js_to_cbpp<std::optional<std::string>>(
+        recordObj.Get("last_remote_socket"));
+
+    _state->add(service, std::move(record));
+    return info.Env().Undefined();
+}
+
+// Returns {<service>: {total_count, top_requests}} with the slowest requests
+// first, matching the report the JS reporter has always logged.
+Napi::Value ThresholdLogger::jsReport(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto resObj = Napi::Object::New(env);
+
+    for (auto &[service, reservoir] : _state->drain()) {
+        auto jsTopRequests =
+            Napi::Array::New(env, reservoir.topRequests.size());
+        for (std::size_t i = 0; i < reservoir.topRequests.size(); ++i) {
+            const auto &record = reservoir.topRequests[i];
+            auto recordObj = Napi::Object::New(env);
+            auto setIfPresent = [&](const char *key, const auto &value) {
+                if (value) {
+                    recordObj.Set(key, cbpp_to_js(env, *value));
+                }
+            };
+
+            recordObj.Set("operation_name",
+                          cbpp_to_js(env, record.operationName));
+            recordObj.Set("total_duration_us",
+                          cbpp_to_js(env, record.totalDurationUs));
+            setIfPresent("encode_duration_us", record.encodeDurationUs);
+            setIfPresent("total_dispatch_duration_us",
+                         record.totalDispatchDurationUs);
+            setIfPresent("total_server_duration_us",
+                         record.totalServerDurationUs);
+            setIfPresent("last_dispatch_duration_us",
+                         record.lastDispatchDurationUs);
+            setIfPresent("last_server_duration_us",
+                         record.lastServerDurationUs);
+            setIfPresent("last_local_id", record.lastLocalId);
+            setIfPresent("operation_id", record.operationId);
+            setIfPresent("last_local_socket", record.lastLocalSocket);
+            setIfPresent("last_remote_socket", record.lastRemoteSocket);
+            jsTopRequests.Set(i, recordObj);
+        }
+
+        auto serviceObj = Napi::Object::New(env);
+        serviceObj.Set("total_count",
+                       Napi::Number::New(
+                           env, static_cast<double>(reservoir.totalCount)));
+        serviceObj.Set("top_requests", jsTopRequests);
+        resObj.Set(service, serviceObj);
+    }
+
+    return resObj;
+}
+
+} // namespace couchnode
@@ -0,0 +1,98 @@
+#pragma once
+#include "addondata.hpp"
+#include "napi.h"
+#include <core/tracing/wrapper_sdk_tracer.hxx>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace couchnode
+{
+
+struct ThresholdLogRecord {
+    std::string operationName;
+    double totalDurationUs{0};
+    std::optional<double> encodeDurationUs;
+    std::optional<double> lastDispatchDurationUs;
+    std::optional<double> totalDispatchDurationUs;
+    std::optional<double> lastServerDurationUs;
+    std::optional<double> totalServerDurationUs;
+    std::optional<std::string> lastLocalId;
+    std::optional<std::string> operationId;
+    std::optional<std::string> lastLocalSocket;
+    std::optional<std::string> lastRemoteSocket;
+};
+
+// The slowest operations seen for each service since the last report.  Each
+// service keeps a bounded min-heap keyed by total duration so that deciding
+// whether an operation makes the cut is O(log n) and the heap never grows
+// past the sample size, regardless of load.
+class ThresholdLogState
+{
+public:
+    struct ServiceReport {
+        std::uint64_t totalCount{0};
+        std::vector<ThresholdLogRecord> topRequests;
+    };
+
+    ThresholdLogState(std::map<std::string, double> thresholdsUs,
+                      std::size_t sampleSize)
+        : _thresholdsUs(std::move(thresholdsUs))
+        , _sampleSize(sampleSize)
+    {
+    }
+
+    // Maps the name an operation is executed under by the Connection to the
+    // service name used in the report.
+    static const char *serviceForOp(const std::string &opName);
+
+    bool exceedsThreshold(const std::string &service, double durationUs) const;
+    void add(const std::string &service, ThresholdLogRecord &&record);
+
+    // Called on the io thread once a request has completed, with the span the
+    // core attached its dispatch spans to.
+    void recordOp(
+        const char *service, std::chrono::steady_clock::time_point startedAt,
+        const couchbase::core::tracing::wrapper_sdk_span &wrapperSpan);
+
+    // Returns the slowest operations per service, ordered slowest first,
+    // and resets the state for the next interval.
+    std::map<std::string, ServiceReport> drain();
+
+private:
+    std::map<std::string, double> _thresholdsUs;
+    std::size_t _sampleSize;
+    std::mutex _mutex;
+    std::map<std::string, ServiceReport> _reservoirs;
+};
+
+class ThresholdLogger : public Napi::ObjectWrap<ThresholdLogger>
+{
+public:
+    static Napi::FunctionReference &constructor(Napi::Env env)
+    {
+        return AddonData::fromEnv(env)->_thresholdLoggerCtor;
+    }
+
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    ThresholdLogger(const Napi::CallbackInfo &info);
+    ~ThresholdLogger();
+
+    std::shared_ptr<ThresholdLogState> state() const
+    {
+        return _state;
+    }
+
+    Napi::Value jsAddRecord(const Napi::CallbackInfo &info);
+    Napi::Value jsReport(const Napi::CallbackInfo &info);
+
+private:
+    std::shared_ptr<ThresholdLogState> _state;
+};
+
+} // namespace couchnode
@@ -1,37 +1,150 @@
 #include "transaction.hpp"
 #include "connection.hpp"
 #include "jstocbpp.hpp"
+#include "probes.hpp"
 #include "transactions.hpp"
 #include <core/transactions/internal/exceptions_internal.hxx>
 #include <core/transactions/internal/utils.hxx>
 #include <core/transactions/transaction_get_multi_replicas_from_preferred_server_group_result.hxx>
 #include <core/transactions/transaction_get_multi_result.hxx>
+#include <mutex>
 #include <type_traits>
 
 namespace couchnode
 {
 
-// BUG(JSCBC-1022): Remove this once txn++ implements handlers which can
-// properly forward with move semantics.
+// BUG(JSCBC-1022): txn++ handlers cannot forward with move semantics, so the
+// cookies captured by them must be copyable.
 // UPDATE 2022.12.09:  kv has been updated, query still uses std::function
 // UPDATE 2023.01.30:  Error found in c++ txns, kv reverted back to std::function
 //                     and query still uses std::function
-class RefCallCookie
+// Rather than wrapping a CallCookie in a shared_ptr, each operation borrows a
+// slot from the transaction's pool.
+CallCookiePool::CallCookiePool(Napi::Env env, const std::string &resourceName)
+{
+    _ttsf = PoolTTSF::New(env, resourceName, 0, 1, this);
+    // Idle transactions must not keep the event loop alive.
+    _ttsf.Unref(env);
+}
+
+// Only runs once no slot is in flight, so there are no calls left to be made
+// through the thread-safe function.
+CallCookiePool::~CallCookiePool()
+{
+    _ttsf.Release();
+}
+
+PooledCallCookie CallCookiePool::acquire(Napi::Env env,
+                                         Napi::Function jsCallback,
+                                         const char *stage)
+{
+    PooledCallCookie::Slot *slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        slot = &_slots.emplace_back();
+    }
+    slot->pool = shared_from_this();
+    slot->callback = Napi::Persistent(jsCallback);
+    slot->stage = stage;
+    slot->startedAt = std::chrono::steady_clock::now();
+    COUCHNODE_PROBE2(txn__op__start, slot, stage);
+
+    if (_numPending++ == 0) {
+        _ttsf.Ref(env);
+    }
+    return PooledCallCookie(slot);
+}
+
+void CallCookiePool::forward(Napi::Env env, Napi::Function,
+                             CallCookiePool *, PooledCallCookie::Slot *slot)
+{
+    // Take over the slot's reference, which may be the last one if the
+    // transaction has already been destroyed.  The pool is then released
+    // once the callback below has run.
+    auto pool = std::move(slot->pool);
+    if (env == nullptr) {
+        return;
+    }
+
+    // The slot is returned to the pool before the callback runs, so an
+    // operation issued from within the callback can reuse it.
+    COUCHNODE_PROBE2(txn__op__dispatch, slot, slot->stage);
+    auto callback = slot->callback.Value();
+    auto fn = std::move(*slot->fn);
+    slot->fn.reset();
+    slot->callback.Reset();
+    pool->_freeSlots.push_back(slot);
+    if (--pool->_numPending == 0) {
+        pool->_ttsf.Unref(env);
+    }
+
+    auto &timings = pool->_timings;
+    auto &stage = timings.stages[slot->stage];
+    stage.count++;
+    stage.total += slot->completedAt - slot->startedAt;
+    timings.callbacks++;
+    timings.callbackDelay +=
+        std::chrono::steady_clock::now() - slot->completedAt;
+
+    try {
+        fn(env, callback);
+    } catch (const Napi::Error &e) {
+    }
+}
+
+void PooledCallCookie::invoke(FwdFunc &&callback) const
+{
+    _slot->completedAt = std::chrono::steady_clock::now();
+    COUCHNODE_PROBE3(txn__op__done, _slot, _slot->stage,
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         _slot->completedAt - _slot->startedAt)
+                         .count());
+    _slot->fn.emplace(std::move(callback));
+    _slot->pool->_ttsf.BlockingCall(_slot);
+}
+
+// Collects the outcome of a batch of mutations which are staged concurrently
+// within an attempt, so that a single callback can be made once all of them
+// have completed.  Results keep the order in which the mutations were given.
+template <typename Result>
+class StagedMutations
 {
 public:
-    RefCallCookie(Napi::Env env, Napi::Function jsCallback,
-                  const std::string &resourceName)
-        : _impl(new CallCookie(env, jsCallback, resourceName))
+    explicit StagedMutations(std::size_t count)
+        : _results(count)
+        , _remaining(count)
+    {
+    }
+
+    // Returns true once every mutation in the batch has completed.
+    bool complete(std::size_t index, std::exception_ptr err,
+                  std::optional<Result> res)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (err && !_err) {
+            _err = std::move(err);
+        }
+        _results[index] = std::move(res);
+        return --_remaining == 0;
+    }
+
+    std::exception_ptr error() const
     {
+        return _err;
     }
 
-    void invoke(FwdFunc &&callback)
+    std::vector<std::optional<Result>> &results()
     {
-        _impl->invoke(std::forward<FwdFunc>(callback));
+        return _results;
     }
 
 private:
-    std::shared_ptr<CallCookie> _impl;
+    std::mutex _mutex;
+    std::exception_ptr _err;
+    std::vector<std::optional<Result>> _results;
+    std::size_t _remaining;
 };
 
 void Transaction::Init(Napi::Env env, Napi::Object exports)
@@ -50,9 +163,13 @@ void Transaction::Init(Napi::Env env, Napi::Object exports)
             InstanceMethod<&Transaction::jsInsert>("insert"),
             InstanceMethod<&Transaction::jsReplace>("replace"),
             InstanceMethod<&Transaction::jsRemove>("remove"),
+            InstanceMethod<&Transaction::jsInsertMulti>("insertMulti"),
+            InstanceMethod<&Transaction::jsReplaceMulti>("replaceMulti"),
+            InstanceMethod<&Transaction::jsRemoveMulti>("removeMulti"),
             InstanceMethod<&Transaction::jsQuery>("query"),
             InstanceMethod<&Transaction::jsCommit>("commit"),
             InstanceMethod<&Transaction::jsRollback>("rollback"),
+            InstanceMethod<&Transaction::jsTakeTimings>("takeTimings"),
         });
 
     constructor(env) = Napi::Persistent(func);
@@ -61,6 +178,7 @@ void Transaction::Init(Napi::Env env, Napi::Object exports)
 
 Transaction::Transaction(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<Transaction>(info)
+    , _cookies(std::make_shared<CallCookiePool>(info.Env(), "txnCallback"))
 {
     auto txnsJsObj = info[0].As<Napi::Object>();
     auto configJsObj = info[1].As<Napi::Object>();
@@ -83,16 +201,14 @@ Transaction::~Transaction()
 Napi::Value Transaction::jsNewAttempt(const Napi::CallbackInfo &info)
 {
     auto callbackJsFn = info[0].As<Napi::Function>();
-    auto cookie =
-        RefCallCookie(info.Env(), callbackJsFn, "txnNewAttemptCallback");
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "new_attempt");
 
-    _impl->new_attempt_context(
-        [this, cookie = std::move(cookie)](std::exception_ptr err) mutable {
-            cookie.invoke([err = std::move(err)](
-                              Napi::Env env, Napi::Function callback) mutable {
-                callback.Call({cbpp_to_js(env, err)});
-            });
+    _impl->new_attempt_context([this, cookie](std::exception_ptr err) mutable {
+        cookie.invoke([err = std::move(err)](Napi::Env env,
+                                             Napi::Function callback) mutable {
+            callback.Call({cbpp_to_js(env, err)});
         });
+    });
 
     return info.Env().Null();
 }
@@ -101,13 +217,14 @@ Napi::Value Transaction::jsGet(const Napi::CallbackInfo &info)
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnGetCallback");
 
     auto docId = jsToCbpp<couchbase::core::document_id>(optsJsObj.Get("id"));
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "get");
+
     _impl->get_optional(
         docId,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<cbcoretxns::transaction_get_result> res) mutable {
             cookie.invoke([err = std::move(err), res = std::move(res)](
@@ -134,13 +251,14 @@ Napi::Value Transaction::jsGetReplicaFromPreferredServerGroup(
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnGetCallback");
 
     auto docId = jsToCbpp<couchbase::core::document_id>(optsJsObj.Get("id"));
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "get_replica");
+
     _impl->get_replica_from_preferred_server_group(
         docId,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<cbcoretxns::transaction_get_result> res) mutable {
             cookie.invoke([err = std::move(err), res = std::move(res)](
@@ -166,17 +284,17 @@ Napi::Value Transaction::jsGetMulti(const Napi::CallbackInfo &info)
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie =
-        RefCallCookie(info.Env(), callbackJsFn, "txnGetMultiCallback");
 
     auto docIds = jsToCbpp<std::vector<couchbase::core::document_id>>(
         optsJsObj.Get("ids"));
     auto mode =
         jsToCbpp<cbcoretxns::transaction_get_multi_mode>(optsJsObj.Get("mode"));
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "get_multi");
+
     _impl->get_multi(
         docIds, mode,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<cbcoretxns::transaction_get_multi_result>
                 res) mutable {
@@ -194,9 +312,6 @@ Napi::Value Transaction::jsGetMultiReplicasFromPreferredServerGroup(
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie =
-        RefCallCookie(info.Env(), callbackJsFn,
-                      "txnGetMultiReplicasFromPreferredServerGroupCallback");
 
     auto docIds = jsToCbpp<std::vector<couchbase::core::document_id>>(
         optsJsObj.Get("ids"));
@@ -205,9 +320,12 @@ Napi::Value Transaction::jsGetMultiReplicasFromPreferredServerGroup(
             transaction_get_multi_replicas_from_preferred_server_group_mode>(
         optsJsObj.Get("mode"));
 
+    auto cookie =
+        _cookies->acquire(info.Env(), callbackJsFn, "get_multi_replicas");
+
     _impl->get_multi_replicas_from_preferred_server_group(
         docIds, mode,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<
                 cbcoretxns::
@@ -226,15 +344,16 @@ Napi::Value Transaction::jsInsert(const Napi::CallbackInfo &info)
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnInsertCallback");
 
     auto docId = jsToCbpp<couchbase::core::document_id>(optsJsObj.Get("id"));
     auto content =
         jsToCbpp<couchbase::codec::encoded_value>(optsJsObj.Get("content"));
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "insert");
+
     _impl->insert(
         docId, content,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<cbcoretxns::transaction_get_result> res) mutable {
             cookie.invoke([err = std::move(err), res = std::move(res)](
@@ -250,16 +369,17 @@ Napi::Value Transaction::jsReplace(const Napi::CallbackInfo &info)
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnReplaceCallback");
 
     auto doc =
         jsToCbpp<cbcoretxns::transaction_get_result>(optsJsObj.Get("doc"));
     auto content =
         jsToCbpp<couchbase::codec::encoded_value>(optsJsObj.Get("content"));
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "replace");
+
     _impl->replace(
         doc, content,
-        [this, cookie = std::move(cookie)](
+        [this, cookie](
             std::exception_ptr err,
             std::optional<cbcoretxns::transaction_get_result> res) mutable {
             cookie.invoke([err = std::move(err), res = std::move(res)](
@@ -275,13 +395,13 @@ Napi::Value Transaction::jsRemove(const Napi::CallbackInfo &info)
 {
     auto optsJsObj = info[0].As<Napi::Object>();
     auto callbackJsFn = info[1].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnRemoveCallback");
 
     auto doc =
         jsToCbpp<cbcoretxns::transaction_get_result>(optsJsObj.Get("doc"));
 
-    _impl->remove(doc, [this, cookie = std::move(cookie)](
-                           std::exception_ptr err) mutable {
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "remove");
+
+    _impl->remove(doc, [this, cookie](std::exception_ptr err) mutable {
         cookie.invoke([err = std::move(err)](Napi::Env env,
                                              Napi::Function callback) mutable {
             callback.Call({cbpp_to_js(env, err)});
@@ -291,19 +411,154 @@ Napi::Value Transaction::jsRemove(const Napi::CallbackInfo &info)
     return info.Env().Null();
 }
 
+Napi::Value Transaction::jsInsertMulti(const Napi::CallbackInfo &info)
+{
+    auto optsJsObj = info[0].As<Napi::Object>();
+    auto callbackJsFn = info[1].As<Napi::Function>();
+
+    auto docIds = jsToCbpp<std::vector<couchbase::core::document_id>>(
+        optsJsObj.Get("ids"));
+    auto contents = jsToCbpp<std::vector<couchbase::codec::encoded_value>>(
+        optsJsObj.Get("contents"));
+    if (docIds.size() != contents.size()) {
+        throw Napi::Error::New(info.Env(),
+                               "ids and contents must have the same length");
+    }
+
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "insert_multi");
+    if (docIds.empty()) {
+        cookie.invoke([](Napi::Env env, Napi::Function callback) {
+            callback.Call({env.Null(), Napi::Array::New(env)});
+        });
+        return info.Env().Null();
+    }
+
+    using Staged = StagedMutations<cbcoretxns::transaction_get_result>;
+    auto staged = std::make_shared<Staged>(docIds.size());
+    auto onStaged = [cookie, staged](
+                        std::size_t index, std::exception_ptr err,
+                        std::optional<cbcoretxns::transaction_get_result> res) {
+        if (!staged->complete(index, std::move(err), std::move(res))) {
+            return;
+        }
+        cookie.invoke([staged](Napi::Env env, Napi::Function callback) {
+            callback.Call({cbpp_to_js(env, staged->error()),
+                           cbpp_to_js(env, staged->results())});
+        });
+    };
+
+    for (std::size_t i = 0; i < docIds.size(); ++i) {
+        _impl->insert(
+            docIds[i], contents[i],
+            [onStaged, i](
+                std::exception_ptr err,
+                std::optional<cbcoretxns::transaction_get_result> res) {
+                onStaged(i, std::move(err), std::move(res));
+            });
+    }
+
+    return info.Env().Null();
+}
+
+Napi::Value Transaction::jsReplaceMulti(const Napi::CallbackInfo &info)
+{
+    auto optsJsObj = info[0].As<Napi::Object>();
+    auto callbackJsFn = info[1].As<Napi::Function>();
+
+    auto docs = jsToCbpp<std::vector<cbcoretxns::transaction_get_result>>(
+        optsJsObj.Get("docs"));
+    auto contents = jsToCbpp<std::vector<couchbase::codec::encoded_value>>(
+        optsJsObj.Get("contents"));
+    if (docs.size() != contents.size()) {
+        throw Napi::Error::New(info.Env(),
+                               "docs and contents must have the same length");
+    }
+
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "replace_multi");
+    if (docs.empty()) {
+        cookie.invoke([](Napi::Env env, Napi::Function callback) {
+            callback.Call({env.Null(), Napi::Array::New(env)});
+        });
+        return info.Env().Null();
+    }
+
+    using Staged = StagedMutations<cbcoretxns::transaction_get_result>;
+    auto staged = std::make_shared<Staged>(docs.size());
+    auto onStaged = [cookie, staged](
+                        std::size_t index, std::exception_ptr err,
+                        std::optional<cbcoretxns::transaction_get_result> res) {
+        if (!staged->complete(index, std::move(err), std::move(res))) {
+            return;
+        }
+        cookie.invoke([staged](Napi::Env env, Napi::Function callback) {
+            callback.Call({cbpp_to_js(env, staged->error()),
+                           cbpp_to_js(env, staged->results())});
+        });
+    };
+
+    for (std::size_t i = 0; i < docs.size(); ++i) {
+        _impl->replace(
+            docs[i], contents[i],
+            [onStaged, i](
+                std::exception_ptr err,
+                std::optional<cbcoretxns::transaction_get_result> res) {
+                onStaged(i, std::move(err), std::move(res));
+            });
+    }
+
+    return info.Env().Null();
+}
+
+Napi::Value Transaction::jsRemoveMulti(const Napi::CallbackInfo &info)
+{
+    auto optsJsObj = info[0].As<Napi::Object>();
+    auto callbackJsFn = info[1].As<Napi::Function>();
+
+    auto docs = jsToCbpp<std::vector<cbcoretxns::transaction_get_result>>(
+        optsJsObj.Get("docs"));
+
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "remove_multi");
+    if (docs.empty()) {
+        cookie.invoke([](Napi::Env env, Napi::Function callback) {
+            callback.Call({env.Null()});
+        });
+        return info.Env().Null();
+    }
+
+    using Staged = StagedMutations<std::monostate>;
+    auto staged = std::make_shared<Staged>(docs.size());
+    auto onStaged = [cookie, staged](std::size_t index,
+                                     std::exception_ptr err) {
+        if (!staged->complete(index, std::move(err), {})) {
+            return;
+        }
+        cookie.invoke([staged](Napi::Env env, Napi::Function callback) {
+            callback.Call({cbpp_to_js(env, staged->error())});
+        });
+    };
+
+    for (std::size_t i = 0; i < docs.size(); ++i) {
+        _impl->remove(docs[i], [onStaged, i](std::exception_ptr err) {
+            onStaged(i, std::move(err));
+        });
+    }
+
+    return info.Env().Null();
+}
+
 Napi::Value Transaction::jsQuery(const Napi::CallbackInfo &info)
 {
     auto statementJsStr = info[0].As<Napi::String>();
     auto optsJsObj = info[1].As<Napi::Object>();
     auto callbackJsFn = info[2].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnQueryCallback");
 
     auto statement = jsToCbpp<std::string>(statementJsStr);
     auto options = jsToCbpp<cbtxns::transaction_query_options>(optsJsObj);
 
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "query");
+
     _impl->query(statement, options,
-                 [this, cookie = std::move(cookie)](
-                     std::exception_ptr err,
+                 [this, cookie](std::exception_ptr err,
                      std::optional<couchbase::core::operations::query_response>
                          resp) mutable {
                      cookie.invoke(
@@ -328,9 +583,9 @@ Napi::Value Transaction::jsQuery(const Napi::CallbackInfo &info)
 Napi::Value Transaction::jsCommit(const Napi::CallbackInfo &info)
 {
     auto callbackJsFn = info[0].As<Napi::Function>();
-    auto cookie = RefCallCookie(info.Env(), callbackJsFn, "txnCommitCallback");
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "commit");
 
-    _impl->finalize([this, cookie = std::move(cookie)](
+    _impl->finalize([this, cookie](
                         std::optional<cbcoretxns::transaction_exception> err,
                         std::optional<cbtxns::transaction_result> res) mutable {
         cookie.invoke([err = std::move(err), res = std::move(res)](
@@ -345,18 +600,43 @@ Napi::Value Transaction::jsCommit(const Napi::CallbackInfo &info)
 Napi::Value Transaction::jsRollback(const Napi::CallbackInfo &info)
 {
     auto callbackJsFn = info[0].As<Napi::Function>();
-    auto cookie =
-        RefCallCookie(info.Env(), callbackJsFn, "txnRollbackCallback");
+    auto cookie = _cookies->acquire(info.Env(), callbackJsFn, "rollback");
 
-    _impl->rollback(
-        [this, cookie = std::move(cookie)](std::exception_ptr err) mutable {
-            cookie.invoke([err = std::move(err)](
-                              Napi::Env env, Napi::Function callback) mutable {
-                callback.Call({cbpp_to_js(env, err)});
-            });
+    _impl->rollback([this, cookie](std::exception_ptr err) mutable {
+        cookie.invoke([err = std::move(err)](Napi::Env env,
+                                             Napi::Function callback) mutable {
+            callback.Call({cbpp_to_js(env, err)});
         });
+    });
 
     return info.Env().Null();
 }
 
+Napi::Value Transaction::jsTakeTimings(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto timings = _cookies->takeTimings();
+
+    auto toMicros = [](std::chrono::nanoseconds duration) {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                .count());
+    };
+
+    auto stagesObj = Napi::Object::New(env);
+    for (const auto &[name, stage] : timings.stages) {
+        auto stageObj = Napi::Object::New(env);
+        stageObj.Set("count", Napi::Number::New(env, stage.count));
+        stageObj.Set("total_us", Napi::Number::New(env, toMicros(stage.total)));
+        stagesObj.Set(name, stageObj);
+    }
+
+    auto resObj = Napi::Object::New(env);
+    resObj.Set("stages", stagesObj);
+    resObj.Set("callback_count", Napi::Number::New(env, timings.callbacks));
+    resObj.Set("callback_delay_us",
+               Napi::Number::New(env, toMicros(timings.callbackDelay)));
+    return resObj;
+}
+
 } // namespace couchnode
@@ -1,8 +1,16 @@
 #pragma once
 #include "addondata.hpp"
+#include "connection.hpp"
 #include <core/transactions.hxx>
 #include <core/transactions/internal/transaction_context.hxx>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
 #include <napi.h>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace cbtxns = couchbase::transactions;
 namespace cbcoretxns = couchbase::core::transactions;
@@ -10,6 +18,93 @@ namespace cbcoretxns = couchbase::core::transactions;
 namespace couchnode
 {
 
+class CallCookiePool;
+
+// A completion slot handed out by a CallCookiePool.  The handle is a plain
+// pointer, so it can be copied freely into the std::function handlers which
+// the transactions library requires, and must be invoked exactly once.
+class PooledCallCookie
+{
+public:
+    struct Slot {
+        // Set while the slot is in flight, so that the pool outlives the
+        // transaction which owns it until every operation has completed.
+        std::shared_ptr<CallCookiePool> pool;
+        Napi::FunctionReference callback;
+        std::optional<FwdFunc> fn;
+        const char *stage;
+        std::chrono::steady_clock::time_point startedAt;
+        std::chrono::steady_clock::time_point completedAt;
+    };
+
+    explicit PooledCallCookie(Slot *slot)
+        : _slot(slot)
+    {
+    }
+
+    void invoke(FwdFunc &&callback) const;
+
+private:
+    Slot *_slot;
+};
+
+// Time spent by the operations of a transaction attempt, split by the kind
+// of operation, along with the time completed operations spent waiting for
+// the JS thread before their callbacks could run.
+struct TransactionTimings {
+    struct Stage {
+        std::size_t count{0};
+        std::chrono::nanoseconds total{0};
+    };
+
+    std::map<std::string, Stage> stages;
+    std::size_t callbacks{0};
+    std::chrono::nanoseconds callbackDelay{0};
+};
+
+// Routes the completions of every operation of a transaction through a single
+// thread-safe function, parking the JS callbacks in reusable slots.  This
+// avoids creating a thread-safe function and a shared_ptr control block for
+// each operation as a CallCookie would.  Must be owned by a shared_ptr.
+class CallCookiePool : public std::enable_shared_from_this<CallCookiePool>
+{
+public:
+    CallCookiePool(Napi::Env env, const std::string &resourceName);
+    ~CallCookiePool();
+
+    CallCookiePool(const CallCookiePool &) = delete;
+    CallCookiePool &operator=(const CallCookiePool &) = delete;
+
+    // Must be called from the JS thread.  The stage names the kind of
+    // operation the cookie is used for and must outlive the pool.
+    PooledCallCookie acquire(Napi::Env env, Napi::Function jsCallback,
+                             const char *stage);
+
+    // Returns the timings recorded since the last call, resetting them.
+    TransactionTimings takeTimings()
+    {
+        return std::exchange(_timings, TransactionTimings{});
+    }
+
+private:
+    friend class PooledCallCookie;
+
+    static void forward(Napi::Env env, Napi::Function, CallCookiePool *,
+                        PooledCallCookie::Slot *slot);
+
+    typedef Napi::TypedThreadSafeFunction<CallCookiePool,
+                                          PooledCallCookie::Slot,
+                                          &CallCookiePool::forward>
+        PoolTTSF;
+
+    PoolTTSF _ttsf;
+    // A deque keeps slot addresses stable as the pool grows.
+    std::deque<PooledCallCookie::Slot> _slots;
+    std::vector<PooledCallCookie::Slot *> _freeSlots;
+    std::size_t _numPending{0};
+    TransactionTimings _timings;
+};
+
 class Transaction : public Napi::ObjectWrap<Transaction>
 {
 public:
@@ -34,12 +129,17 @@ public:
     Napi::Value jsInsert(const Napi::CallbackInfo &info);
     Napi::Value jsReplace(const Napi::CallbackInfo &info);
     Napi::Value jsRemove(const Napi::CallbackInfo &info);
+    Napi::Value jsInsertMulti(const Napi::CallbackInfo &info);
+    Napi::Value jsReplaceMulti(const Napi::CallbackInfo &info);
+    Napi::Value jsRemoveMulti(const Napi::CallbackInfo &info);
     Napi::Value jsQuery(const Napi::CallbackInfo &info);
     Napi::Value jsCommit(const Napi::CallbackInfo &info);
     Napi::Value jsRollback(const Napi::CallbackInfo &info);
+    Napi::Value jsTakeTimings(const Napi::CallbackInfo &info);
 
 private:
     std::shared_ptr<cbcoretxns::transaction_context> _impl;
+    std::shared_ptr<CallCookiePool> _cookies;
 };
 
 } // namespace couchnode
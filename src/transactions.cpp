@@ -2,16 +2,20 @@
 #include "connection.hpp"
 #include <core/transactions/internal/exceptions_internal.hxx>
 #include <core/transactions/internal/utils.hxx>
+#include <thread>
 #include <type_traits>
 
 namespace couchnode
 {
 
+using TransactionsPtr = std::shared_ptr<cbcoretxns::transactions>;
+
 void Transactions::Init(Napi::Env env, Napi::Object exports)
 {
     Napi::Function func =
         DefineClass(env, "Transactions",
                     {
+                        StaticMethod<&Transactions::jsCreate>("create"),
                         InstanceMethod<&Transactions::jsClose>("close"),
                     });
 
@@ -22,40 +26,78 @@ void Transactions::Init(Napi::Env env, Napi::Object exports)
 Transactions::Transactions(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<Transactions>(info)
 {
+    if (info.Length() == 0 || !info[0].IsExternal()) {
+        throw Napi::Error::New(info.Env(),
+                               "Transactions must be created with create()");
+    }
+    _impl = *info[0].As<Napi::External<TransactionsPtr>>().Data();
+}
+
+Transactions::~Transactions()
+{
+    if (_closeThread.joinable()) {
+        _closeThread.join();
+    }
+}
+
+Napi::Value Transactions::jsCreate(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
     auto clusterJsObj = info[0].As<Napi::Object>();
     auto configJsObj = info[1].As<Napi::Object>();
+    auto callbackJsFn = info[2].As<Napi::Function>();
 
-    if (!clusterJsObj.InstanceOf(Connection::constructor(info.Env()).Value())) {
-        throw Napi::Error::New(info.Env(),
+    if (!clusterJsObj.InstanceOf(Connection::constructor(env).Value())) {
+        throw Napi::Error::New(env,
                                "first parameter must be a Connection object");
     }
     auto cluster = Connection::Unwrap(clusterJsObj)->cluster();
 
     auto txnsConfig = jsToCbpp<cbtxns::transactions_config>(configJsObj);
-    std::future<
-        std::pair<std::error_code, std::shared_ptr<cbcoretxns::transactions>>>
-        future = cbcoretxns::transactions::create(cluster, txnsConfig);
-    std::pair<std::error_code, std::shared_ptr<cbcoretxns::transactions>>
-        result = future.get();
-    if (result.first.value()) {
-        Napi::Error err = Napi::Error::New(info.Env(), result.first.message());
-        err.Set("code", Napi::Number::New(info.Env(), result.first.value()));
-        throw err;
-    }
-    _impl.reset();
-    _impl = std::move(result.second);
-}
+    // Setting up the cleanup machinery contacts the cluster, so creation must
+    // complete on the io thread rather than blocking the event loop.
+    auto cookie =
+        std::make_shared<CallCookie>(env, callbackJsFn, "cbTransactionsCreate");
+    cbcoretxns::transactions::create(
+        cluster, txnsConfig,
+        [cookie](std::error_code ec, TransactionsPtr txns) {
+            cookie->invoke([ec, txns = std::move(txns)](
+                               Napi::Env env, Napi::Function callback) mutable {
+                if (ec) {
+                    Napi::Error err = Napi::Error::New(env, ec.message());
+                    err.Set("code", Napi::Number::New(env, ec.value()));
+                    callback.Call({err.Value(), env.Null()});
+                    return;
+                }
 
-Transactions::~Transactions()
-{
+                auto ext = Napi::External<TransactionsPtr>::New(env, &txns);
+                auto txnsJsObj = Transactions::constructor(env).New({ext});
+                callback.Call({env.Null(), txnsJsObj});
+            });
+        });
+
+    return env.Null();
 }
 
 Napi::Value Transactions::jsClose(const Napi::CallbackInfo &info)
 {
     auto callbackJsFn = info[0].As<Napi::Function>();
+    auto cookie = CallCookie(info.Env(), callbackJsFn, "cbTransactionsClose");
 
-    _impl->close();
-    callbackJsFn.Call({info.Env().Null()});
+    // close() waits for the cleanup threads to finish their work, which in
+    // turn needs the io thread, so it has to run on a thread of its own.  A
+    // repeated close joins the thread of the previous one first, so only the
+    // latest thread needs to be joined when this object goes away.
+    _closeThread = std::thread([impl = _impl, cookie = std::move(cookie),
+                                previous = std::move(_closeThread)]() mutable {
+        if (previous.joinable()) {
+            previous.join();
+        }
+        impl->close();
+        cookie.invoke([](Napi::Env env, Napi::Function callback) {
+            callback.Call({env.Null()});
+        });
+    });
 
     return info.Env().Null();
 }
@@ -3,6 +3,7 @@
 #include <core/transactions.hxx>
 #include <memory>
 #include <napi.h>
+#include <thread>
 
 namespace cbtxns = couchbase::transactions;
 namespace cbcoretxns = couchbase::core::transactions;
@@ -28,10 +29,13 @@ public:
     Transactions(const Napi::CallbackInfo &info);
     ~Transactions();
 
+    static Napi::Value jsCreate(const Napi::CallbackInfo &info);
     Napi::Value jsClose(const Napi::CallbackInfo &info);
 
 private:
     std::shared_ptr<cbcoretxns::transactions> _impl;
+    // The thread running the most recent close(), joined on destruction.
+    std::thread _closeThread;
 };
 
 } // namespace couchnode
@@ -0,0 +1,149 @@
+#include "value_compression.hpp"
+#include <snappy.h>
+#ifdef COUCHNODE_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+namespace couchnode
+{
+
+// Compressed values are only ever decompressed up to this size, so that a
+// corrupt length prefix cannot cause an unbounded allocation.
+static constexpr std::size_t MAX_DECOMPRESSED_SIZE = 256 * 1024 * 1024;
+
+void ValueCompression::Init(Napi::Env env, Napi::Object exports)
+{
+    auto algorithms = Napi::Array::New(env);
+    algorithms.Set(algorithms.Length(), Napi::String::New(env, "snappy"));
+#ifdef COUCHNODE_HAVE_LZ4
+    algorithms.Set(algorithms.Length(), Napi::String::New(env, "lz4"));
+#endif
+    exports.Set("valueCompressionAlgorithms", algorithms);
+}
+
+static void writeUint32LE(std::byte *out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::byte>((value >> (i * 8)) & 0xff);
+    }
+}
+
+static std::uint32_t readUint32LE(const std::byte *in)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= std::to_integer<std::uint32_t>(in[i]) << (i * 8);
+    }
+    return value;
+}
+
+void ValueCompression::compress(std::vector<std::byte> &value,
+                                std::uint32_t &flags)
+{
+    auto algorithm = flags & FLAG_MASK;
+    if (algorithm == 0) {
+        return;
+    }
+
+    // The flags the value was encoded with are kept ahead of the compressed
+    // bytes, so that they can be restored once it is decompressed.
+    const auto *src = reinterpret_cast<const char *>(value.data());
+    std::vector<std::byte> compressed(HEADER_SIZE);
+    writeUint32LE(compressed.data(), flags & ~FLAG_MASK);
+    bool compressedOk = false;
+    if (algorithm == FLAG_SNAPPY) {
+        compressed.resize(HEADER_SIZE +
+                          snappy::MaxCompressedLength(value.size()));
+        std::size_t compressedSize;
+        snappy::RawCompress(
+            src, value.size(),
+            reinterpret_cast<char *>(compressed.data() + HEADER_SIZE),
+            &compressedSize);
+        compressed.resize(HEADER_SIZE + compressedSize);
+        compressedOk = true;
+    }
+#ifdef COUCHNODE_HAVE_LZ4
+    else if (algorithm == FLAG_LZ4 && value.size() <= LZ4_MAX_INPUT_SIZE) {
+        // LZ4 blocks do not record their decompressed size, so it is stored
+        // ahead of the block as a 32-bit little endian integer.
+        auto srcSize = static_cast<int>(value.size());
+        auto bound = LZ4_compressBound(srcSize);
+        compressed.resize(HEADER_SIZE + 4 + bound);
+        writeUint32LE(compressed.data() + HEADER_SIZE,
+                      static_cast<std::uint32_t>(srcSize));
+        auto compressedSize = LZ4_compress_default(
+            src,
+            reinterpret_cast<char *>(compressed.data() + HEADER_SIZE + 4),
+            srcSize, bound);
+        if (compressedSize > 0) {
+            compressed.resize(HEADER_SIZE + 4 + compressedSize);
+            compressedOk = true;
+        }
+    }
+#endif
+
+    if (!compressedOk || compressed.size() >= value.size()) {
+        flags &= ~FLAG_MASK;
+        return;
+    }
+    value = std::move(compressed);
+    flags = COMPRESSED_FORMAT | algorithm;
+}
+
+bool ValueCompression::decompress(std::vector<std::byte> &value,
+                                  std::uint32_t &flags)
+{
+    auto algorithm = flags & FLAG_MASK;
+    if (algorithm == 0) {
+        return true;
+    }
+    if (value.size() < HEADER_SIZE) {
+        return false;
+    }
+
+    auto originalFlags = readUint32LE(value.data());
+    const auto *src =
+        reinterpret_cast<const char *>(value.data() + HEADER_SIZE);
+    auto srcSize = value.size() - HEADER_SIZE;
+    std::vector<std::byte> decompressed;
+    if (algorithm == FLAG_SNAPPY) {
+        std::size_t size;
+        if (!snappy::GetUncompressedLength(src, srcSize, &size) ||
+            size > MAX_DECOMPRESSED_SIZE) {
+            return false;
+        }
+        decompressed.resize(size);
+        if (!snappy::RawUncompress(
+                src, srcSize, reinterpret_cast<char *>(decompressed.data()))) {
+            return false;
+        }
+    }
+#ifdef COUCHNODE_HAVE_LZ4
+    else if (algorithm == FLAG_LZ4) {
+        if (srcSize < 4) {
+            return false;
+        }
+        auto size = readUint32LE(value.data() + HEADER_SIZE);
+        if (size > MAX_DECOMPRESSED_SIZE) {
+            return false;
+        }
+        decompressed.resize(size);
+        auto decompressedSize = LZ4_decompress_safe(
+            src + 4, reinterpret_cast<char *>(decompressed.data()),
+            static_cast<int>(srcSize - 4), static_cast<int>(size));
+        if (decompressedSize < 0 ||
+            static_cast<std::uint32_t>(decompressedSize) != size) {
+            return false;
+        }
+    }
+#endif
+    else {
+        return false;
+    }
+
+    value = std::move(decompressed);
+    flags = originalFlags & ~FLAG_MASK;
+    return true;
+}
+
+} // namespace couchnode
@@ -0,0 +1,107 @@
+#pragma once
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace couchnode
+{
+
+// Client-side compression of document values.  A transcoder requests that a
+// value is compressed by setting one of the compression bits in its flags,
+// the value is then compressed on the io thread just before the request is
+// dispatched, and the bit is stored with the document to mark it compressed.
+// Values read back with the bit set are decompressed on the io thread, for
+// the reads which ask for it, before they are handed to JS.
+//
+// Compressed values are stored with the common flags format of private
+// binary data, which other SDKs read as plain bytes, and the flags the value
+// was encoded with are kept ahead of the compressed bytes.  The compression
+// bits are outside of the common flags format byte and the legacy format
+// byte, which are the only parts of the flags the SDKs interpret.
+class ValueCompression
+{
+public:
+    static constexpr std::uint32_t FLAG_SNAPPY = 0x00010000;
+    static constexpr std::uint32_t FLAG_LZ4 = 0x00020000;
+    static constexpr std::uint32_t FLAG_MASK = 0x00030000;
+
+    // CF_PRIVATE | NF_RAW.
+    static constexpr std::uint32_t COMPRESSED_FORMAT = 0x01000002;
+
+    // The original flags, as a 32-bit little endian integer.
+    static constexpr std::size_t HEADER_SIZE = 4;
+
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    // Compresses the value if compression was requested in the flags, and
+    // replaces the flags with those of a compressed value.  If the value
+    // does not get any smaller (or the algorithm is unavailable), it is left
+    // as it is and the compression bits are cleared.
+    static void compress(std::vector<std::byte> &value, std::uint32_t &flags);
+
+    // Decompresses the value if the flags mark it as compressed, restoring
+    // the flags it was encoded with.  Returns false if it could not be
+    // decompressed, in which case the value and flags are left untouched.
+    static bool decompress(std::vector<std::byte> &value,
+                           std::uint32_t &flags);
+};
+
+template <typename T, typename = void>
+struct has_compressible_value : std::false_type {
+};
+
+template <typename T>
+struct has_compressible_value<
+    T, std::enable_if_t<
+           std::is_same_v<decltype(std::declval<T &>().value),
+                          std::vector<std::byte>> &&
+           std::is_same_v<decltype(std::declval<T &>().flags), std::uint32_t>>>
+    : std::true_type {
+};
+
+template <typename T, typename = void>
+struct has_compressible_entries : std::false_type {
+};
+
+template <typename T>
+struct has_compressible_entries<
+    T, std::enable_if_t<has_compressible_value<
+           typename decltype(std::declval<T &>().entries)::value_type>::value>>
+    : std::true_type {
+};
+
+// Whether a request carries a value which was flagged to be compressed.
+template <typename Request>
+inline bool wantsValueCompression(const Request &req)
+{
+    if constexpr (has_compressible_value<Request>::value) {
+        return (req.flags & ValueCompression::FLAG_MASK) != 0;
+    } else {
+        return false;
+    }
+}
+
+template <typename Request>
+inline void compressRequestValue(Request &req)
+{
+    if constexpr (has_compressible_value<Request>::value) {
+        ValueCompression::compress(req.value, req.flags);
+    }
+}
+
+template <typename Response>
+inline void decompressResponseValues(Response &resp)
+{
+    if constexpr (has_compressible_value<Response>::value) {
+        ValueCompression::decompress(resp.value, resp.flags);
+    } else if constexpr (has_compressible_entries<Response>::value) {
+        for (auto &entry : resp.entries) {
+            ValueCompression::decompress(entry.value, entry.flags);
+        }
+    }
+}
+
+} // namespace couchnode
@@ -239,6 +239,46 @@ function genericTests(collFn) {
         )
       })
 
+      it('should decode lazily with lazyDecode', async function () {
+        let decodes = 0
+        const countingTranscoder = {
+          encode: (value) => collFn().transcoder.encode(value),
+          decode: (bytes, flags) => {
+            ++decodes
+            return collFn().transcoder.decode(bytes, flags)
+          },
+        }
+
+        var res = await collFn().get(testKeyA, {
+          transcoder: countingTranscoder,
+          lazyDecode: true,
+        })
+        assert.isObject(res)
+        assert.isOk(res.cas)
+        assert.strictEqual(decodes, 0)
+        assert.deepStrictEqual(
+          res.rawContent,
+          Buffer.from(JSON.stringify(testObjVal))
+        )
+        assert.strictEqual(res.flags, 0x02000000)
+
+        assert.deepStrictEqual(res.content, testObjVal)
+        assert.strictEqual(res.value, res.content)
+        assert.strictEqual(decodes, 1)
+      })
+
+      it('should throw transcoder errors on access with lazyDecode', async function () {
+        var res = await collFn().get(testKeyA, {
+          transcoder: errorTranscoder,
+          lazyDecode: true,
+        })
+        assert.isOk(res.cas)
+        assert.throws(() => res.content, Error, 'decode error')
+
+        res.content = 'replaced'
+        assert.strictEqual(res.content, 'replaced')
+      })
+
       it('should perform basic gets with callback', function (done) {
         collFn().get(testKeyA, (err, res) => {
           if (err) {
@@ -961,6 +1001,34 @@ function genericTests(collFn) {
       )
     }).timeout(7500)
 
+    it('should stream get all replicas as each node responds', async function () {
+      const events = []
+      const res = await new Promise((resolve, reject) => {
+        const replicas = []
+        collFn()
+          .getAllReplicas(replicaTestKey)
+          .on('replica', (replica) => {
+            events.push('replica')
+            replicas.push(replica)
+          })
+          .on('end', () => {
+            events.push('end')
+            resolve(replicas)
+          })
+          .on('error', (err) => {
+            reject(err)
+          })
+      })
+
+      assert.isAtLeast(res.length, 1)
+      assert.deepEqual(events, [...res.map(() => 'replica'), 'end'])
+      assert.strictEqual(res.filter((r) => !r.isReplica).length, 1)
+      res.forEach((replica) => {
+        assert.instanceOf(replica, GetReplicaResult)
+        assert.deepStrictEqual(replica.content, testObjVal)
+      })
+    }).timeout(7500)
+
     it('should perform basic get any replica', async function () {
       var res = await collFn().getAnyReplica(replicaTestKey)
 
@@ -111,6 +111,114 @@ function genericTests(collFn) {
     })
   })
 
+  describe('#list-paging', function () {
+    const numItems = 40
+    let testKeyLst
+    let listObj = null
+
+    before(async function () {
+      testKeyLst = H.genTestKey()
+      await collFn().insert(
+        testKeyLst,
+        Array.from({ length: numItems }, (_, i) => `item-${i}`)
+      )
+      listObj = collFn().list(testKeyLst)
+    })
+
+    after(async function () {
+      try {
+        await collFn().remove(testKeyLst)
+      } catch (_e) {
+        // nothing
+      }
+    })
+
+    it('should iterate a list spanning several pages', async function () {
+      var iteratedItems = []
+      var indexes = []
+      await listObj.forEach((item, index) => {
+        iteratedItems.push(item)
+        indexes.push(index)
+      })
+
+      assert.lengthOf(iteratedItems, numItems)
+      for (let i = 0; i < numItems; ++i) {
+        assert.equal(iteratedItems[i], `item-${i}`)
+        assert.equal(indexes[i], i)
+      }
+    })
+
+    it('should async-iterate a list spanning several pages', async function () {
+      H.skipIfMissingAwaitOf()
+
+      var iteratedItems = []
+      await eval(`
+            (async function() {
+              for await (var item of listObj) {
+                iteratedItems.push(item);
+              }
+            })()
+          `)
+
+      assert.lengthOf(iteratedItems, numItems)
+      assert.equal(iteratedItems[numItems - 1], `item-${numItems - 1}`)
+    })
+
+    it('should keep iterating a list which is modified part way through', async function () {
+      H.skipIfMissingAwaitOf()
+
+      const testKeyMod = H.genTestKey()
+      const numModItems = 100
+      await collFn().insert(
+        testKeyMod,
+        Array.from({ length: numModItems }, (_, i) => `item-${i}`)
+      )
+      const modListObj = collFn().list(testKeyMod)
+
+      try {
+        var iteratedItems = []
+        await eval(`
+            (async function() {
+              for await (var item of modListObj) {
+                if (iteratedItems.length === 0) {
+                  await modListObj.push('extra-item');
+                }
+                iteratedItems.push(item);
+              }
+            })()
+          `)
+
+        assert.lengthOf(iteratedItems, numModItems + 1)
+        for (let i = 0; i < numModItems; ++i) {
+          assert.equal(iteratedItems[i], `item-${i}`)
+        }
+        assert.equal(iteratedItems[numModItems], 'extra-item')
+      } finally {
+        await collFn().remove(testKeyMod)
+      }
+    })
+
+    it('should find the index of an item on a later page', async function () {
+      var idx = await listObj.indexOf(`item-${numItems - 1}`)
+      assert.equal(idx, numItems - 1)
+
+      var missingIdx = await listObj.indexOf('missing-item')
+      assert.equal(missingIdx, -1)
+    })
+
+    it('should fail to iterate a document which is not a list', async function () {
+      const testKeyObj = H.genTestKey()
+      await collFn().insert(testKeyObj, { foo: 'bar' })
+      try {
+        await H.throwsHelper(async () => {
+          await collFn().list(testKeyObj).forEach(() => {})
+        }, H.CouchbaseError)
+      } finally {
+        await collFn().remove(testKeyObj)
+      }
+    })
+  })
+
   describe('#map', function () {
     let testKeyMap
     let mapObj = null
@@ -356,6 +464,66 @@ function genericTests(collFn) {
       }, H.lib.CouchbaseError)
     })
   })
+
+  describe('#bulk-mutations', function () {
+    const numItems = 40
+    const testKeys = []
+
+    after(async function () {
+      for (const key of testKeys) {
+        try {
+          await collFn().remove(key)
+        } catch (_e) {
+          // nothing
+        }
+      }
+    })
+
+    function genKey() {
+      const key = H.genTestKey()
+      testKeys.push(key)
+      return key
+    }
+
+    it('should push many items to a list in order', async function () {
+      const listObj = collFn().list(genKey())
+      const values = Array.from({ length: numItems }, (_, i) => `item-${i}`)
+
+      await listObj.pushMany(values.slice(0, 2))
+      await listObj.pushMany(values.slice(2))
+      await listObj.pushMany([])
+
+      assert.deepEqual(await listObj.getAll(), values)
+    })
+
+    it('should set many keys in a map', async function () {
+      const mapObj = collFn().map(genKey())
+      const items = {}
+      for (let i = 0; i < numItems; ++i) {
+        items[`key-${i}`] = i
+      }
+
+      await mapObj.set('key-0', 'replaced')
+      await mapObj.setMany(items)
+
+      assert.deepEqual(await mapObj.getAll(), items)
+    })
+
+    it('should add many items to a set', async function () {
+      const setObj = collFn().set(genKey())
+      const items = Array.from({ length: numItems }, (_, i) => `item-${i}`)
+
+      await setObj.add('item-3')
+      const added = await setObj.addMany([...items, 'item-0'])
+      assert.equal(added, numItems - 1)
+
+      const values = await setObj.values()
+      assert.lengthOf(values, numItems)
+      assert.sameMembers(values, items)
+
+      assert.equal(await setObj.addMany(items.slice(0, 5)), 0)
+    })
+  })
 }
 
 describe('#datastructures', function () {
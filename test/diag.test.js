@@ -94,6 +94,59 @@ describe('#diagnostics', function () {
     })
   })
 
+  describe('#stats', function () {
+    it('should report connection stats', async function () {
+      const testKey = H.genTestKey()
+      await H.co.upsert(testKey, { foo: 'bar' })
+      await Promise.all([
+        H.co.get(testKey),
+        H.co.get(testKey),
+        H.co.get(testKey),
+      ])
+      await H.co.remove(testKey)
+
+      const stats = H.c.connectionStats()
+      assert.instanceOf(stats, H.lib.ConnectionStats)
+      assert.equal(stats.inFlight, 0)
+      assert.equal(stats.pendingCompletions, 0)
+      assert.isAtLeast(stats.maxPendingCompletions, 1)
+      assert.isAtLeast(stats.completionDelay.totalCount, 5)
+      assert.property(stats.completionDelay.percentiles, '99')
+
+      // the histogram and high-water mark are reset after each call
+      const nextStats = H.c.connectionStats()
+      assert.equal(nextStats.maxPendingCompletions, 0)
+      assert.equal(nextStats.completionDelay.totalCount, 0)
+    })
+
+    it('should report per-node stats', async function () {
+      H.c.nodeStats()
+
+      const testKey = H.genTestKey()
+      await H.co.upsert(testKey, { foo: 'bar' })
+      await H.co.get(testKey)
+      await H.co.remove(testKey)
+
+      const stats = H.c.nodeStats()
+      assert.instanceOf(stats, H.lib.NodeStats)
+      assert.isAbove(stats.intervalSeconds, 0)
+      const kvStats = Object.values(stats.nodes)
+        .map((services) => services.kv)
+        .filter((kv) => kv)
+      assert.isNotEmpty(kvStats)
+
+      const totalCount = kvStats.reduce((sum, kv) => sum + kv.totalCount, 0)
+      assert.isAtLeast(totalCount, 3)
+      kvStats.forEach((kv) => {
+        assert.isAtLeast(kv.throughputPerSecond, 0)
+        assert.equal(kv.latency.totalCount, kv.totalCount)
+      })
+
+      const nextStats = H.c.nodeStats()
+      assert.isEmpty(Object.keys(nextStats.nodes))
+    })
+  })
+
   describe('#waitUntilReady', function () {
     it('should wait until a cluster is ready', async function () {
       var res = await H.c.waitUntilReady(1500)
@@ -1,6 +1,7 @@
 'use strict'
 
 const assert = require('chai').assert
+const H = require('./harness')
 const { LoggingMeter } = require('../lib/loggingmeter')
 const { CouchbaseLogger, NoOpLogger } = require('../lib/logger')
 const { OpAttributeName, ServiceName } = require('../lib/observabilitytypes')
@@ -145,4 +146,59 @@ describe('Logging Meter', function () {
     const report = meter.createReport()
     assert.equal(report.operations[ServiceName.KeyValue].get.total_count, 2)
   })
+
+  it('should clamp values outside of the trackable range', function () {
+    const logger = new CouchbaseLogger(new NoOpLogger())
+    const meter = new LoggingMeter(logger)
+    meter.reporter.stop()
+
+    const recorder = meter.valueRecorder(OpAttributeName.MeterNameOpDuration, {
+      [OpAttributeName.Service]: ServiceName.KeyValue,
+      [OpAttributeName.OperationName]: 'get',
+    })
+    recorder.recordValue(-5)
+    recorder.recordValue(60_000_000)
+
+    const report = meter.createReport()
+    const stats = report.operations[ServiceName.KeyValue].get
+    assert.equal(stats.total_count, 2)
+    assert.isAtMost(stats.percentiles_us['50'], 1)
+    assert.isAtLeast(stats.percentiles_us['100'], 30_000_000)
+    assert.isBelow(stats.percentiles_us['100'], 31_000_000)
+  })
+
+  describe('#native-dispatch', function () {
+    let meter
+    let cluster
+    let coll
+
+    before(async function () {
+      meter = new LoggingMeter(new CouchbaseLogger(new NoOpLogger()))
+      meter.reporter.stop()
+      cluster = await H.lib.Cluster.connect(H.connStr, {
+        ...H.connOpts,
+        meter: meter,
+      })
+      coll = cluster.bucket(H.bucketName).defaultCollection()
+    })
+
+    after(async function () {
+      await cluster.close()
+    })
+
+    it('should record dispatched operations natively', async function () {
+      meter.createReport()
+
+      const testKey = H.genTestKey()
+      await coll.upsert(testKey, { foo: 'bar' })
+      await coll.get(testKey)
+      await coll.remove(testKey)
+
+      const report = meter.createReport()
+      const kvOps = report.operations[ServiceName.KeyValue]
+      assert.equal(kvOps.upsert.total_count, 1)
+      assert.equal(kvOps.get.total_count, 1)
+      assert.equal(kvOps.remove.total_count, 1)
+    })
+  })
 })
@@ -91,14 +91,14 @@ function metricsTests(collFn, meterFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.ListIndexOf)
-          .nestedOps([KeyValueOp.Get])
+          .nestedOps([KeyValueOp.LookupIn])
         let test2Idx = await listObj.indexOf('test2')
         assert.equal(test2Idx, 1)
 
         validator
           .reset()
           .op(DatastructureOp.ListIndexOf)
-          .nestedOps([KeyValueOp.Get])
+          .nestedOps([KeyValueOp.LookupIn])
         var missingIdx = await listObj.indexOf('missing-item')
         assert.equal(missingIdx, -1)
 
@@ -422,7 +422,7 @@ function metricsTests(collFn, meterFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.SetContains)
-          .nestedOps([KeyValueOp.Get])
+          .nestedOps([KeyValueOp.LookupIn])
         res = await setObj.contains('test1')
         assert.equal(res, true)
         validator.validate()
@@ -430,7 +430,7 @@ function metricsTests(collFn, meterFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.SetContains)
-          .nestedOps([KeyValueOp.Get])
+          .nestedOps([KeyValueOp.LookupIn])
         res = await setObj.contains('invalid-item')
         assert.equal(res, false)
         validator.validate()
@@ -193,6 +193,141 @@ function rangeScanTests(collFn) {
       validateResults(res.results, 5, true)
     })
 
+    it('should pause and resume streaming scan results', async function () {
+      const scanType = new PrefixScan(testUid)
+      const res = await new Promise((resolve, reject) => {
+        const resultsOut = []
+        const emitter = collFn().scan(scanType, {
+          idsOnly: true,
+          bufferByteLimit: 1024,
+        })
+        emitter
+          .on('result', (res) => {
+            resultsOut.push(res)
+            emitter.pauseStreaming()
+            setImmediate(() => emitter.resumeStreaming())
+          })
+          .on('end', () => resolve(resultsOut))
+          .on('error', reject)
+      })
+      assert.isArray(res)
+      validateResults(res, testIds.length, true)
+    })
+
+    it('should stop emitting ids as soon as it is paused', async function () {
+      const scanType = new PrefixScan(testUid)
+      const emitter = collFn().scan(scanType, { idsOnly: true })
+      let numResults = 0
+      await new Promise((resolve, reject) => {
+        emitter
+          .on('result', () => {
+            numResults++
+            emitter.pauseStreaming()
+            setTimeout(resolve, 100)
+          })
+          .on('error', reject)
+      })
+      assert.equal(numResults, 1)
+
+      const ended = new Promise((resolve) => emitter.on('end', resolve))
+      emitter.resumeStreaming()
+      await ended
+      assert.equal(numResults, testIds.length)
+    })
+
+    it('should end a paused scan when it is cancelled', async function () {
+      const scanType = new PrefixScan(testUid)
+      const res = await new Promise((resolve, reject) => {
+        const resultsOut = []
+        const emitter = collFn().scan(scanType, { idsOnly: true })
+        emitter
+          .on('result', (res) => {
+            resultsOut.push(res)
+            if (resultsOut.length == 3) {
+              emitter.pauseStreaming()
+              setImmediate(() => emitter.cancelStreaming())
+            }
+          })
+          .on('end', () => resolve(resultsOut))
+          .on('error', reject)
+      })
+      assert.isArray(res)
+      validateResults(res, 3, true)
+    })
+
+    it('should execute an id scan returning packed batches', async function () {
+      const scanType = new PrefixScan(testUid)
+      const res = await collFn().scanIds(scanType, { idBatchSize: 16 })
+
+      assert.isArray(res)
+      const ids = []
+      res.forEach((batch) => {
+        assert.isAtMost(batch.length, 16)
+        assert.instanceOf(batch.buffer, Buffer)
+        assert.instanceOf(batch.lengths, Uint32Array)
+        ids.push(...batch.ids())
+      })
+      assert.lengthOf(ids, testIds.length)
+      ids.forEach((id) => assert.isTrue(testIds.includes(id)))
+    })
+
+    it('should reject an id batch size above the limit', async function () {
+      await H.throwsHelper(async () => {
+        await collFn().scanIds(new PrefixScan(testUid), {
+          idBatchSize: 65537,
+        })
+      }, H.lib.InvalidArgumentError)
+    })
+
+    it('should resume a scan from a checkpoint', async function () {
+      const scanType = new RangeScan()
+      const firstIds = await new Promise((resolve, reject) => {
+        const ids = []
+        const emitter = collFn().scan(scanType, {
+          idsOnly: true,
+          trackProgress: true,
+        })
+        emitter
+          .on('result', (res) => {
+            ids.push(res.id)
+            if (ids.length == 30) {
+              emitter.cancelStreaming()
+            }
+          })
+          .on('end', () => resolve({ ids, checkpoint: emitter.checkpoint() }))
+          .on('error', reject)
+      })
+      assert.instanceOf(firstIds.checkpoint, Buffer)
+
+      const res = await collFn().scan(scanType, {
+        idsOnly: true,
+        resumeFrom: firstIds.checkpoint,
+      })
+      const allIds = firstIds.ids.concat(res.map((r) => r.id))
+      assert.lengthOf(allIds, testIds.length)
+      assert.lengthOf(new Set(allIds), testIds.length)
+      testIds.forEach((id) => assert.isTrue(allIds.includes(id)))
+    })
+
+    it('should split a scan into disjoint shards', async function () {
+      const shards = await collFn().scanShards(new PrefixScan(testUid), 4)
+      assert.isArray(shards)
+      assert.isAtLeast(shards.length, 1)
+      assert.isAtMost(shards.length, 4)
+
+      const allIds = []
+      for (const shard of shards) {
+        const scanType = RangeScan.fromJSON(JSON.parse(JSON.stringify(shard)))
+        const res = await collFn().scan(scanType, { idsOnly: true })
+        // Boundaries are sampled from within the prefix, so no shard is empty.
+        assert.isAtLeast(res.length, 1)
+        res.forEach((r) => allIds.push(r.id))
+      }
+      assert.lengthOf(allIds, testIds.length)
+      assert.lengthOf(new Set(allIds), testIds.length)
+      testIds.forEach((id) => assert.isTrue(allIds.includes(id)))
+    })
+
     it('should execute a sample scan', async function () {
       const limit = 10
       const scanType = new SamplingScan(limit)
@@ -1,6 +1,7 @@
 'use strict'
 
 const assert = require('chai').assert
+const H = require('./harness')
 const {
   ThresholdLoggingTracer,
   ThresholdLoggingSpan,
@@ -283,4 +284,70 @@ describe('Threshold Logging', function () {
       assert.isEmpty(report)
     })
   })
+
+  describe('#operations-without-spans', function () {
+    it('should check operations timed without spans', function () {
+      const logger = new CouchbaseLogger(new NoOpLogger())
+      const tracer = new ThresholdLoggingTracer(logger, TRACING_CONFIG)
+      tracer.reporter.stop()
+
+      tracer.checkOperationThreshold('kv', 'range_scan', 2000)
+      tracer.checkOperationThreshold('kv', 'get', 100)
+      tracer.checkOperationThreshold('kv', 'list_push', 2000)
+      tracer.checkOperationThreshold('transactions', 'transaction', 2000)
+
+      const report = tracer.reporter.report(true)
+      assert.deepEqual(Object.keys(report), ['kv'])
+      assert.equal(report.kv.total_count, 1)
+      assert.deepEqual(report.kv.top_requests, [
+        { operation_name: 'range_scan', total_duration_us: 2000 },
+      ])
+    })
+  })
+
+  describe('#native-dispatch', function () {
+    let tracer
+    let cluster
+    let coll
+
+    before(async function () {
+      const logger = new CouchbaseLogger(new NoOpLogger())
+      tracer = new ThresholdLoggingTracer(logger, {
+        kvThreshold: 0,
+        sampleSize: 10,
+        emitInterval: 100000,
+      })
+      tracer.reporter.stop()
+      cluster = await H.lib.Cluster.connect(H.connStr, {
+        ...H.connOpts,
+        tracingConfig: { enableTracing: true },
+        tracer: tracer,
+      })
+      coll = cluster.bucket(H.bucketName).defaultCollection()
+    })
+
+    after(async function () {
+      await cluster.close()
+    })
+
+    it('should record an operation once', async function () {
+      tracer.reporter.report(true)
+
+      await coll.upsert(H.genTestKey(), { foo: 'bar' })
+
+      const report = tracer.reporter.report(true)
+      assert.equal(report.kv.total_count, 1)
+    })
+
+    it('should record an operation with a parent span once', async function () {
+      tracer.reporter.report(true)
+
+      const parentSpan = tracer.requestSpan('parent-span')
+      await coll.upsert(H.genTestKey(), { foo: 'bar' }, { parentSpan })
+      parentSpan.end()
+
+      const report = tracer.reporter.report(true)
+      assert.equal(report.kv.total_count, 1)
+    })
+  })
 })
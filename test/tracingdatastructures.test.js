@@ -93,14 +93,14 @@ function tracingTests(collFn, tracerFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.ListIndexOf)
-          .childKvOps(KeyValueOp.Get)
+          .childKvOps(KeyValueOp.LookupIn)
         let test2Idx = await listObj.indexOf('test2')
         assert.equal(test2Idx, 1)
 
         validator
           .reset()
           .op(DatastructureOp.ListIndexOf)
-          .childKvOps(KeyValueOp.Get)
+          .childKvOps(KeyValueOp.LookupIn)
         var missingIdx = await listObj.indexOf('missing-item')
         assert.equal(missingIdx, -1)
 
@@ -424,7 +424,7 @@ function tracingTests(collFn, tracerFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.SetContains)
-          .childKvOps(KeyValueOp.Get)
+          .childKvOps(KeyValueOp.LookupIn)
         res = await setObj.contains('test1')
         assert.equal(res, true)
         validator.validate()
@@ -432,7 +432,7 @@ function tracingTests(collFn, tracerFn, collectionDetailsFn) {
         validator
           .reset()
           .op(DatastructureOp.SetContains)
-          .childKvOps(KeyValueOp.Get)
+          .childKvOps(KeyValueOp.LookupIn)
         res = await setObj.contains('invalid-item')
         assert.equal(res, false)
         validator.validate()
@@ -4,7 +4,10 @@ const assert = require('chai').assert
 const testdata = require('./testdata')
 const H = require('./harness')
 
-const { RawBinaryTranscoder } = require('../lib/transcoders')
+const {
+  CompressingTranscoder,
+  RawBinaryTranscoder,
+} = require('../lib/transcoders')
 const {
   TransactionGetMultiSpec,
   TransactionGetMultiMode,
@@ -12,6 +15,8 @@ const {
   TransactionGetMultiReplicasFromPreferredServerGroupMode,
   TransactionGetMultiReplicasFromPreferredServerGroupResult,
   TransactionGetMultiReplicasFromPreferredServerGroupSpec,
+  TransactionInsertMultiSpec,
+  TransactionReplaceMultiSpec,
 } = require('../lib/transactions')
 
 async function upsertTestData(target, testUid) {
@@ -109,6 +114,91 @@ describe('#transactions', function () {
     })
   }).timeout(15000)
 
+  it('should stage multiple mutations at once', async function () {
+    const testKey = H.genTestKey()
+    const insKeys = [0, 1, 2, 3].map((i) => `${testKey}_ins_${i}`)
+    const remKeys = [0, 1].map((i) => `${testKey}_rem_${i}`)
+    await Promise.all(remKeys.map((key) => H.co.insert(key, { foo: 'bar' })))
+
+    await H.c.transactions().run(async (attempt) => {
+      const insDocs = await attempt.insertMulti(
+        insKeys.map(
+          (key) => new TransactionInsertMultiSpec(H.co, key, { foo: 'bar' })
+        )
+      )
+      assert.lengthOf(insDocs, insKeys.length)
+      insDocs.forEach((doc, i) => assert.equal(doc.id.key, insKeys[i]))
+
+      await attempt.replaceMulti(
+        insDocs.map(
+          (doc) => new TransactionReplaceMultiSpec(doc, { foo: 'baz' })
+        )
+      )
+
+      const remDocs = await Promise.all(
+        remKeys.map((key) => attempt.get(H.co, key))
+      )
+      await attempt.removeMulti(remDocs)
+    })
+
+    for (const key of insKeys) {
+      const res = await H.co.get(key)
+      assert.deepStrictEqual(res.content, { foo: 'baz' })
+    }
+    for (const key of remKeys) {
+      await H.throwsHelper(async () => {
+        await H.co.get(key)
+      })
+    }
+  }).timeout(15000)
+
+  it('should report attempt timings', async function () {
+    const testKey = H.genTestKey()
+
+    const res = await H.c.transactions().run(async (attempt) => {
+      await attempt.insert(H.co, testKey, { foo: 'bar' })
+    })
+
+    assert.isAtLeast(res.attempts.length, 1)
+    const lastAttempt = res.attempts[res.attempts.length - 1]
+    assert.isUndefined(lastAttempt.retryReason)
+    assert.isAtLeast(lastAttempt.durationMicros, 0)
+    assert.isAtLeast(lastAttempt.callbackDelayMicros, 0)
+    assert.equal(lastAttempt.stages.insert.count, 1)
+    assert.equal(lastAttempt.stages.commit.count, 1)
+  })
+
+  it('should report attempt timings for failed transactions', async function () {
+    const testKey = H.genTestKey()
+
+    try {
+      await H.c.transactions().run(async (attempt) => {
+        await attempt.insert(H.co, testKey, { foo: 'bar' })
+        throw new Error('application failure')
+      })
+      assert.fail('transaction should have failed')
+    } catch (err) {
+      assert.instanceOf(err, H.lib.TransactionFailedError)
+      assert.lengthOf(err.attempts, 1)
+      assert.equal(err.attempts[0].stages.insert.count, 1)
+    }
+  })
+
+  it('should reject compressing transcoders', async function () {
+    const testKey = H.genTestKey()
+    const tc = new CompressingTranscoder({ minSize: 0 })
+
+    try {
+      await H.c.transactions().run(async (attempt) => {
+        await attempt.insert(H.co, testKey, { foo: 'bar' }, { transcoder: tc })
+      })
+      assert.fail('transaction should have failed')
+    } catch (err) {
+      assert.instanceOf(err, H.lib.TransactionFailedError)
+      assert.instanceOf(err.cause, H.lib.FeatureNotAvailableError)
+    }
+  })
+
   it('should work with query', async function () {
     const testKey = H.genTestKey()
     const testDoc1 = testKey + '_1'
@@ -2,10 +2,16 @@
 
 const assert = require('chai').assert
 const {
+  CborTranscoder,
+  CompressingTranscoder,
+  CompressionAlgorithm,
+  DefaultTranscoder,
+  MsgpackTranscoder,
   RawBinaryTranscoder,
   RawJsonTranscoder,
   RawStringTranscoder,
 } = require('../lib/transcoders')
+const binding = require('../lib/binding').default
 const H = require('./harness')
 const testdata = require('./testdata')
 
@@ -615,9 +621,448 @@ function genericTests(collFn) {
         })
       })
     })
+
+    describe('#compressing', function () {
+      const content = {
+        items: Array.from({ length: 200 }, (_, i) => ({
+          id: i,
+          name: 'compressible item',
+        })),
+      }
+      const encodedSize = Buffer.from(JSON.stringify(content)).length
+
+      const storedSize = async (key) => {
+        const res = await collFn().lookupIn(key, [
+          H.lib.LookupInSpec.get(H.lib.LookupInMacro.ValueSizeBytes, {
+            xattr: true,
+          }),
+        ])
+        return res.content[0].value
+      }
+
+      const keys = []
+
+      before(function () {
+        H.skipIfMissingFeature(this, H.Features.Xattr)
+      })
+
+      after(async function () {
+        try {
+          await testdata.removeTestData(collFn(), keys)
+        } catch (_e) {
+          // ignore
+        }
+      })
+
+      Object.values(CompressionAlgorithm).forEach((algorithm) => {
+        it(`should round-trip values compressed with ${algorithm}`, async function () {
+          if (!binding.valueCompressionAlgorithms.includes(algorithm)) {
+            this.skip()
+          }
+          const transcoder = new CompressingTranscoder({ algorithm })
+          const key = H.genTestKey()
+          keys.push(key)
+
+          await collFn().upsert(key, content, { transcoder: transcoder })
+          assert.isBelow(await storedSize(key), encodedSize)
+
+          const res = await collFn().get(key, { transcoder: transcoder })
+          assert.deepStrictEqual(res.value, content)
+        })
+      })
+
+      it('should read compressed values as binary with other transcoders', async function () {
+        const key = H.genTestKey()
+        keys.push(key)
+
+        await collFn().upsert(key, content, {
+          transcoder: new CompressingTranscoder(),
+        })
+        const res = await collFn().get(key)
+        assert.isTrue(Buffer.isBuffer(res.value))
+        assert.isBelow(res.value.length, encodedSize)
+      })
+
+      it('should store values below the minimum size uncompressed', async function () {
+        const transcoder = new CompressingTranscoder({
+          minSize: encodedSize + 1,
+        })
+        const key = H.genTestKey()
+        keys.push(key)
+
+        await collFn().upsert(key, content, { transcoder: transcoder })
+        assert.strictEqual(await storedSize(key), encodedSize)
+
+        const res = await collFn().get(key, { transcoder: transcoder })
+        assert.deepStrictEqual(res.value, content)
+      })
+
+      it('should wrap other transcoders', async function () {
+        const transcoder = new CompressingTranscoder({
+          transcoder: new RawBinaryTranscoder(),
+          minSize: 0,
+        })
+        const value = Buffer.alloc(4096, 'x')
+        const key = H.genTestKey()
+        keys.push(key)
+
+        await collFn().upsert(key, value, { transcoder: transcoder })
+        const res = await collFn().get(key, { transcoder: transcoder })
+        assert.deepStrictEqual(res.value, value)
+      })
+
+      it('should reject unknown algorithms', function () {
+        assert.throws(
+          () => new CompressingTranscoder({ algorithm: 'zstd' }),
+          Error,
+          /Unrecognized compression algorithm/
+        )
+      })
+    })
+
+    describe('#binary-formats', function () {
+      const content = {
+        name: 'binary document',
+        count: 3,
+        ratio: 0.5,
+        tags: ['a', 'b'],
+        blob: Buffer.from('0102030405', 'hex'),
+        when: new Date(1700000000123),
+      }
+
+      const keys = []
+
+      after(async function () {
+        try {
+          await testdata.removeTestData(collFn(), keys)
+        } catch (_e) {
+          // ignore
+        }
+      })
+
+      const transcoders = [
+        ['MsgpackTranscoder', MsgpackTranscoder],
+        ['CborTranscoder', CborTranscoder],
+      ]
+
+      transcoders.forEach(([name, Transcoder]) => {
+        it(`should round-trip using ${name}`, async function () {
+          const transcoder = new Transcoder()
+          const key = H.genTestKey()
+          keys.push(key)
+
+          await collFn().upsert(key, content, { transcoder: transcoder })
+          const res = await collFn().get(key, { transcoder: transcoder })
+          assert.deepStrictEqual(res.value, content)
+        })
+
+        it(`should read ${name} documents as binary by default`, async function () {
+          const transcoder = new Transcoder()
+          const key = H.genTestKey()
+          keys.push(key)
+
+          await collFn().upsert(key, content, { transcoder: transcoder })
+          const res = await collFn().get(key)
+          assert.deepStrictEqual(res.value, transcoder.encode(content)[0])
+        })
+      })
+    })
+  })
+}
+
+function defaultTranscoderTests(transcoder) {
+  class Point {
+    constructor(x, y) {
+      this.x = x
+      this.y = y
+    }
+  }
+
+  const protoDoc = JSON.parse('{"__proto__":{"polluted":true}}')
+
+  const values = [
+    { name: 'object', value: { a: 1, b: 'two', c: [true, false, null] } },
+    { name: 'array', value: [1, 'two', { three: 3 }, [], {}] },
+    { name: 'number', value: 42 },
+    { name: 'null', value: null },
+    {
+      name: 'numbers',
+      value: [-0, 0.1, 1e21, 1e-7, 123e-20, 2 ** 53, 2 ** 60, NaN, Infinity],
+    },
+    {
+      name: 'strings',
+      value: [
+        'q"b\\s/',
+        '\b\f\n\r\t\u0001\u001f',
+        'h\u00e9\u4e2d\ud83d\ude00',
+      ],
+    },
+    { name: 'lone surrogates', value: ['\ud83d', 'x\ude00y'] },
+    { name: 'omitted members', value: { a: undefined, b: () => 1, c: 3 } },
+    { name: 'array holes', value: [undefined, () => 1, Symbol('s')] },
+    { name: 'integer keys', value: { b: 1, 2: 'two', a: 3, 1: 'one' } },
+    { name: 'toJSON', value: { when: new Date(0), buf: Buffer.from('hi') } },
+    { name: 'class instance', value: new Point(1, 2) },
+    { name: 'boxed primitives', value: [new Number(1), new String('s')] },
+    {
+      name: 'null prototype',
+      value: Object.assign(Object.create(null), { a: 1 }),
+    },
+    { name: 'own __proto__ key', value: protoDoc },
+  ]
+
+  values.forEach(({ name, value }) => {
+    it(`should encode like JSON.stringify (${name})`, function () {
+      const [bytes, flags] = transcoder.encode(value)
+      assert.strictEqual(bytes.toString('utf8'), JSON.stringify(value))
+      assert.strictEqual(flags, 0x02000000)
+    })
+
+    it(`should decode like JSON.parse (${name})`, function () {
+      const json = Buffer.from(JSON.stringify(value))
+      assert.deepStrictEqual(
+        transcoder.decode(json, 0x02000000),
+        JSON.parse(json.toString('utf8'))
+      )
+    })
+  })
+
+  it('should decode an own __proto__ key without changing the prototype', function () {
+    const res = transcoder.decode(Buffer.from(JSON.stringify(protoDoc)), 0)
+    assert.strictEqual(Object.getPrototypeOf(res), Object.prototype)
+    assert.deepStrictEqual(Object.keys(res), ['__proto__'])
+    assert.isUndefined(res.polluted)
+  })
+
+  it('should decode escaped lone surrogates like JSON.parse', function () {
+    const json = Buffer.from('["\\ud83d","x\\ude00y"]')
+    assert.deepStrictEqual(transcoder.decode(json, 0), ['\ud83d', 'x\ude00y'])
+  })
+
+  it('should decode deeply nested documents', function () {
+    const json = Buffer.from('['.repeat(2000) + ']'.repeat(2000))
+    assert.deepStrictEqual(
+      transcoder.decode(json, 0),
+      JSON.parse(json.toString('utf8'))
+    )
+  })
+
+  it('should return the bytes of invalid JSON', function () {
+    const invalid = [
+      '',
+      '{',
+      '[1,]',
+      '01',
+      '"\t"',
+      '{"a":1}x',
+      '\ufeff{}',
+      "{'a':1}",
+    ].map((str) => Buffer.from(str))
+    invalid.forEach((bytes) => {
+      assert.strictEqual(transcoder.decode(bytes, 0), bytes)
+    })
+  })
+
+  it('should fail to encode circular structures', function () {
+    const value = { a: {} }
+    value.a.b = value
+    assert.throws(() => transcoder.encode(value), TypeError, /circular/)
+  })
+
+  it('should fail to encode BigInts', function () {
+    assert.throws(() => transcoder.encode({ big: 1n }), TypeError)
+  })
+
+  it('should fail to encode undefined', function () {
+    assert.throws(() => transcoder.encode(undefined))
+  })
+
+  it('should propagate errors from toJSON', function () {
+    const value = {
+      toJSON() {
+        throw new Error('toJSON failed')
+      },
+    }
+    assert.throws(() => transcoder.encode(value), Error, 'toJSON failed')
   })
 }
 
+describe('#default-transcoder', function () {
+  describe('#js-json', function () {
+    defaultTranscoderTests(new DefaultTranscoder())
+  })
+
+  describe('#native-json', function () {
+    defaultTranscoderTests(new DefaultTranscoder({ nativeJson: true }))
+  })
+})
+
+describe('#binary-transcoders', function () {
+  const protoDoc = JSON.parse('{"__proto__":{"polluted":true}}')
+
+  const values = [
+    { name: 'object', value: { a: 1, b: 'two', c: [true, false, null] } },
+    { name: 'array', value: [1, 'two', { three: 3 }, [], {}] },
+    {
+      name: 'integers',
+      value: [0, 1, -1, 127, 128, -33, 65536, -(2 ** 31) - 1, 2 ** 53 - 1],
+    },
+    {
+      name: 'floats',
+      value: [0.5, 0.1, -0, 2 ** 53, 1e300, NaN, Infinity, -Infinity],
+    },
+    {
+      name: 'strings',
+      value: ['', 'h\u00e9\u4e2d\ud83d\ude00', 'x'.repeat(70000)],
+    },
+    { name: 'buffers', value: [Buffer.alloc(0), Buffer.alloc(300, 'x')] },
+    { name: 'dates', value: [new Date(0), new Date(-1500), new Date(8.64e15)] },
+    { name: 'bigints', value: [2n ** 63n, -(2n ** 63n), 2n ** 64n - 1n] },
+    {
+      name: 'many members',
+      value: Object.fromEntries(
+        Array.from({ length: 100 }, (_, i) => [`k${i}`, i])
+      ),
+    },
+    { name: 'own __proto__ key', value: protoDoc },
+  ]
+
+  const transcoders = [
+    ['MsgpackTranscoder', MsgpackTranscoder, 0x01000102],
+    ['CborTranscoder', CborTranscoder, 0x01000202],
+  ]
+
+  transcoders.forEach(([name, Transcoder, expectedFlags]) => {
+    describe(`#${name}`, function () {
+      const transcoder = new Transcoder()
+      const roundTrip = (value) => {
+        const [bytes, flags] = transcoder.encode(value)
+        assert.strictEqual(flags, expectedFlags)
+        return transcoder.decode(bytes, flags)
+      }
+
+      values.forEach(({ name, value }) => {
+        it(`should round-trip values (${name})`, function () {
+          assert.deepStrictEqual(roundTrip(value), value)
+        })
+      })
+
+      it('should encode binary views as Buffers', function () {
+        const bytes = new Uint8Array([1, 2, 3, 4])
+        assert.deepStrictEqual(
+          roundTrip(bytes.subarray(1, 3)),
+          Buffer.from([2, 3])
+        )
+        assert.deepStrictEqual(
+          roundTrip(new Uint16Array([1]).buffer),
+          Buffer.from([1, 0])
+        )
+      })
+
+      it('should treat members like JSON.stringify', function () {
+        assert.deepStrictEqual(
+          roundTrip({ a: undefined, b: () => 1, c: Symbol('s'), d: 1 }),
+          { d: 1 }
+        )
+        assert.deepStrictEqual(roundTrip([undefined, () => 1]), [null, null])
+        assert.deepStrictEqual(
+          roundTrip({ a: { toJSON: (key) => `key ${key}` } }),
+          { a: 'key a' }
+        )
+      })
+
+      it('should unwrap boxed primitives like JSON.stringify', function () {
+        assert.deepStrictEqual(
+          roundTrip([
+            new Number(1.5),
+            new String('s'),
+            new Boolean(false),
+            Object(2n ** 63n),
+          ]),
+          [1.5, 's', false, 2n ** 63n]
+        )
+      })
+
+      it('should decode an own __proto__ key without changing the prototype', function () {
+        const res = roundTrip(protoDoc)
+        assert.strictEqual(Object.getPrototypeOf(res), Object.prototype)
+        assert.deepStrictEqual(Object.keys(res), ['__proto__'])
+        assert.isUndefined(res.polluted)
+      })
+
+      it('should fail to encode circular structures', function () {
+        const value = { a: {} }
+        value.a.b = value
+        assert.throws(() => transcoder.encode(value), TypeError, /circular/)
+      })
+
+      it('should fail to encode BigInts beyond 64 bits', function () {
+        assert.throws(() => transcoder.encode(2n ** 64n), RangeError)
+      })
+
+      it('should fail to encode functions', function () {
+        assert.throws(() => transcoder.encode(() => 1), TypeError)
+      })
+
+      it('should fail to decode truncated data', function () {
+        const [bytes, flags] = transcoder.encode({ a: [1, 'two', 3.5] })
+        for (let i = 0; i < bytes.length; ++i) {
+          assert.throws(() => transcoder.decode(bytes.subarray(0, i), flags))
+        }
+      })
+
+      it('should fail to decode other formats', function () {
+        assert.throws(
+          () => transcoder.decode(Buffer.from('{}'), 0x02000000),
+          Error,
+          /Only .* data supported/
+        )
+        assert.throws(
+          () => transcoder.decode(Buffer.from('{}'), 0x03000002),
+          Error,
+          /Only .* data supported/
+        )
+      })
+    })
+  })
+
+  it('should produce the standard encodings', function () {
+    const value = { a: 1, b: [true, null] }
+    assert.strictEqual(
+      new MsgpackTranscoder().encode(value)[0].toString('hex'),
+      '82a16101a16292c3c0'
+    )
+    assert.strictEqual(
+      new CborTranscoder().encode(value)[0].toString('hex'),
+      'a2616101616282f5f6'
+    )
+  })
+
+  it('should decode MessagePack from other encoders', function () {
+    const transcoder = new MsgpackTranscoder()
+    const decode = (hex) =>
+      transcoder.decode(Buffer.from(hex, 'hex'), 0x01000102)
+    assert.strictEqual(decode('d3001fffffffffffff'), 2 ** 53 - 1)
+    assert.strictEqual(decode('d30020000000000001'), 2n ** 53n + 1n)
+    assert.strictEqual(decode('d3ffdfffffffffffff'), -(2n ** 53n) - 1n)
+  })
+
+  it('should decode CBOR from other encoders', function () {
+    const transcoder = new CborTranscoder()
+    const decode = (hex) =>
+      transcoder.decode(Buffer.from(hex, 'hex'), 0x01000202)
+    assert.deepStrictEqual(decode('9f0102ff'), [1, 2])
+    assert.deepStrictEqual(decode('bf616101ff'), { a: 1 })
+    assert.strictEqual(decode('7f61616162ff'), 'ab')
+    assert.strictEqual(decode('f93e00'), 1.5)
+    assert.strictEqual(decode('c249010000000000000000'), 2n ** 64n)
+    assert.deepStrictEqual(
+      decode('c074323031332d30332d32315432303a30343a30305a'),
+      new Date('2013-03-21T20:04:00Z')
+    )
+  })
+})
+
 describe('#default-collection', function () {
   genericTests(() => H.dco)
 })
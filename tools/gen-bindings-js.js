@@ -595,7 +595,8 @@ async function go() {
     }
     if (reqHasTracing) {
       outCppFuncDefs.write(`              callbackJsFn,`)
-      outCppFuncDefs.write(`              wrapper_span);`)
+      outCppFuncDefs.write(`              wrapper_span,`)
+      outCppFuncDefs.write(`              nativeObservation(optsJsObj));`)
     } else {
       outCppFuncDefs.write(`              callbackJsFn);`)
     }